@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "checkpoint.h"
+#include "log.h"
+#include "assert.h"
+#include "fatal-error.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+namespace ns3 {
+
+namespace {
+
+/// The variant number of this process.
+uint32_t g_variant = 0;
+/// The copies created by this process which did not exit yet.
+std::set<pid_t> g_children;
+/// The number of copies which did not exit successfully.
+uint32_t g_failed = 0;
+
+} // anonymous namespace
+
+uint32_t
+Checkpoint::Fork (uint32_t variants, uint32_t parallel)
+{
+  NS_LOG_FUNCTION (variants << parallel);
+  NS_ASSERT_MSG (g_variant == 0, "Checkpoint::Fork (): called in a variant");
+
+  for (uint32_t i = 1; i <= variants; ++i)
+    {
+      while (parallel != 0 && g_children.size () >= parallel)
+        {
+          WaitOne ();
+        }
+      // Flush the buffered output first, or every copy would write it again.
+      std::cout.flush ();
+      std::cerr.flush ();
+      std::clog.flush ();
+      std::fflush (0);
+
+      pid_t pid = ::fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("Checkpoint::Fork (): fork error: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          g_variant = i;
+          g_children.clear ();
+          g_failed = 0;
+          NS_LOG_LOGIC ("variant " << i << " started");
+          return i;
+        }
+      NS_LOG_LOGIC ("variant " << i << " is process " << pid);
+      g_children.insert (pid);
+    }
+  return 0;
+}
+
+void
+Checkpoint::WaitOne (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  int status;
+  pid_t pid = ::waitpid (-1, &status, 0);
+  if (pid < 0)
+    {
+      if (errno == EINTR)
+        {
+          return;
+        }
+      NS_FATAL_ERROR ("Checkpoint::WaitOne (): waitpid error: " << std::strerror (errno));
+    }
+  if (g_children.erase (pid) == 0)
+    {
+      // not one of ours
+      return;
+    }
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      NS_LOG_WARN ("process " << pid << " failed with status " << status);
+      g_failed++;
+    }
+}
+
+uint32_t
+Checkpoint::Wait (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  while (!g_children.empty ())
+    {
+      WaitOne ();
+    }
+  uint32_t failed = g_failed;
+  g_failed = 0;
+  return failed;
+}
+
+uint32_t
+Checkpoint::GetVariant (void)
+{
+  return g_variant;
+}
+
+} // namespace ns3
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Run several variants of a simulation from a common checkpoint.
+ *
+ * Fork copies the whole process at the point where it is called:
+ * the pending events, the nodes and all the protocol state.  Each copy
+ * then continues the simulation independently, so that a long warm-up
+ * phase is simulated once and shared by all the variants:
+ *
+ * \code
+ * Simulator::Stop (Seconds (60));
+ * Simulator::Run ();                      // warm-up
+ * uint32_t variant = Checkpoint::Fork (8, 4);
+ * if (variant == 0)
+ *   {
+ *     // the original process only waits for the variants
+ *     return Checkpoint::Wait ();
+ *   }
+ * Config::Set ("/NodeList/0/...", ...);    // configure this variant
+ * Simulator::Stop (Seconds (600));
+ * Simulator::Run ();
+ * \endcode
+ *
+ * Fork must be called between two calls to Simulator::Run, and only
+ * with a single-threaded simulator implementation.  The files opened
+ * before the checkpoint, such as pcap or ascii traces, are shared by
+ * all the variants: the traces of each variant should be enabled after
+ * the checkpoint, with file names derived from GetVariant.  The random
+ * variable streams are copied too, so the variants draw the same
+ * random numbers unless they are reseeded.
+ */
+class Checkpoint
+{
+public:
+  /**
+   * \param variants the number of copies of the process to create
+   * \param parallel the maximum number of copies running at the same
+   *        time, or zero to start them all at once
+   * \returns the variant number, from 1 to variants, in each copy and
+   *          zero in the original process.
+   *
+   * If parallel is not zero, the original process waits for a copy to
+   * exit before creating a new one when parallel copies are running.
+   */
+  static uint32_t Fork (uint32_t variants, uint32_t parallel = 0);
+  /**
+   * Wait for all the copies created by Fork to exit.
+   *
+   * \returns the number of copies which did not exit successfully.
+   */
+  static uint32_t Wait (void);
+  /**
+   * \returns the variant number of the calling process, zero in the
+   *          original process.
+   */
+  static uint32_t GetVariant (void);
+
+private:
+  /**
+   * Wait for one copy to exit.
+   */
+  static void WaitOne (void);
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
@@ -27,6 +27,7 @@
 #include "log.h"
 
 #include <sstream>
+#include <vector>
 
 NS_LOG_COMPONENT_DEFINE ("Config");
 
@@ -147,80 +148,95 @@ class ArrayMatcher
 public:
   ArrayMatcher (std::string element);
   bool Matches (uint32_t i) const;
+  bool IsSingle (uint32_t *index) const;
 private:
+  void Parse (std::string element);
   bool StringToUint32 (std::string str, uint32_t *value) const;
   std::string m_element;
+  bool m_any;
+  // The [min, max] ranges matched by m_element, parsed once
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 };
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_any (false)
 {
   NS_LOG_FUNCTION (this << element);
-}
-bool
-ArrayMatcher::Matches (uint32_t i) const
-{
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  std::string::size_type start = 0;
+  std::string::size_type tmp;
+  while ((tmp = m_element.find ("|", start)) != std::string::npos)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      Parse (m_element.substr (start, tmp - start));
+      start = tmp + 1;
     }
-  std::string::size_type tmp;
-  tmp = m_element.find ("|");
-  if (tmp != std::string::npos)
+  Parse (m_element.substr (start));
+}
+void
+ArrayMatcher::Parse (std::string element)
+{
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      m_any = true;
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
-          StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
+          StringToUint32 (upperBound, &max))
         {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_any)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin ();
+       j != m_ranges.end (); ++j)
+    {
+      if (i >= j->first && i <= j->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
+bool
+ArrayMatcher::IsSingle (uint32_t *index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  if (m_any || m_ranges.size () != 1 || m_ranges[0].first != m_ranges[0].second)
+    {
+      return false;
+    }
+  *index = m_ranges[0].first;
+  return true;
+}
 
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
@@ -243,7 +259,8 @@ public:
 private:
   void Canonicalize (void);
   void DoResolve (std::string path, Ptr<Object> root);
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::string path, Ptr<Object> root,
+                       const struct TypeId::AttributeInformation &info);
   void DoResolveOne (Ptr<Object> object);
   std::string GetResolvedPath (void) const;
   virtual void DoOne (Ptr<Object> object, std::string path) = 0;
@@ -440,10 +457,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
             {
               NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
               foundMatch = true;
-              ObjectPtrContainerValue vector;
-              root->GetAttribute (info.name, vector);
               m_workStack.push_back (info.name);
-              DoArrayResolve (pathLeft, vector);
+              DoArrayResolve (pathLeft, root, info);
               m_workStack.pop_back ();
             }
           // this could be anything else and we don't know what to do with it.
@@ -458,9 +473,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::string path, Ptr<Object> root,
+                          const struct TypeId::AttributeInformation &info)
 {
-  NS_LOG_FUNCTION(this << path << &container);
+  NS_LOG_FUNCTION(this << path << root << info.name);
   NS_ASSERT (path != "");
   NS_ASSERT ((path.find ("/")) == 0);
   std::string::size_type next = path.find ("/", 1);
@@ -472,6 +488,30 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
   std::string pathLeft = path.substr (next, path.size ()-next);
 
   ArrayMatcher matcher = ArrayMatcher (item);
+
+  //
+  // A single index, such as /NodeList/12, is looked up directly rather
+  // than by fetching the whole container and matching every index.
+  //
+  uint32_t index;
+  const ObjectPtrContainerAccessor *accessor =
+    dynamic_cast<const ObjectPtrContainerAccessor *> (PeekPointer (info.accessor));
+  if (accessor != 0 && matcher.IsSingle (&index))
+    {
+      Ptr<Object> object = accessor->Find (PeekPointer (root), index);
+      if (object != 0)
+        {
+          std::ostringstream oss;
+          oss << index;
+          m_workStack.push_back (oss.str ());
+          DoResolve (pathLeft, object);
+          m_workStack.pop_back ();
+        }
+      return;
+    }
+
+  ObjectPtrContainerValue container;
+  root->GetAttribute (info.name, container);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
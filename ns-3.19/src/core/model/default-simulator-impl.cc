@@ -22,13 +22,17 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
 #include "assert.h"
 #include "log.h"
+#include "string.h"
 
 #include <cmath>
+#include <algorithm>
+#include <fstream>
 
 // Note:  Logging in this file is largely avoided due to the
 // number of calls that are made to these functions and the possibility
@@ -47,6 +51,19 @@ DefaultSimulatorImpl::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::DefaultSimulatorImpl")
     .SetParent<SimulatorImpl> ()
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("ProfileFile",
+                   "If not empty, profile the events executed and write the report "
+                   "to this file, and a flame graph compatible profile to the same "
+                   "file name followed by .folded, when the simulator is destroyed.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+    .AddAttribute ("ProfileSampleInterval",
+                   "The simulation time interval between two samples of the "
+                   "number of pending events in the profile.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&DefaultSimulatorImpl::m_profileSampleInterval),
+                   MakeTimeChecker ())
   ;
   return tid;
 }
@@ -65,7 +82,8 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
+  m_eventsWithContext = 0;
+  m_profiler = 0;
   m_main = SystemThread::Self();
 }
 
@@ -84,6 +102,17 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  struct EventWithContext *ev = __sync_lock_test_and_set (&m_eventsWithContext,
+                                                          (struct EventWithContext *)0);
+  while (ev != 0)
+    {
+      struct EventWithContext *next = ev->next;
+      ev->event->Unref ();
+      delete ev;
+      ev = next;
+    }
+  delete m_profiler;
+  m_profiler = 0;
   SimulatorImpl::DoDispose ();
 }
 void
@@ -100,6 +129,27 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      WriteProfile ();
+      delete m_profiler;
+      m_profiler = 0;
+    }
+}
+
+void
+DefaultSimulatorImpl::WriteProfile (void) const
+{
+  NS_LOG_FUNCTION (this);
+  std::ofstream report (m_profileFile.c_str ());
+  if (!report)
+    {
+      NS_LOG_WARN ("Could not open " << m_profileFile);
+      return;
+    }
+  m_profiler->Write (report);
+  std::ofstream folded ((m_profileFile + ".folded").c_str ());
+  m_profiler->WriteFolded (folded);
 }
 
 void
@@ -129,6 +179,15 @@ DefaultSimulatorImpl::GetSystemId (void) const
 void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
+  // Events scheduled from other threads are only moved into the
+  // scheduler when the simulation time is about to advance: since
+  // their delay is relative to the current time, this gives the same
+  // ordering as merging them after every event, and the common case
+  // costs a single load of the stack head.
+  if (m_eventsWithContext != 0 && m_events->PeekNext ().key.m_ts != m_currentTs)
+    {
+      ProcessEventsWithContext ();
+    }
   Scheduler::Event next = m_events->RemoveNext ();
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
@@ -138,10 +197,18 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler != 0)
+    {
+      m_profiler->SampleQueue (m_currentTs, m_unscheduledEvents);
+      m_profiler->Begin (next.key.m_context, next.impl);
+      next.impl->Invoke ();
+      m_profiler->End ();
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
-
-  ProcessEventsWithContext ();
 }
 
 bool 
@@ -153,30 +220,36 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext == 0)
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  // detach the whole stack at once and reverse it to restore
+  // the order in which the events were scheduled.
+  struct EventWithContext *stack = __sync_lock_test_and_set (&m_eventsWithContext,
+                                                             (struct EventWithContext *)0);
+  struct EventWithContext *fifo = 0;
+  while (stack != 0)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
-       Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
-       ev.key.m_uid = m_uid;
-       m_uid++;
-       m_unscheduledEvents++;
-       m_events->Insert (ev);
+      struct EventWithContext *next = stack->next;
+      stack->next = fifo;
+      fifo = stack;
+      stack = next;
+    }
+  while (fifo != 0)
+    {
+      struct EventWithContext *event = fifo;
+      fifo = fifo->next;
+      Scheduler::Event ev;
+      ev.impl = event->event;
+      ev.key.m_ts = m_currentTs + event->timestamp;
+      ev.key.m_context = event->context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+      delete event;
     }
 }
 
@@ -188,9 +261,24 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (m_profiler == 0 && !m_profileFile.empty ())
+    {
+      m_profiler = new EventProfiler (std::max (m_profileSampleInterval.GetTimeStep (),
+                                                (int64_t)1));
+    }
 
-  while (!m_events->IsEmpty () && !m_stop) 
+  while (!m_stop) 
     {
+      if (m_events->IsEmpty ())
+        {
+          // pick up any event scheduled from another thread
+          // before declaring the simulation finished.
+          ProcessEventsWithContext ();
+          if (m_events->IsEmpty ())
+            {
+              break;
+            }
+        }
       ProcessOneEvent ();
     }
 
@@ -256,15 +344,17 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, E
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
-      ev.timestamp = time.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      struct EventWithContext *ev = new struct EventWithContext;
+      ev->context = context;
+      ev->timestamp = time.GetTimeStep ();
+      ev->event = event;
+      struct EventWithContext *head;
+      do
+        {
+          head = m_eventsWithContext;
+          ev->next = head;
+        }
+      while (__sync_val_compare_and_swap (&m_eventsWithContext, head, ev) != head);
     }
 }
 
@@ -25,14 +25,16 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "ns3/system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <string>
 
 namespace ns3 {
 
+class EventProfiler;
+
 /**
  * \ingroup simulator
  */
@@ -67,16 +69,24 @@ private:
   virtual void DoDispose (void);
   void ProcessOneEvent (void);
   void ProcessEventsWithContext (void);
+  void WriteProfile (void) const;
  
+  /**
+   * An event scheduled by ScheduleWithContext from a thread other
+   * than the main simulation thread.
+   *
+   * These events are pushed by any number of producer threads onto
+   * a lock-free intrusive stack and consumed by the main thread only,
+   * which detaches the whole stack with a single atomic exchange.
+   */
   struct EventWithContext {
     uint32_t context;
     uint64_t timestamp;
     EventImpl *event;
+    struct EventWithContext *next;
   };
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  EventsWithContext m_eventsWithContext;
-  bool m_eventsWithContextEmpty;
-  SystemMutex m_eventsWithContextMutex;
+  /// Head of the stack of events scheduled from other threads, most recent first.
+  struct EventWithContext * volatile m_eventsWithContext;
 
   typedef std::list<EventId> DestroyEvents;
   DestroyEvents m_destroyEvents;
@@ -92,6 +102,12 @@ private:
   int m_unscheduledEvents;
 
   SystemThread::ThreadId m_main;
+
+  /// Where to write the profile, profiling is disabled if empty.
+  std::string m_profileFile;
+  Time m_profileSampleInterval;
+  /// The profiler, created by Run if profiling is enabled.
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
@@ -60,4 +60,24 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const ObjectBase *
+EventImpl::GetHandler (uint64_t function[2]) const
+{
+  function[0] = 0;
+  function[1] = 0;
+  return 0;
+}
+
+const ObjectBase *
+EventImpl::AsObjectBase (const ObjectBase *object)
+{
+  return object;
+}
+
+const ObjectBase *
+EventImpl::AsObjectBase (const volatile void *object)
+{
+  return 0;
+}
+
 } // namespace ns3
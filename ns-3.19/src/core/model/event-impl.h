@@ -21,10 +21,13 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstring>
 #include "simple-ref-count.h"
 
 namespace ns3 {
 
+class ObjectBase;
+
 /**
  * \ingroup events
  * \brief a simulation event
@@ -57,14 +60,50 @@ public:
    * Invoked by the simulation engine before calling Invoke.
    */
   bool IsCancelled (void);
+  /**
+   * \param function the function or member function pointer which the
+   *        event invokes, copied byte by byte and zero-padded, or zeros
+   *        if the event does not know it
+   * \returns the object on which the member function is invoked if it
+   *          is an ObjectBase, 0 otherwise
+   *
+   * Used by the EventProfiler to tell apart the handlers of the events.
+   */
+  virtual const ObjectBase * GetHandler (uint64_t function[2]) const;
 
 protected:
   virtual void Notify (void) = 0;
+  /**
+   * \param f a function or member function pointer
+   * \param function the array in which to copy the bytes of f
+   *
+   * Implement GetHandler.
+   */
+  template <typename F>
+  static void CopyFunction (F f, uint64_t function[2]);
+  /**
+   * \param object the object of a member function
+   * \returns the object
+   */
+  static const ObjectBase * AsObjectBase (const ObjectBase *object);
+  /**
+   * \param object the object of a member function, which is not an ObjectBase
+   * \returns 0
+   */
+  static const ObjectBase * AsObjectBase (const volatile void *object);
 
 private:
   bool m_cancel;
 };
 
+template <typename F>
+void
+EventImpl::CopyFunction (F f, uint64_t function[2])
+{
+  std::memset (function, 0, 2 * sizeof (uint64_t));
+  std::memcpy (function, &f, sizeof (f) < 2 * sizeof (uint64_t) ? sizeof (f) : 2 * sizeof (uint64_t));
+}
+
 } // namespace ns3
 
 #endif /* EVENT_IMPL_H */
@@ -0,0 +1,325 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "object-base.h"
+#include "nstime.h"
+#include "log.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <time.h>
+#include <sys/time.h>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace ns3 {
+
+EventProfiler::Stats::Stats ()
+  : count (0),
+    ns (0)
+{
+}
+
+bool
+EventProfiler::Handler::operator < (const Handler &o) const
+{
+  if (type != o.type)
+    {
+      return type < o.type;
+    }
+  if (function[0] != o.function[0])
+    {
+      return function[0] < o.function[0];
+    }
+  if (function[1] != o.function[1])
+    {
+      return function[1] < o.function[1];
+    }
+  return tid < o.tid;
+}
+
+EventProfiler::EventProfiler (uint64_t sampleInterval)
+  : m_current (0),
+    m_begin (0),
+    m_sampleInterval (sampleInterval),
+    m_nextSample (0),
+    m_maxPending (0)
+{
+  NS_LOG_FUNCTION (this << sampleInterval);
+  m_start = GetWallClock ();
+}
+
+uint64_t
+EventProfiler::GetWallClock (void)
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t> (ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return static_cast<uint64_t> (tv.tv_sec) * 1000000000 + tv.tv_usec * 1000;
+#endif
+}
+
+void
+EventProfiler::Begin (uint32_t context, const EventImpl *event)
+{
+  // The handler is looked up before the event runs, which may delete
+  // the object it is invoked on
+  Handler handler;
+  handler.type = &typeid (*event);
+  const ObjectBase *object = event->GetHandler (handler.function);
+  if (object != 0)
+    {
+      handler.tid = object->GetInstanceTypeId ();
+    }
+  m_current = &m_profile[Key (context, handler)];
+  m_begin = GetWallClock ();
+}
+
+void
+EventProfiler::End (void)
+{
+  m_current->count++;
+  m_current->ns += GetWallClock () - m_begin;
+}
+
+void
+EventProfiler::DoSampleQueue (uint64_t ts, uint32_t pending)
+{
+  m_samples.push_back (std::make_pair (ts, pending));
+  m_maxPending = std::max (m_maxPending, pending);
+  m_nextSample = ts - ts % m_sampleInterval + m_sampleInterval;
+}
+
+uint64_t
+EventProfiler::GetEvents (void) const
+{
+  uint64_t events = 0;
+  for (Profile::const_iterator i = m_profile.begin (); i != m_profile.end (); ++i)
+    {
+      events += i->second.count;
+    }
+  return events;
+}
+
+uint64_t
+EventProfiler::GetContextEvents (uint32_t context) const
+{
+  uint64_t events = 0;
+  Handler first;
+  first.type = 0;
+  first.function[0] = 0;
+  first.function[1] = 0;
+  for (Profile::const_iterator i = m_profile.lower_bound (Key (context, first));
+       i != m_profile.end () && i->first.first == context; ++i)
+    {
+      events += i->second.count;
+    }
+  return events;
+}
+
+std::string
+EventProfiler::GetEventName (const std::type_info *type)
+{
+  std::string name = type->name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  // The events created by MakeEvent are local classes of the MakeEvent
+  // function templates: the first template argument, the type of the
+  // function or member function invoked, is what identifies them.
+  std::string::size_type start = name.find ("MakeEvent<");
+  if (start == std::string::npos)
+    {
+      return name;
+    }
+  start += 10;
+  int depth = 0;
+  for (std::string::size_type i = start; i < name.size (); ++i)
+    {
+      char c = name[i];
+      if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if ((c == '>' || c == ')') && depth > 0)
+        {
+          depth--;
+        }
+      else if ((c == ',' || c == '>') && depth == 0)
+        {
+          return name.substr (start, i - start);
+        }
+    }
+  return name;
+}
+
+std::string
+EventProfiler::GetHandlerName (const Handler &handler)
+{
+  std::ostringstream oss;
+  oss << GetEventName (handler.type);
+  if (handler.function[0] != 0 || handler.function[1] != 0)
+    {
+      oss << " @0x" << std::hex << handler.function[0];
+      if (handler.function[1] != 0)
+        {
+          oss << "+0x" << handler.function[1];
+        }
+    }
+  return oss.str ();
+}
+
+std::string
+EventProfiler::GetContextName (uint32_t context)
+{
+  if (context == 0xffffffff)
+    {
+      return "no-context";
+    }
+  std::ostringstream oss;
+  oss << "context-" << context;
+  return oss.str ();
+}
+
+namespace {
+
+typedef std::pair<uint64_t, uint64_t> CountTime;
+typedef std::map<std::string, CountTime> Totals;
+
+bool
+CompareTime (const Totals::value_type *a, const Totals::value_type *b)
+{
+  return a->second.second > b->second.second;
+}
+
+void
+WriteTotals (std::ostream &os, const Totals &totals)
+{
+  std::vector<const Totals::value_type *> sorted;
+  for (Totals::const_iterator i = totals.begin (); i != totals.end (); ++i)
+    {
+      sorted.push_back (&*i);
+    }
+  std::sort (sorted.begin (), sorted.end (), CompareTime);
+  os << std::setw (12) << "events" << std::setw (14) << "total(ms)"
+     << std::setw (12) << "mean(us)" << "  name" << std::endl;
+  for (std::vector<const Totals::value_type *>::const_iterator i = sorted.begin ();
+       i != sorted.end (); ++i)
+    {
+      uint64_t count = (*i)->second.first;
+      uint64_t ns = (*i)->second.second;
+      os << std::setw (12) << count
+         << std::setw (14) << std::fixed << std::setprecision (3) << ns / 1e6
+         << std::setw (12) << ns / 1e3 / count
+         << "  " << (*i)->first << std::endl;
+    }
+}
+
+} // anonymous namespace
+
+void
+EventProfiler::Write (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  Totals handlers;
+  Totals contexts;
+  uint64_t events = 0;
+  uint64_t ns = 0;
+  std::map<Handler, std::string> names;
+  for (Profile::const_iterator i = m_profile.begin (); i != m_profile.end (); ++i)
+    {
+      std::map<Handler, std::string>::iterator name = names.find (i->first.second);
+      if (name == names.end ())
+        {
+          std::string handler = GetHandlerName (i->first.second);
+          if (i->first.second.tid != TypeId ())
+            {
+              handler += " on " + i->first.second.tid.GetName ();
+            }
+          name = names.insert (std::make_pair (i->first.second, handler)).first;
+        }
+      CountTime &type = handlers[name->second];
+      type.first += i->second.count;
+      type.second += i->second.ns;
+      CountTime &context = contexts[GetContextName (i->first.first)];
+      context.first += i->second.count;
+      context.second += i->second.ns;
+      events += i->second.count;
+      ns += i->second.ns;
+    }
+
+  os << "# events: " << events
+     << " in events (s): " << ns / 1e9
+     << " wall-clock (s): " << (GetWallClock () - m_start) / 1e9 << std::endl;
+  os << std::endl << "# by handler" << std::endl;
+  WriteTotals (os, handlers);
+  os << std::endl << "# by context" << std::endl;
+  WriteTotals (os, contexts);
+  os << std::endl << "# pending events, max: " << m_maxPending << std::endl;
+  os << std::setw (16) << "time(s)" << std::setw (12) << "events" << std::endl;
+  for (std::vector<std::pair<uint64_t, uint32_t> >::const_iterator i = m_samples.begin ();
+       i != m_samples.end (); ++i)
+    {
+      os << std::setw (16) << std::setprecision (6) << TimeStep (i->first).GetSeconds ()
+         << std::setw (12) << i->second << std::endl;
+    }
+}
+
+void
+EventProfiler::WriteFolded (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  std::map<Handler, std::string> names;
+  for (Profile::const_iterator i = m_profile.begin (); i != m_profile.end (); ++i)
+    {
+      std::map<Handler, std::string>::iterator name = names.find (i->first.second);
+      if (name == names.end ())
+        {
+          // the folded format separates frames with ';' and the weight with a space
+          std::string frame = GetHandlerName (i->first.second);
+          std::replace (frame.begin (), frame.end (), ';', ',');
+          std::replace (frame.begin (), frame.end (), ' ', '_');
+          if (i->first.second.tid != TypeId ())
+            {
+              frame = i->first.second.tid.GetName () + ";" + frame;
+            }
+          name = names.insert (std::make_pair (i->first.second, frame)).first;
+        }
+      os << GetContextName (i->first.first) << ";" << name->second
+         << " " << (i->second.ns + 500) / 1000 << std::endl;
+    }
+}
+
+} // namespace ns3
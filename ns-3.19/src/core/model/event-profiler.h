@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <typeinfo>
+#include <ostream>
+#include "type-id.h"
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Collect where the wall-clock time of a simulation goes.
+ *
+ * The simulator implementation calls Begin and End around the
+ * invocation of each event.  The profiler accumulates the number of
+ * events and the wall-clock time spent in them per handler, per
+ * context (node id) and per (context, handler) pair, and samples the
+ * number of pending events at a regular simulation time interval.
+ *
+ * A handler is identified by the EventImpl subclass, which MakeEvent
+ * instantiates for each function signature, by the function or member
+ * function pointer the event invokes, and by the TypeId of the object
+ * it is invoked on, if that object is an ObjectBase.  The report names
+ * a handler after its signature and the bytes of its pointer, in
+ * hexadecimal, since the function names are not available at run time;
+ * for a non-virtual function, these are its address.
+ *
+ * Write produces a human-readable report, and WriteFolded a file
+ * in the "folded stacks" format of the FlameGraph tools, with one
+ * context;TypeId;handler line per pair weighted by microseconds.
+ */
+class EventProfiler
+{
+public:
+  /**
+   * \param sampleInterval the simulation time interval between two
+   *        samples of the number of pending events, in time steps.
+   */
+  EventProfiler (uint64_t sampleInterval);
+
+  /**
+   * \param context the context of the event
+   * \param event the event about to be invoked
+   */
+  void Begin (uint32_t context, const EventImpl *event);
+  /**
+   * Record the time spent since Begin in the event passed to Begin.
+   */
+  void End (void);
+  /**
+   * \param ts the current simulation time, in time steps
+   * \param pending the number of events in the scheduler
+   *
+   * Record a sample if the sampling interval has elapsed since the
+   * previous one.
+   */
+  void SampleQueue (uint64_t ts, uint32_t pending)
+  {
+    if (ts >= m_nextSample)
+      {
+        DoSampleQueue (ts, pending);
+      }
+  }
+
+  /**
+   * \returns the number of events recorded.
+   */
+  uint64_t GetEvents (void) const;
+  /**
+   * \param context a context
+   * \returns the number of events recorded in that context.
+   */
+  uint64_t GetContextEvents (uint32_t context) const;
+
+  /**
+   * Write the profile report.
+   */
+  void Write (std::ostream &os) const;
+  /**
+   * Write the profile as folded stacks.
+   */
+  void WriteFolded (std::ostream &os) const;
+
+private:
+  struct Stats
+  {
+    Stats ();
+    uint64_t count;
+    uint64_t ns;
+  };
+  /// The handler of an event, see EventImpl::GetHandler.
+  struct Handler
+  {
+    const std::type_info *type;
+    uint64_t function[2];
+    TypeId tid;
+    bool operator < (const Handler &o) const;
+  };
+  typedef std::pair<uint32_t, Handler> Key;
+  typedef std::map<Key, Stats> Profile;
+
+  void DoSampleQueue (uint64_t ts, uint32_t pending);
+  static uint64_t GetWallClock (void);
+  static std::string GetEventName (const std::type_info *type);
+  static std::string GetHandlerName (const Handler &handler);
+  static std::string GetContextName (uint32_t context);
+
+  Profile m_profile;
+  Stats *m_current;
+  uint64_t m_begin;
+  uint64_t m_sampleInterval;
+  uint64_t m_nextSample;
+  uint32_t m_maxPending;
+  std::vector<std::pair<uint64_t, uint32_t> > m_samples;
+  uint64_t m_start;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
@@ -26,6 +26,11 @@ protected:
     {
       (*m_function)();
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return 0;
+    }
 private:
     F m_function;
   } *ev = new EventFunctionImpl0 (f);
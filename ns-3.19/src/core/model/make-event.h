@@ -93,6 +93,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return AsObjectBase (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -123,6 +128,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return AsObjectBase (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -154,6 +164,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return AsObjectBase (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -187,6 +202,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return AsObjectBase (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -222,6 +242,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return AsObjectBase (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -260,6 +285,11 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return AsObjectBase (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -294,6 +324,11 @@ private:
     {
       (*m_function)(m_a1);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -324,6 +359,11 @@ private:
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -357,6 +397,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -392,6 +437,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -429,6 +479,11 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const ObjectBase * GetHandler (uint64_t function[2]) const
+    {
+      CopyFunction (m_function, function);
+      return 0;
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -432,6 +432,16 @@ public:
    */
   inline static Time FromDouble (double value, enum Unit timeUnit)
   {
+    // Integral values which a double represents exactly (up to 2^53),
+    // such as Seconds (1.0), do not need the fixed-point conversion.
+    if (value >= -9007199254740992.0 && value <= 9007199254740992.0)
+      {
+        int64_t integer = static_cast<int64_t> (value);
+        if (integer == value)
+          {
+            return FromInt64 (integer, PeekInformation (timeUnit));
+          }
+      }
     return From (int64x64_t (value), timeUnit);
   }
   /**
@@ -443,11 +453,25 @@ public:
    */
   inline double ToDouble (enum Unit timeUnit) const
   {
-    return To (timeUnit).GetDouble ();
+    struct Information *info = PeekInformation (timeUnit);
+    double retval = static_cast<double> (m_data);
+    if (info->toMul)
+      {
+        retval *= info->factor;
+      }
+    else
+      {
+        retval /= info->factor;
+      }
+    return retval;
   }
   static inline Time From (const int64x64_t &from, enum Unit timeUnit)
   {
     struct Information *info = PeekInformation (timeUnit);
+    if (from.GetLow () == 0)
+      {
+        return FromInt64 (from.GetHigh (), info);
+      }
     // DO NOT REMOVE this temporary variable. It's here
     // to work around a compiler bug in gcc 3.4
     int64x64_t retval = from;
@@ -522,6 +546,26 @@ private:
   {
     return &(PeekResolution ()->info[timeUnit]);
   }
+  /**
+   * \param value an integral number of time units
+   * \param info the conversion info of these units
+   * \return a new Time object
+   *
+   * Convert with 64 bit integer arithmetic only, truncating towards
+   * zero like the fixed-point conversion of From does.
+   */
+  static inline Time FromInt64 (int64_t value, const struct Information *info)
+  {
+    if (info->fromMul)
+      {
+        value *= info->factor;
+      }
+    else
+      {
+        value /= info->factor;
+      }
+    return Time (value);
+  }
 
   static struct Resolution SetDefaultNsResolution (void);
   static void SetResolution (enum Unit unit, struct Resolution *resolution,
@@ -139,6 +139,16 @@ public:
   virtual bool Get (const ObjectBase * object, AttributeValue &value) const;
   virtual bool HasGetter (void) const;
   virtual bool HasSetter (void) const;
+  /**
+   * \param object the object which holds the container
+   * \param index the index of the requested object in the container
+   * \returns the requested object, or zero if there is none.
+   *
+   * Unlike Get, this does not copy the whole container: when the
+   * object at position index has index index, as in a vector, it is
+   * found without looking at the other objects.
+   */
+  Ptr<Object> Find (const ObjectBase *object, uint32_t index) const;
 private:
   virtual bool DoGetN (const ObjectBase *object, uint32_t *n) const = 0;
   virtual Ptr<Object> DoGet (const ObjectBase *object, uint32_t i, uint32_t *index) const = 0;
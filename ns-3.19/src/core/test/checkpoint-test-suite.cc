@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/checkpoint.h"
+
+#include <unistd.h>
+
+using namespace ns3;
+
+class CheckpointTestCase : public TestCase
+{
+public:
+  CheckpointTestCase ();
+private:
+  virtual void DoRun (void);
+  void Tick (void);
+
+  uint32_t m_ticks;
+  uint32_t m_increment;
+  uint64_t m_sum;
+};
+
+CheckpointTestCase::CheckpointTestCase ()
+  : TestCase ("Check that the variants forked from a checkpoint continue the simulation")
+{
+}
+
+void
+CheckpointTestCase::Tick (void)
+{
+  m_ticks++;
+  m_sum += m_increment;
+  Simulator::Schedule (Seconds (1), &CheckpointTestCase::Tick, this);
+}
+
+void
+CheckpointTestCase::DoRun (void)
+{
+  m_ticks = 0;
+  m_increment = 1;
+  m_sum = 0;
+  Simulator::Schedule (Seconds (0.5), &CheckpointTestCase::Tick, this);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_ticks, 10, "Wrong number of events in the warm-up");
+
+  // the last variant fails on purpose
+  uint32_t variant = Checkpoint::Fork (4, 2);
+  NS_TEST_ASSERT_MSG_EQ (Checkpoint::GetVariant (), variant, "Wrong variant number");
+  if (variant != 0)
+    {
+      // in a copy of the test runner: report the result by the exit status only.
+      m_increment = variant;
+      Simulator::Stop (Seconds (10));
+      Simulator::Run ();
+      bool ok = Simulator::Now () == Seconds (20)
+        && m_ticks == 20
+        && m_sum == 10 + 10 * variant
+        && variant != 4;
+      _exit (ok ? 0 : 1);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::Wait (), 1, "Wrong number of failed variants");
+
+  // the original process is not affected by its variants.
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (10), "Wrong time after the checkpoint");
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_ticks, 15, "Wrong number of events after the checkpoint");
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 15, "Wrong state after the checkpoint");
+  Simulator::Destroy ();
+}
+
+static class CheckpointTestSuite : public TestSuite
+{
+public:
+  CheckpointTestSuite ()
+    : TestSuite ("checkpoint", UNIT)
+  {
+    AddTestCase (new CheckpointTestCase (), TestCase::QUICK);
+  }
+} g_checkpointTestSuite;
@@ -457,6 +457,18 @@ ObjectVectorConfigTestCase::DoRun (void)
 
   obj3->GetAttribute ("A", iv);
   NS_TEST_ASSERT_MSG_EQ (iv.Get (), -16, "Object Attribute \"A\" not set as expected");
+
+  //
+  // A single index is looked up directly; make sure it finds the right
+  // object with the right context, and nothing past the end of the vector.
+  //
+  Config::MatchContainer matches = Config::LookupMatches ("/NodeA/NodeB/NodesB/2");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Exactly one object should match");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), obj2, "The wrong object matched");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetMatchedPath (0), "/NodeA/NodeB/NodesB/2/", "Wrong matched path");
+
+  matches = Config::LookupMatches ("/NodeA/NodeB/NodesB/4");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 0, "No object should match past the end of the vector");
 }
 
 // ===========================================================================
@@ -23,6 +23,14 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/random-variable-stream.h"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
 
 using namespace ns3;
 
@@ -459,6 +467,135 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorProfileTestCase : public TestCase
+{
+public:
+  SimulatorProfileTestCase ();
+private:
+  virtual void DoRun (void);
+  void A (void);
+  void B (int b);
+  void C (void);
+  uint64_t GetEvents (std::string line);
+};
+
+SimulatorProfileTestCase::SimulatorProfileTestCase ()
+  : TestCase ("Check the event profile of the default simulator")
+{
+}
+
+void
+SimulatorProfileTestCase::A (void)
+{
+}
+
+void
+SimulatorProfileTestCase::B (int b)
+{
+}
+
+void
+SimulatorProfileTestCase::C (void)
+{
+}
+
+uint64_t
+SimulatorProfileTestCase::GetEvents (std::string line)
+{
+  std::istringstream iss (line);
+  uint64_t events = 0;
+  iss >> events;
+  return events;
+}
+
+void
+SimulatorProfileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("profile.txt");
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (filename));
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileSampleInterval", TimeValue (Seconds (1)));
+
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Simulator::ScheduleWithContext (3, Seconds (i), &SimulatorProfileTestCase::A, this);
+    }
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &SimulatorProfileTestCase::B, this, i);
+    }
+  // same signature as A
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &SimulatorProfileTestCase::C, this);
+    }
+  // a member function of the base class, invoked on a subclass
+  Ptr<RandomVariableStream> stream = CreateObject<UniformRandomVariable> ();
+  Simulator::Schedule (Seconds (1), &RandomVariableStream::SetStream, stream, 1);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileFile", StringValue (""));
+
+  std::ifstream report (filename.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (report.good (), true, "No profile written");
+  std::string line;
+  std::getline (report, line);
+  NS_TEST_EXPECT_MSG_EQ (line.substr (0, 12), "# events: 19", "Wrong number of events");
+  uint64_t context3 = 0;
+  std::vector<uint64_t> typeA;
+  uint64_t typeB = 0;
+  uint64_t subclass = 0;
+  uint32_t samples = 0;
+  bool inSamples = false;
+  while (std::getline (report, line))
+    {
+      if (line.find ("  context-3") != std::string::npos)
+        {
+          context3 = GetEvents (line);
+        }
+      else if (line.find ("SimulatorProfileTestCase::*)()") != std::string::npos)
+        {
+          typeA.push_back (GetEvents (line));
+        }
+      else if (line.find ("RandomVariableStream::*)(long") != std::string::npos
+               && line.find (" on ns3::UniformRandomVariable") != std::string::npos)
+        {
+          subclass = GetEvents (line);
+        }
+      else if (line.find ("SimulatorProfileTestCase::*)(int)") != std::string::npos)
+        {
+          typeB = GetEvents (line);
+        }
+      else if (line.find ("# pending events") != std::string::npos)
+        {
+          inSamples = true;
+          std::getline (report, line);
+        }
+      else if (inSamples && !line.empty ())
+        {
+          samples++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (context3, 10, "Wrong number of events in context 3");
+  // the handlers are sorted by time, not by count
+  std::sort (typeA.begin (), typeA.end ());
+  NS_TEST_ASSERT_MSG_EQ (typeA.size (), 2, "Handlers of the same type not told apart");
+  NS_TEST_EXPECT_MSG_EQ (typeA[0], 3, "Wrong number of events of the third handler");
+  NS_TEST_EXPECT_MSG_EQ (typeA[1], 10, "Wrong number of events of the first handler");
+  NS_TEST_EXPECT_MSG_EQ (typeB, 5, "Wrong number of events of the second handler");
+  NS_TEST_EXPECT_MSG_EQ (subclass, 1, "Wrong TypeId of the object of a handler");
+  NS_TEST_EXPECT_MSG_EQ (samples, 10, "Wrong number of queue samples");
+
+  std::ifstream folded ((filename + ".folded").c_str ());
+  NS_TEST_ASSERT_MSG_EQ (folded.good (), true, "No folded profile written");
+  uint32_t stacks = 0;
+  while (std::getline (folded, line))
+    {
+      NS_TEST_EXPECT_MSG_NE (line.find (';'), std::string::npos, "Not a folded stack");
+      stacks++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (stacks, 4, "Wrong number of stacks");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +612,6 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorProfileTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -22,6 +22,9 @@
 #include "ns3/nstime.h"
 #include "ns3/test.h"
 
+#include <ctime>
+#include <iostream>
+
 using namespace ns3;
 
 class TimeSimpleTestCase : public TestCase
@@ -150,6 +153,52 @@ TimesWithSignsTestCase::DoTeardown (void)
 {
 }
 
+class TimeConversionTestCase : public TestCase
+{
+public:
+  TimeConversionTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TimeConversionTestCase::TimeConversionTestCase ()
+  : TestCase ("Check the integer conversion paths against the fixed-point ones")
+{
+}
+
+void
+TimeConversionTestCase::DoRun (void)
+{
+  int64_t stepsPerSecond = Time::FromInteger (1, Time::S).GetTimeStep ();
+
+  NS_TEST_ASSERT_MSG_EQ (Seconds (3.0).GetTimeStep (), 3 * stepsPerSecond,
+                         "integral seconds");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (-3.0).GetTimeStep (), -3 * stepsPerSecond,
+                         "negative integral seconds");
+  NS_TEST_ASSERT_MSG_EQ (MilliSeconds (7.0), MilliSeconds (7), "integral milliseconds");
+  NS_TEST_ASSERT_MSG_EQ (Time::FromDouble (25.0, Time::US), MicroSeconds (25),
+                         "integral microseconds");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (int64x64_t (2)), Seconds (2.0), "integral fixed-point seconds");
+
+  // fractional values still go through the fixed-point conversion
+  NS_TEST_ASSERT_MSG_EQ (MilliSeconds (int64x64_t (1.5)), MicroSeconds (1500),
+                         "fractional milliseconds");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (0.25).GetTimeStep (), stepsPerSecond / 4,
+                         "fractional seconds");
+
+  // units finer than the resolution truncate towards zero
+  NS_TEST_ASSERT_MSG_EQ (Time::FromDouble (-1500.0, Time::FS),
+                         Time (0) - Time::FromDouble (1500.0, Time::FS),
+                         "truncation of negative values");
+  NS_TEST_ASSERT_MSG_EQ (Time::FromDouble (1500.0, Time::FS),
+                         Time::From (int64x64_t (1500.5), Time::FS),
+                         "truncation of positive values");
+
+  NS_TEST_ASSERT_MSG_EQ (Seconds (0.25).GetSeconds (), 0.25, "exact seconds");
+  NS_TEST_ASSERT_MSG_EQ (MilliSeconds (1500).GetSeconds (), 1.5, "exact milliseconds");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (2.0).GetMilliSeconds (), 2000, "seconds to milliseconds");
+}
+
 static class TimeTestSuite : public TestSuite
 {
 public:
@@ -158,5 +207,99 @@ public:
   {
     AddTestCase (new TimeSimpleTestCase (), TestCase::QUICK);
     AddTestCase (new TimesWithSignsTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeConversionTestCase (), TestCase::QUICK);
   }
 } g_timeTestSuite;
+
+
+//----------------------------
+//
+// Performance test
+
+class TimeConversionTimeTestCase : public TestCase
+{
+public:
+  TimeConversionTimeTestCase ();
+private:
+  virtual void DoRun (void);
+  void Report (const std::string how, const clock_t delta) const;
+
+  enum { REPETITIONS = 10000000 };
+};
+
+TimeConversionTimeTestCase::TimeConversionTimeTestCase ()
+  : TestCase ("Measure average conversion time")
+{
+}
+
+void
+TimeConversionTimeTestCase::DoRun (void)
+{
+  std::cout << GetName () << ": reps: " << REPETITIONS << std::endl;
+
+  int64x64_t stepsPerSecond = int64x64_t (Time::FromInteger (1, Time::S).GetTimeStep ());
+  int64_t sum = 0;
+
+  // what Seconds (double) did before the integer fast path
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      int64x64_t value = int64x64_t (static_cast<double> (i & 0xff));
+      value *= stepsPerSecond;
+      sum += Time (value).GetTimeStep ();
+    }
+  Report ("fixed-point seconds", clock () - start);
+
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      sum += Seconds (static_cast<double> (i & 0xff)).GetTimeStep ();
+    }
+  Report ("integral seconds", clock () - start);
+
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      sum += Seconds (0.5 + (i & 0xff)).GetTimeStep ();
+    }
+  Report ("fractional seconds", clock () - start);
+
+  double total = 0;
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      total += TimeStep (i).To (Time::S).GetDouble ();
+    }
+  Report ("fixed-point GetSeconds", clock () - start);
+
+  start = clock ();
+  for (uint32_t i = 0; i < REPETITIONS; ++i)
+    {
+      total += TimeStep (i).GetSeconds ();
+    }
+  Report ("GetSeconds", clock () - start);
+
+  // keep the loops from being optimized away
+  NS_TEST_EXPECT_MSG_NE (sum + total, 0, "conversions had no result");
+}
+
+void
+TimeConversionTimeTestCase::Report (const std::string how, const clock_t delta) const
+{
+  double per = 1E9 * double (delta) / (double (REPETITIONS) * double (CLOCKS_PER_SEC));
+  std::cout << GetName () << ": " << how << ": "
+            << "ticks: " << delta
+            << "\tper: " << per
+            << " nanosec/conversion"
+            << std::endl;
+}
+
+static class TimePerformanceSuite : public TestSuite
+{
+public:
+  TimePerformanceSuite ()
+    : TestSuite ("time-perf", PERFORMANCE)
+  {
+    AddTestCase (new TimeConversionTimeTestCase (), TestCase::QUICK);
+  }
+} g_timePerformanceSuite;
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the throughput of the TCP send and receive buffers alone: the
+// application writes are added to a TcpTxBuffer, cut into segments, handed
+// to a TcpRxBuffer (every reorder-th pair of segments swapped, and every
+// retransmit-th segment sent twice), read back by the application and
+// acknowledged.
+//
+//   ./waf --run "tcp-buffer-benchmark --bytes=1000000000 --writeSize=1000"
+
+#include <iostream>
+#include <vector>
+#include "ns3/core-module.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint64_t bytes = 100000000;
+  uint32_t writeSize = 1000;
+  uint32_t segmentSize = 1448;
+  uint32_t bufferSize = 131072;
+  uint32_t reorder = 0;
+  uint32_t retransmit = 0;
+
+  CommandLine cmd;
+  cmd.AddValue ("bytes", "Number of bytes to transfer", bytes);
+  cmd.AddValue ("writeSize", "Size of the application writes", writeSize);
+  cmd.AddValue ("segmentSize", "Size of the segments", segmentSize);
+  cmd.AddValue ("bufferSize", "Size of the send and receive buffers", bufferSize);
+  cmd.AddValue ("reorder", "Swap every reorder-th pair of segments (0 to disable)", reorder);
+  cmd.AddValue ("retransmit", "Send every retransmit-th segment twice (0 to disable)", retransmit);
+  cmd.Parse (argc, argv);
+
+  Ptr<TcpTxBuffer> tx = CreateObject<TcpTxBuffer> ();
+  Ptr<TcpRxBuffer> rx = CreateObject<TcpRxBuffer> ();
+  tx->SetMaxBufferSize (bufferSize);
+  rx->SetMaxBufferSize (bufferSize);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  uint64_t written = 0;
+  uint64_t read = 0;
+  uint64_t segments = 0;
+  SequenceNumber32 next (0);
+  std::vector<std::pair<Ptr<Packet>, TcpHeader> > flight;
+  while (read < bytes)
+    {
+      // the application fills the send buffer
+      while (written < bytes && tx->Available () >= writeSize)
+        {
+          tx->Add (Create<Packet> (writeSize));
+          written += writeSize;
+        }
+      // a window of segments is sent
+      while (tx->SizeFromSequence (next) > 0)
+        {
+          TcpHeader header;
+          header.SetSequenceNumber (next);
+          Ptr<Packet> p = tx->CopyFromSequence (segmentSize, next);
+          next += p->GetSize ();
+          flight.push_back (std::make_pair (p, header));
+          if (retransmit != 0 && ++segments % retransmit == 0)
+            {
+              flight.push_back (std::make_pair (p->Copy (), header));
+            }
+        }
+      if (reorder != 0)
+        {
+          for (uint32_t i = reorder - 1; i + 1 < flight.size (); i += reorder)
+            {
+              std::swap (flight[i], flight[i + 1]);
+            }
+        }
+      // the segments are received and read by the application
+      for (uint32_t i = 0; i < flight.size (); i++)
+        {
+          rx->Add (flight[i].first, flight[i].second);
+          Ptr<Packet> p = rx->Extract (rx->Available ());
+          if (p != 0)
+            {
+              read += p->GetSize ();
+            }
+        }
+      flight.clear ();
+      // and acknowledged
+      tx->DiscardUpTo (rx->NextRxSequence ());
+    }
+  int64_t ms = clock.End ();
+
+  std::cout << "transferred " << read << " bytes in " << ms << " ms";
+  if (ms > 0)
+    {
+      std::cout << " (" << read * 8 / 1000 / ms << " Mbit/s)";
+    }
+  std::cout << std::endl;
+  return 0;
+}
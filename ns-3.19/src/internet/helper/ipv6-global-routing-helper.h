@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IPV6_GLOBAL_ROUTING_HELPER_H
+#define IPV6_GLOBAL_ROUTING_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/ipv6-routing-helper.h"
+
+namespace ns3 {
+
+/**
+ * \brief Helper class that adds ns3::Ipv6GlobalRouting objects
+ *
+ * The directly connected prefixes are not in the global routes, so the
+ * protocol is meant to go in an Ipv6ListRouting, below Ipv6StaticRouting:
+ *
+ * \code
+ *   Ipv6ListRoutingHelper list;
+ *   list.Add (Ipv6StaticRoutingHelper (), 0);
+ *   list.Add (Ipv6GlobalRoutingHelper (), -10);
+ *   internet.SetRoutingHelper (list);
+ * \endcode
+ */
+class Ipv6GlobalRoutingHelper  : public Ipv6RoutingHelper
+{
+public:
+  /**
+   * \brief Construct a GlobalRoutingHelper to make life easier for managing
+   * global routing tasks.
+   */
+  Ipv6GlobalRoutingHelper ();
+
+  /**
+   * \brief Construct a GlobalRoutingHelper from another previously initialized
+   * instance (Copy Constructor).
+   */
+  Ipv6GlobalRoutingHelper (const Ipv6GlobalRoutingHelper &);
+
+  /**
+   * \internal
+   * \returns pointer to clone of this Ipv6GlobalRoutingHelper
+   *
+   * This method is mainly for internal use by the other helpers;
+   * clients are expected to free the dynamic memory allocated by this method
+   */
+  Ipv6GlobalRoutingHelper* Copy (void) const;
+
+  /**
+   * \param node the node on which the routing protocol will run
+   * \returns a newly-created routing protocol
+   *
+   * This method will be called by ns3::InternetStackHelper::Install
+   */
+  virtual Ptr<Ipv6RoutingProtocol> Create (Ptr<Node> node) const;
+
+  /**
+   * \brief Build a routing database and initialize the routing tables of
+   * the nodes with an Ipv6GlobalRouting.
+   *
+   * Later changes of their interfaces and addresses update the routes.
+   */
+  static void PopulateRoutingTables (void);
+
+  /**
+   * \brief Remove all the global routes, and compute them again from
+   * scratch.
+   *
+   * Needed when routers are added after PopulateRoutingTables ().
+   */
+  static void RecomputeRoutingTables (void);
+private:
+  /**
+   * \internal
+   * \brief Assignment operator declared private and not implemented to disallow
+   * assignment and prevent the compiler from happily inserting its own.
+   * \return
+   */
+  Ipv6GlobalRoutingHelper &operator = (const Ipv6GlobalRoutingHelper &);
+};
+
+} // namespace ns3
+
+#endif /* IPV6_GLOBAL_ROUTING_HELPER_H */
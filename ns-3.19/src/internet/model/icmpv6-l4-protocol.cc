@@ -76,6 +76,10 @@ TypeId Icmpv6L4Protocol::GetTypeId ()
                    BooleanValue (true),
                    MakeBooleanAccessor (&Icmpv6L4Protocol::m_alwaysDad),
                    MakeBooleanChecker ())
+    .AddAttribute ("OptimisticDad", "Use the new addresses while their DAD runs (RFC 4429).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Icmpv6L4Protocol::m_optimisticDad),
+                   MakeBooleanChecker ())
     .AddAttribute ("SolicitationJitter", "The jitter in ms a node is allowed to wait before sending any solicitation . Some jitter aims to prevent collisions. By default, the model will wait for a duration in ms defined by a uniform random-variable between 0 and SolicitationJitter",
                    StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=10.0]"),
                    MakePointerAccessor (&Icmpv6L4Protocol::m_solicitationJitter),
@@ -171,6 +175,75 @@ bool Icmpv6L4Protocol::IsAlwaysDad () const
   return m_alwaysDad;
 }
 
+bool Icmpv6L4Protocol::IsOptimisticDad () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_optimisticDad;
+}
+
+void Icmpv6L4Protocol::StartDad (Ipv6Address target, Ptr<Ipv6Interface> interface)
+{
+  NS_LOG_FUNCTION (this << target << interface);
+
+  if (!m_alwaysDad)
+    {
+      /* the address keeps the state it was given */
+      return;
+    }
+
+  if (m_optimisticDad)
+    {
+      interface->SetState (target, Ipv6InterfaceAddress::TENTATIVE_OPTIMISTIC);
+      DoDAD (target, interface);
+      /* the interface is not set up when its link-local address is added */
+      Simulator::ScheduleNow (&Icmpv6L4Protocol::SolicitRouters, this, target, PeekPointer (interface));
+    }
+  else
+    {
+      interface->SetState (target, Ipv6InterfaceAddress::TENTATIVE);
+      Simulator::Schedule (Seconds (0.), &Icmpv6L4Protocol::DoDAD, this, target, interface);
+    }
+  Simulator::Schedule (Seconds (1.), &Icmpv6L4Protocol::FunctionDadTimeout, this, PeekPointer (interface), target);
+}
+
+void Icmpv6L4Protocol::SolicitRouters (Ipv6Address src, Ipv6Interface* interface)
+{
+  NS_LOG_FUNCTION (this << src << interface);
+
+  /* send an RS if our interface is not forwarding (router) and if address is a link-local ones
+   * (because we will send RS with it)
+   */
+  if (!interface->IsForwarding () && src.IsLinkLocal ())
+    {
+      /* \todo Add random delays before sending RS
+       * because all nodes start at the same time, there will be many of RS arround 1 second of simulation time
+       */
+      SendRS (src, Ipv6Address::GetAllRoutersMulticast (), interface->GetDevice ()->GetAddress ());
+    }
+}
+
+bool Icmpv6L4Protocol::IsOptimisticAddress (Ipv6Address address) const
+{
+  NS_LOG_FUNCTION (this << address);
+
+  Ptr<Ipv6L3Protocol> ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
+  int32_t index = ipv6->GetInterfaceForAddress (address);
+  if (index < 0)
+    {
+      return false;
+    }
+  Ptr<Ipv6Interface> interface = ipv6->GetInterface (index);
+  for (uint32_t i = 0; i < interface->GetNAddresses (); i++)
+    {
+      Ipv6InterfaceAddress ifaddr = interface->GetAddress (i);
+      if (ifaddr.GetAddress () == address)
+        {
+          return ifaddr.GetState () == Ipv6InterfaceAddress::TENTATIVE_OPTIMISTIC;
+        }
+    }
+  return false;
+}
+
 void Icmpv6L4Protocol::DoDAD (Ipv6Address target, Ptr<Ipv6Interface> interface)
 {
   NS_LOG_FUNCTION (this << target << interface);
@@ -537,6 +610,12 @@ void Icmpv6L4Protocol::HandleNS (Ptr<Packet> packet, Ipv6Address const &src, Ipv
       flags = 1; /* O flag */
     }
 
+  if (m_optimisticDad && ifaddr.GetState () == Ipv6InterfaceAddress::TENTATIVE_OPTIMISTIC)
+    {
+      /* an optimistic address does not override the caches (RFC 4429, sec. 3.3) */
+      flags &= ~1;
+    }
+
   /* send a NA to src */
   Ptr<Ipv6L3Protocol> ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
 
@@ -1005,7 +1084,10 @@ void Icmpv6L4Protocol::SendRS (Ipv6Address src, Ipv6Address dst,  Address hardwa
   Icmpv6OptionLinkLayerAddress llOption (1, hardwareAddress);  /* we give our mac address in response */
 
   /* if the source is unspec, multicast the NA to all-nodes multicast */
-  if (src != Ipv6Address::GetAny ())
+  /* no SLLAO from an optimistic address either, it could override a valid
+   * cache entry of the router if the address is a duplicate (RFC 4429, sec. 3.2)
+   */
+  if (src != Ipv6Address::GetAny () && !IsOptimisticAddress (src))
     {
       p->AddHeader (llOption);
     }
@@ -1411,11 +1493,10 @@ void Icmpv6L4Protocol::FunctionDadTimeout (Ptr<Icmpv6L4Protocol> icmpv6, Ipv6Int
       NS_LOG_LOGIC ("DAD OK, interface in state PREFERRED");
 
       /* send an RS if our interface is not forwarding (router) and if address is a link-local ones
-       * (because we will send RS with it)
+       * (because we will send RS with it). With optimistic DAD, the RS was sent with the probe.
        */
-      Ptr<Ipv6> ipv6 = icmpv6->m_node->GetObject<Ipv6> ();
-
-      if (!ipv6->IsForwarding (ipv6->GetInterfaceForDevice (interface->GetDevice ())) && addr.IsLinkLocal ())
+      if (ifaddr.GetState () != Ipv6InterfaceAddress::TENTATIVE_OPTIMISTIC
+          && !interface->IsForwarding () && addr.IsLinkLocal ())
         {
           /* \todo Add random delays before sending RS
            * because all nodes start at the same time, there will be many of RS arround 1 second of simulation time
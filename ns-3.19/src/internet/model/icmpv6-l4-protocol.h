@@ -221,6 +221,20 @@ public:
    */
   void DoDAD (Ipv6Address target, Ptr<Ipv6Interface> interface);
 
+  /**
+   * \brief Start the Duplicate Address Detection of a new address.
+   *
+   * Without DAD, the address keeps its state and no probe is sent.
+   * Otherwise it stays TENTATIVE until the DAD timeout. With optimistic DAD (\RFC{4429}), it
+   * is TENTATIVE_OPTIMISTIC instead: the probe and, for the link-local
+   * address of a host, the Router Solicitation leave at once, without
+   * waiting for the DAD to complete.
+   *
+   * \param target the new address
+   * \param interface the interface of the address
+   */
+  void StartDad (Ipv6Address target, Ptr<Ipv6Interface> interface);
+
   /**
    * \brief Send a Neighbor Adverstisement.
    * \param src source IPv6 address
@@ -411,6 +425,12 @@ public:
    */
   bool IsAlwaysDad () const;
 
+  /**
+   * \brief Is the DAD optimistic (\RFC{4429}).
+   * \return true if the new addresses are used while the DAD runs.
+   */
+  bool IsOptimisticDad () const;
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -430,6 +450,21 @@ protected:
 private:
   typedef std::list<Ptr<NdiscCache> > CacheList; //!< container of NdiscCaches
 
+  /**
+   * \brief Send the first Router Solicitation of a host interface, from its
+   * link-local address.
+   * \param src the new address
+   * \param interface the interface of the address
+   */
+  void SolicitRouters (Ipv6Address src, Ipv6Interface* interface);
+
+  /**
+   * \brief Is the address one of our TENTATIVE_OPTIMISTIC addresses.
+   * \param address the address
+   * \return true if the address is optimistic
+   */
+  bool IsOptimisticAddress (Ipv6Address address) const;
+
   /**
    * \brief The node.
    */
@@ -445,6 +480,11 @@ private:
    */
   bool m_alwaysDad;
 
+  /**
+   * \brief Use the addresses while their DAD runs ?
+   */
+  bool m_optimisticDad;
+
   /**
    * \brief Random jitter before sending solicitations
    */
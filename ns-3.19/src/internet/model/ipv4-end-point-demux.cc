@@ -27,6 +27,30 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux")
   ;
 
+Ipv4EndPointDemux::Key::Key (Ipv4Address localAddress, uint16_t localPort,
+                             Ipv4Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    localPort (localPort),
+    peerAddress (peerAddress),
+    peerPort (peerPort)
+{
+}
+
+bool
+Ipv4EndPointDemux::Key::operator == (const Key &other) const
+{
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t
+Ipv4EndPointDemux::KeyHash::operator () (const Key &key) const
+{
+  Ipv4AddressHash hash;
+  return (hash (key.localAddress) * 31 + hash (key.peerAddress)) * 31
+         + ((key.localPort << 16) | key.peerPort);
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
   : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
 {
@@ -42,30 +66,31 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_tuples.clear ();
+  m_positions.clear ();
 }
 
 bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  // ports without end points are removed from the index
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  PortIndex::iterator p = m_ports.find (port);
+  if (p == m_ports.end ())
+    {
+      return false;
+    }
+  for (EndPointsI i = p->second.begin (); i != p->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr) 
+      if ((*i)->GetLocalAddress () == addr) 
         {
           return true;
         }
@@ -73,6 +98,53 @@ Ipv4EndPointDemux::LookupLocal (Ipv4Address addr, uint16_t port)
   return false;
 }
 
+Ipv4EndPointDemux::Key
+Ipv4EndPointDemux::GetKey (Ipv4EndPoint *endPoint)
+{
+  return Key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+              endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key = GetKey (endPoint);
+  EndPoints &port = m_ports[key.localPort];
+  EndPoints &tuple = m_tuples[key];
+  Position position = { key,
+                        m_endPoints.insert (m_endPoints.end (), endPoint),
+                        port.insert (port.end (), endPoint),
+                        tuple.insert (tuple.end (), endPoint) };
+  m_positions.insert (std::make_pair (endPoint, position));
+  endPoint->m_demux = this;
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void
+Ipv4EndPointDemux::Reindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::map<Ipv4EndPoint *, Position>::iterator i = m_positions.find (endPoint);
+  NS_ASSERT (i != m_positions.end ());
+  Position &position = i->second;
+  Key key = GetKey (endPoint);
+  if (key == position.key)
+    {
+      return;
+    }
+  TupleIndex::iterator t = m_tuples.find (position.key);
+  t->second.erase (position.tuple);
+  if (t->second.empty ())
+    {
+      m_tuples.erase (t);
+    }
+  EndPoints &tuple = m_tuples[key];
+  position.tuple = tuple.insert (tuple.end (), endPoint);
+  position.key = key;
+}
+
 Ipv4EndPoint *
 Ipv4EndPointDemux::Allocate (void)
 {
@@ -84,9 +156,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (endPoint);
 }
 
 Ipv4EndPoint *
@@ -100,9 +170,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (endPoint);
 }
 
 Ipv4EndPoint *
@@ -123,9 +191,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address, uint16_t port)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (endPoint);
 }
 
 Ipv4EndPoint *
@@ -133,40 +199,42 @@ Ipv4EndPointDemux::Allocate (Ipv4Address localAddress, uint16_t localPort,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (m_tuples.find (Key (localAddress, localPort, peerAddress, peerPort)) != m_tuples.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress) 
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void 
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::map<Ipv4EndPoint *, Position>::iterator i = m_positions.find (endPoint);
+  if (i == m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  Position &position = i->second;
+  m_endPoints.erase (position.endPoint);
+  PortIndex::iterator p = m_ports.find (position.key.localPort);
+  p->second.erase (position.port);
+  if (p->second.empty ())
+    {
+      m_ports.erase (p);
+    }
+  TupleIndex::iterator t = m_tuples.find (position.key);
+  t->second.erase (position.tuple);
+  if (t->second.empty ())
+    {
+      m_tuples.erase (t);
+    }
+  m_positions.erase (i);
+  delete endPoint;
 }
 
 /*
@@ -205,21 +273,53 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  bool subnetDirected = false;
+  Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
+          daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
+        {
+          subnetDirected = true;
+          incomingInterfaceAddr = addr.GetLocal ();
+        }
+    }
+  bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
+  NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
+
+  if (!isBroadcast)
+    {
+      // Endpoints matching all 4 fields are found in the four-tuple index
+      TupleIndex::iterator t = m_tuples.find (Key (daddr, dport, saddr, sport));
+      if (t != m_tuples.end ())
+        {
+          for (EndPointsI i = t->second.begin (); i != t->second.end (); i++)
+            {
+              Ipv4EndPoint* endP = *i;
+              if (endP->GetBoundNetDevice () == 0
+                  || endP->GetBoundNetDevice () == incomingInterface->GetDevice ())
+                {
+                  retval4.push_back (endP);
+                }
+            }
+          if (!retval4.empty ()) return retval4;
+        }
+    }
+
+  PortIndex::iterator p = m_ports.find (dport);
+  if (p == m_ports.end ())
+    {
+      NS_LOG_LOGIC ("No endpoint for packet dport " << dport);
+      return retval1;
+    }
+  for (EndPointsI i = p->second.begin (); i != p->second.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
                                                  << " sport=" << endP->GetPeerPort ()
                                                  << " saddr=" << endP->GetPeerAddress ());
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -231,20 +331,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
               continue;
             }
         }
-      bool subnetDirected = false;
-      Ipv4Address incomingInterfaceAddr = daddr;  // may be a broadcast
-      for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-        {
-          Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-          if (addr.GetLocal ().CombineMask (addr.GetMask ()) == daddr.CombineMask (addr.GetMask ()) &&
-              daddr.IsSubnetDirectedBroadcast (addr.GetMask ()))
-            {
-              subnetDirected = true;
-              incomingInterfaceAddr = addr.GetLocal ();
-            }
-        }
-      bool isBroadcast = (daddr.IsBroadcast () || subnetDirected == true);
-      NS_LOG_DEBUG ("dest addr " << daddr << " broadcast? " << isBroadcast);
       bool localAddressMatchesWildCard = 
         endP->GetLocalAddress () == Ipv4Address::GetAny ();
       bool localAddressMatchesExact = endP->GetLocalAddress () == daddr;
@@ -318,21 +404,21 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
+  TupleIndex::iterator t = m_tuples.find (Key (daddr, dport, saddr, sport));
+  if (t != m_tuples.end ())
+    {
+      /* this is an exact match. */
+      return t->second.front ();
+    }
+  PortIndex::iterator p = m_ports.find (dport);
+  if (p == m_ports.end ())
+    {
+      return 0;
+    }
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (EndPointsI i = p->second.begin (); i != p->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
-      if ((*i)->GetLocalAddress () == daddr &&
-          (*i)->GetPeerPort () == sport &&
-          (*i)->GetPeerAddress () == saddr) 
-        {
-          /* this is an exact match. */
-          return *i;
-        }
       uint32_t tmp = 0;
       if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
         {
@@ -23,7 +23,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/ipv4-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv4-interface.h"
 
 namespace ns3 {
@@ -38,6 +40,12 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by local port and by their full four-tuple,
+ * so that a lookup only looks at the endpoints bound to the destination
+ * port, and a packet of an established connection is matched with a single
+ * hash lookup.  Endpoints notify the demux when their addresses change, to
+ * keep the four-tuple index up to date.
  */
 
 class Ipv4EndPointDemux {
@@ -152,6 +160,90 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief The four-tuple of an end point.
+   */
+  struct Key
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    Key (Ipv4Address localAddress, uint16_t localPort,
+         Ipv4Address peerAddress, uint16_t peerPort);
+    /**
+     * \brief Compare two four-tuples.
+     * \param other the other four-tuple
+     * \return true if all the four fields are equal
+     */
+    bool operator == (const Key &other) const;
+
+    Ipv4Address localAddress; //!< local address
+    uint16_t localPort;       //!< local port
+    Ipv4Address peerAddress;  //!< peer address
+    uint16_t peerPort;        //!< peer port
+  };
+
+  /**
+   * \brief Hash function class for four-tuples.
+   */
+  struct KeyHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param key the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator () (const Key &key) const;
+  };
+
+  /**
+   * \brief Where an end point is stored in the lists of the demux.
+   */
+  struct Position
+  {
+    Key key;               //!< the four-tuple the end point is indexed by
+    EndPointsI endPoint;   //!< position in m_endPoints
+    EndPointsI port;       //!< position in its m_ports list
+    EndPointsI tuple;      //!< position in its m_tuples list
+  };
+
+  /**
+   * \brief End points indexed by local port.
+   */
+  typedef sgi::hash_map<uint16_t, EndPoints> PortIndex;
+
+  /**
+   * \brief End points indexed by four-tuple.
+   */
+  typedef sgi::hash_map<Key, EndPoints, KeyHash> TupleIndex;
+
+  /**
+   * \brief Get the four-tuple of an end point.
+   * \param endPoint the end point
+   * \return the four-tuple of the end point
+   */
+  static Key GetKey (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add a newly allocated end point to the demux.
+   * \param endPoint the end point
+   * \return the end point
+   */
+  Ipv4EndPoint *Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Move an end point to the index entry of its current four-tuple.
+   *
+   * Called by the end point when its local address or its peer changes.
+   * \param endPoint the end point
+   */
+  void Reindex (Ipv4EndPoint *endPoint);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -178,6 +270,21 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by local port, in allocation order.
+   */
+  PortIndex m_ports;
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  TupleIndex m_tuples;
+
+  /**
+   * \brief The position of each end point in the lists above.
+   */
+  std::map<Ipv4EndPoint *, Position> m_positions;
 };
 
 } // namespace ns3
@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \brief A representation of an internet endpoint/connection
@@ -229,6 +230,13 @@ private:
    * \brief The destroy callback.
    */
   Callback<void> m_destroyCallback;
+
+  friend class Ipv4EndPointDemux;
+
+  /**
+   * \brief The demux the EndPoint is allocated by (if any).
+   */
+  Ipv4EndPointDemux *m_demux;
 };
 
 } // namespace ns3
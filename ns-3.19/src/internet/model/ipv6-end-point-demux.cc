@@ -27,6 +27,28 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux")
   ;
 
+Ipv6EndPointDemux::Key::Key (Ipv6Address localAddress, uint16_t localPort,
+                             Ipv6Address peerAddress, uint16_t peerPort)
+  : localAddress (localAddress),
+    localPort (localPort),
+    peerAddress (peerAddress),
+    peerPort (peerPort)
+{
+}
+
+bool Ipv6EndPointDemux::Key::operator == (const Key &other) const
+{
+  return localPort == other.localPort && peerPort == other.peerPort
+         && localAddress == other.localAddress && peerAddress == other.peerAddress;
+}
+
+size_t Ipv6EndPointDemux::KeyHash::operator () (const Key &key) const
+{
+  Ipv6AddressHash hash;
+  return (hash (key.localAddress) * 31 + hash (key.peerAddress)) * 31
+         + ((key.localPort << 16) | key.peerPort);
+}
+
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
@@ -44,14 +66,29 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_tuples.clear ();
+  m_positions.clear ();
 }
 
 bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  /* ports without end points are removed from the index */
+  return m_ports.find (port) != m_ports.end ();
+}
+
+bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
+{
+  NS_LOG_FUNCTION (this << addr << port);
+  PortIndex::iterator p = m_ports.find (port);
+  if (p == m_ports.end ())
+    {
+      return false;
+    }
+  for (EndPointsI i = p->second.begin (); i != p->second.end (); i++)
     {
-      if ((*i)->GetLocalPort  () == port)
+      if ((*i)->GetLocalAddress () == addr)
         {
           return true;
         }
@@ -59,18 +96,59 @@ bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
   return false;
 }
 
-bool Ipv6EndPointDemux::LookupLocal (Ipv6Address addr, uint16_t port)
+Ipv6EndPointDemux::Key Ipv6EndPointDemux::GetKey (Ipv6EndPoint *endPoint)
 {
-  NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  return Key (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+              endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+}
+
+Ipv6EndPoint* Ipv6EndPointDemux::Insert (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  Key key = GetKey (endPoint);
+  EndPoints &port = m_ports[key.localPort];
+  EndPoints &tuple = m_tuples[key];
+  Position position = { key,
+                        m_endPoints.insert (m_endPoints.end (), endPoint),
+                        port.insert (port.end (), endPoint),
+                        tuple.insert (tuple.end (), endPoint) };
+  m_positions.insert (std::make_pair (endPoint, position));
+  endPoint->m_demux = this;
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  return endPoint;
+}
+
+void Ipv6EndPointDemux::Reindex (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::map<Ipv6EndPoint *, Position>::iterator i = m_positions.find (endPoint);
+  NS_ASSERT (i != m_positions.end ());
+  Position &position = i->second;
+  Key key = GetKey (endPoint);
+  if (key == position.key)
     {
-      if ((*i)->GetLocalPort () == port
-          && (*i)->GetLocalAddress () == addr)
+      return;
+    }
+  if (key.localPort != position.key.localPort)
+    {
+      PortIndex::iterator p = m_ports.find (position.key.localPort);
+      p->second.erase (position.port);
+      if (p->second.empty ())
         {
-          return true;
+          m_ports.erase (p);
         }
+      EndPoints &port = m_ports[key.localPort];
+      position.port = port.insert (port.end (), endPoint);
     }
-  return false;
+  TupleIndex::iterator t = m_tuples.find (position.key);
+  t->second.erase (position.tuple);
+  if (t->second.empty ())
+    {
+      m_tuples.erase (t);
+    }
+  EndPoints &tuple = m_tuples[key];
+  position.tuple = tuple.insert (tuple.end (), endPoint);
+  position.key = key;
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
@@ -83,9 +161,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (endPoint);
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
@@ -98,9 +174,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (endPoint);
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (uint16_t port)
@@ -119,48 +193,48 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address, uint16_t port)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-  return endPoint;
+  return Insert (endPoint);
 }
 
 Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address localAddress, uint16_t localPort,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (m_tuples.find (Key (localAddress, localPort, peerAddress, peerPort)) != m_tuples.end ())
     {
-      if ((*i)->GetLocalPort () == localPort
-          && (*i)->GetLocalAddress () == localAddress
-          && (*i)->GetPeerPort () == peerPort
-          && (*i)->GetPeerAddress () == peerAddress)
-        {
-          NS_LOG_WARN ("No way we can allocate this end-point.");
-          /* no way we can allocate this end-point. */
-          return 0;
-        }
+      NS_LOG_WARN ("No way we can allocate this end-point.");
+      /* no way we can allocate this end-point. */
+      return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
-  return endPoint;
+  return Insert (endPoint);
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::map<Ipv6EndPoint *, Position>::iterator i = m_positions.find (endPoint);
+  if (i == m_positions.end ())
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
+    }
+  Position &position = i->second;
+  m_endPoints.erase (position.endPoint);
+  PortIndex::iterator p = m_ports.find (position.key.localPort);
+  p->second.erase (position.port);
+  if (p->second.empty ())
+    {
+      m_ports.erase (p);
     }
+  TupleIndex::iterator t = m_tuples.find (position.key);
+  t->second.erase (position.tuple);
+  if (t->second.empty ())
+    {
+      m_tuples.erase (t);
+    }
+  m_positions.erase (i);
+  delete endPoint;
 }
 
 /*
@@ -180,21 +254,39 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+
+  /* Endpoints matching all 4 fields are found in the four-tuple index */
+  TupleIndex::iterator t = m_tuples.find (Key (daddr, dport, saddr, sport));
+  if (t != m_tuples.end ())
+    {
+      for (EndPointsI i = t->second.begin (); i != t->second.end (); i++)
+        {
+          Ipv6EndPoint* endP = *i;
+          if (endP->GetBoundNetDevice () == 0
+              || endP->GetBoundNetDevice () == incomingInterface->GetDevice ())
+            {
+              retval4.push_back (endP);
+            }
+        }
+      if (!retval4.empty ())
+        {
+          return retval4;
+        }
+    }
+
+  PortIndex::iterator p = m_ports.find (dport);
+  if (p == m_ports.end ())
+    {
+      NS_LOG_LOGIC ("No endpoint for packet dport " << dport);
+      return retval1;
+    }
+  for (EndPointsI i = p->second.begin (); i != p->second.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
       NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
                                                  << " daddr=" << endP->GetLocalAddress ()
                                                  << " sport=" << endP->GetPeerPort ()
                                                  << " saddr=" << endP->GetPeerAddress ());
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
 
       if (endP->GetBoundNetDevice ())
         {
@@ -281,25 +373,25 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  TupleIndex::iterator t = m_tuples.find (Key (dst, dport, src, sport));
+  if (t != m_tuples.end ())
+    {
+      /* this is an exact match. */
+      return t->second.front ();
+    }
+  PortIndex::iterator p = m_ports.find (dport);
+  if (p == m_ports.end ())
+    {
+      return 0;
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointsI i = p->second.begin (); i != p->second.end (); i++)
     {
       uint32_t tmp = 0;
 
-      if ((*i)->GetLocalPort () != dport)
-        {
-          continue;
-        }
-
-      if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
-          && (*i)->GetPeerAddress () == src)
-        {
-          /* this is an exact match. */
-          return *i;
-        }
-
       if ((*i)->GetLocalAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
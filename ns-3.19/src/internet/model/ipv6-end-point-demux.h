@@ -23,7 +23,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include "ns3/ipv6-address.h"
+#include "ns3/sgi-hashmap.h"
 #include "ipv6-interface.h"
 
 namespace ns3 {
@@ -33,6 +35,9 @@ class Ipv6EndPoint;
 /**
  * \class Ipv6EndPointDemux
  * \brief Demultiplexor for end points.
+ *
+ * End points are indexed by local port and by four-tuple, and notify the
+ * demux when their addresses or ports change.
  */
 class Ipv6EndPointDemux
 {
@@ -137,6 +142,92 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief The four-tuple of an end point.
+   */
+  struct Key
+  {
+    /**
+     * \brief Constructor.
+     * \param localAddress local address
+     * \param localPort local port
+     * \param peerAddress peer address
+     * \param peerPort peer port
+     */
+    Key (Ipv6Address localAddress, uint16_t localPort,
+         Ipv6Address peerAddress, uint16_t peerPort);
+    /**
+     * \brief Compare two four-tuples.
+     * \param other the other four-tuple
+     * \return true if all the four fields are equal
+     */
+    bool operator == (const Key &other) const;
+
+    Ipv6Address localAddress; //!< local address
+    uint16_t localPort;       //!< local port
+    Ipv6Address peerAddress;  //!< peer address
+    uint16_t peerPort;        //!< peer port
+  };
+
+  /**
+   * \brief Hash function class for four-tuples.
+   */
+  struct KeyHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param key the four-tuple
+     * \return the hash of the four-tuple
+     */
+    size_t operator () (const Key &key) const;
+  };
+
+  /**
+   * \brief Where an end point is stored in the lists of the demux.
+   */
+  struct Position
+  {
+    Key key;               //!< the four-tuple the end point is indexed by
+    EndPointsI endPoint;   //!< position in m_endPoints
+    EndPointsI port;       //!< position in its m_ports list
+    EndPointsI tuple;      //!< position in its m_tuples list
+  };
+
+  /**
+   * \brief End points indexed by local port.
+   */
+  typedef sgi::hash_map<uint16_t, EndPoints> PortIndex;
+
+  /**
+   * \brief End points indexed by four-tuple.
+   */
+  typedef sgi::hash_map<Key, EndPoints, KeyHash> TupleIndex;
+
+  /**
+   * \brief Get the four-tuple of an end point.
+   * \param endPoint the end point
+   * \return the four-tuple of the end point
+   */
+  static Key GetKey (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Add a newly allocated end point to the demux.
+   * \param endPoint the end point
+   * \return the end point
+   */
+  Ipv6EndPoint *Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Move an end point to the index entry of its current four-tuple.
+   *
+   * Called by the end point when its local address, its local port or its
+   * peer changes.
+   * \param endPoint the end point
+   */
+  void Reindex (Ipv6EndPoint *endPoint);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -162,6 +253,21 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by local port, in allocation order.
+   */
+  PortIndex m_ports;
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  TupleIndex m_tuples;
+
+  /**
+   * \brief The position of each end point in the lists above.
+   */
+  std::map<Ipv6EndPoint *, Position> m_positions;
 };
 
 } /* namespace ns3 */
@@ -34,6 +34,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \brief A representation of an internet IPv6 endpoint/connection
@@ -237,6 +238,13 @@ private:
    * \brief The destroy callback.
    */
   Callback<void> m_destroyCallback;
+
+  friend class Ipv6EndPointDemux;
+
+  /**
+   * \brief The demux the EndPoint is allocated by (if any).
+   */
+  Ipv6EndPointDemux *m_demux;
 };
 
 } /* namespace ns3 */
@@ -297,11 +297,24 @@ TypeId Ipv6ExtensionFragment::GetTypeId ()
   static TypeId tid = TypeId ("ns3::Ipv6ExtensionFragment")
     .SetParent<Ipv6Extension> ()
     .AddConstructor<Ipv6ExtensionFragment> ()
+    .AddAttribute ("MaxReassemblyBytes",
+                   "The maximum number of bytes held by the packets being reassembled, beyond which the oldest are dropped.",
+                   UintegerValue (4194304),
+                   MakeUintegerAccessor (&Ipv6ExtensionFragment::m_maxReassemblyBytes),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
+size_t Ipv6ExtensionFragment::FragmentsIdHash::operator () (const std::pair<Ipv6Address, uint32_t> &key) const
+{
+  Ipv6AddressHash hash;
+  return hash (key.first) * 31 + key.second;
+}
+
 Ipv6ExtensionFragment::Ipv6ExtensionFragment ()
+  : m_reassemblyBytes (0),
+    m_maxReassemblyBytes (4194304)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -317,10 +330,13 @@ void Ipv6ExtensionFragment::DoDispose ()
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
+      it->second->CancelTimeout ();
       it->second = 0;
     }
 
   m_fragments.clear ();
+  m_fragmentsAge.clear ();
+  m_reassemblyBytes = 0;
   Ipv6Extension::DoDispose ();
 }
 
@@ -362,6 +378,7 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet, uint8_t offset, Ipv
     {
       fragments = Create<Fragments> ();
       m_fragments.insert (std::make_pair (fragmentsId, fragments));
+      fragments->m_age = m_fragmentsAge.insert (m_fragmentsAge.end (), fragmentsId);
       EventId timeout = Simulator::Schedule (Seconds (60),
                                              &Ipv6ExtensionFragment::HandleFragmentsTimeout, this,
                                              fragmentsId, ipHeader);
@@ -372,31 +389,67 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet, uint8_t offset, Ipv
       fragments = it->second;
     }
 
+  uint32_t oldSize = fragments->GetSize ();
+  if (!fragments->AddFragment (p, fragmentOffset, moreFragment))
+    {
+      // overlapping fragments, the whole packet must be silently discarded (RFC 5722)
+      NS_LOG_LOGIC ("Overlapping fragment, dropping the packet " << identification << " from " << src);
+      m_dropTrace (packet);
+      RemoveFragments (fragmentsId);
+      isDropped = true;
+      return 0;
+    }
+
   if (fragmentOffset == 0)
     {
       Ptr<Packet> unfragmentablePart = packet->Copy ();
       unfragmentablePart->RemoveAtEnd (packet->GetSize () - offset);
       fragments->SetUnfragmentablePart (unfragmentablePart);
     }
-
-  fragments->AddFragment (p, fragmentOffset, moreFragment);
+  m_reassemblyBytes += fragments->GetSize () - oldSize;
 
   if (fragments->IsEntire ())
     {
       packet = fragments->GetPacket ();
-      fragments->CancelTimeout ();
-      m_fragments.erase (fragmentsId);
+      RemoveFragments (fragmentsId);
       isDropped = false;
+      return 0;
     }
-  else
+
+  // the fragment is not "dropped", but Ipv6L3Protocol::LocalDeliver must stop processing it.
+  isDropped = true;
+
+  // make room by giving up the oldest packets
+  while (m_reassemblyBytes > m_maxReassemblyBytes)
     {
-      // the fragment is not "dropped", but Ipv6L3Protocol::LocalDeliver must stop processing it.
-      isDropped = true;
+      std::pair<Ipv6Address, uint32_t> oldest = m_fragmentsAge.front ();
+      NS_LOG_LOGIC ("Reassembly memory full, dropping the packet " << oldest.second << " from " << oldest.first);
+      Ptr<Packet> partial = m_fragments[oldest]->GetPartialPacket ();
+      if (partial)
+        {
+          m_dropTrace (partial);
+        }
+      RemoveFragments (oldest);
     }
 
   return 0;
 }
 
+uint32_t Ipv6ExtensionFragment::GetReassemblyBytes () const
+{
+  return m_reassemblyBytes;
+}
+
+void Ipv6ExtensionFragment::RemoveFragments (std::pair<Ipv6Address, uint32_t> fragmentsId)
+{
+  MapFragments_t::iterator it = m_fragments.find (fragmentsId);
+  NS_ASSERT (it != m_fragments.end ());
+  it->second->CancelTimeout ();
+  m_reassemblyBytes -= it->second->GetSize ();
+  m_fragmentsAge.erase (it->second->m_age);
+  m_fragments.erase (it);
+}
+
 void Ipv6ExtensionFragment::GetFragments (Ptr<Packet> packet, uint32_t maxFragmentSize, std::list<Ptr<Packet> >& listFragments)
 {
   Ptr<Packet> p = packet->Copy ();
@@ -557,8 +610,6 @@ void Ipv6ExtensionFragment::GetFragments (Ptr<Packet> packet, uint32_t maxFragme
       ipv6Header.SetPayloadLength (fragment->GetSize ());
       fragment->AddHeader (ipv6Header);
 
-      std::ostringstream oss;
-      fragment->Print (oss);
       listFragments.push_back (fragment);
     }
   while (moreFragment);
@@ -583,22 +634,28 @@ void Ipv6ExtensionFragment::HandleFragmentsTimeout (std::pair<Ipv6Address, uint3
 
   Ptr<Packet> packet = fragments->GetPartialPacket ();
 
-  packet->AddHeader (ipHeader);
-
-  // if we have at least 8 bytes, we can send an ICMP.
-  if ( packet->GetSize () > 8 )
+  // without the first fragment, there is nothing to send back (RFC 2460 sec.4.5)
+  if (packet)
     {
-      Ptr<Icmpv6L4Protocol> icmp = GetNode ()->GetObject<Icmpv6L4Protocol> ();
-      icmp->SendErrorTimeExceeded (packet, ipHeader.GetSourceAddress (), Icmpv6Header::ICMPV6_FRAGTIME);
+      packet->AddHeader (ipHeader);
+
+      // if we have at least 8 bytes, we can send an ICMP.
+      if ( packet->GetSize () > 8 )
+        {
+          Ptr<Icmpv6L4Protocol> icmp = GetNode ()->GetObject<Icmpv6L4Protocol> ();
+          icmp->SendErrorTimeExceeded (packet, ipHeader.GetSourceAddress (), Icmpv6Header::ICMPV6_FRAGTIME);
+        }
+      m_dropTrace (packet);
     }
-  m_dropTrace (packet);
 
   // clear the buffers
-  m_fragments.erase (fragmentsId);
+  RemoveFragments (fragmentsId);
 }
 
 Ipv6ExtensionFragment::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_lastFragment (false),
+    m_end (0),
+    m_size (0)
 {
 }
 
@@ -606,24 +663,60 @@ Ipv6ExtensionFragment::Fragments::~Fragments ()
 {
 }
 
-void Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
+bool Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
 {
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
+  uint32_t fragmentEnd = fragmentOffset + fragment->GetSize ();
 
-  for (it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  // the fragment must end where the packet ends, or before it
+  if (!moreFragment)
     {
-      if (it->second > fragmentOffset)
+      if ((m_lastFragment && fragmentEnd != m_end)
+          || (!m_packetFragments.empty () && fragmentEnd < m_packetFragments.rbegin ()->first + m_packetFragments.rbegin ()->second->GetSize ()))
         {
-          break;
+          return false;
+        }
+    }
+  else if (m_lastFragment && fragmentEnd > m_end)
+    {
+      return false;
+    }
+
+  std::map<uint16_t, Ptr<Packet> >::iterator next = m_packetFragments.lower_bound (fragmentOffset);
+  if (next != m_packetFragments.end () && next->first == fragmentOffset
+      && next->second->GetSize () == fragment->GetSize ())
+    {
+      // a duplicate of a fragment already received
+      if (!moreFragment)
+        {
+          m_lastFragment = true;
+          m_end = fragmentEnd;
         }
+      return true;
     }
 
-  if (it == m_packetFragments.end ())
+  // the fragment must not overlap its neighbours
+  if (next != m_packetFragments.end () && next->first < fragmentEnd)
     {
-      m_moreFragment = moreFragment;
+      return false;
+    }
+  if (next != m_packetFragments.begin ())
+    {
+      std::map<uint16_t, Ptr<Packet> >::iterator previous = next;
+      previous--;
+      if (previous->first + previous->second->GetSize () > fragmentOffset)
+        {
+          return false;
+        }
     }
 
-  m_packetFragments.insert (it, std::pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
+  m_packetFragments.insert (next, std::make_pair (fragmentOffset, fragment));
+  m_size += fragment->GetSize ();
+  if (!moreFragment)
+    {
+      m_lastFragment = true;
+      m_end = fragmentEnd;
+    }
+  return true;
 }
 
 void Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart (Ptr<Packet> unfragmentablePart)
@@ -633,34 +726,22 @@ void Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart (Ptr<Packet> unfrag
 
 bool Ipv6ExtensionFragment::Fragments::IsEntire () const
 {
-  bool ret = !m_moreFragment && m_packetFragments.size () > 0;
-
-  if (ret)
-    {
-      uint16_t lastEndOffset = 0;
-
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
-        {
-          if (lastEndOffset != it->second)
-            {
-              ret = false;
-              break;
-            }
-
-          lastEndOffset += it->first->GetSize ();
-        }
-    }
+  // the fragments do not overlap and end before m_end: they cover the packet if their sizes add up to it
+  return m_lastFragment && m_size == m_end && m_unfragmentable != 0;
+}
 
-  return ret;
+uint32_t Ipv6ExtensionFragment::Fragments::GetSize () const
+{
+  return m_size + (m_unfragmentable ? m_unfragmentable->GetSize () : 0);
 }
 
 Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPacket () const
 {
   Ptr<Packet> p =  m_unfragmentable->Copy ();
 
-  for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  for (std::map<uint16_t, Ptr<Packet> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
-      p->AddAtEnd (it->first);
+      p->AddAtEnd (it->second);
     }
 
   return p;
@@ -681,14 +762,14 @@ Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPartialPacket () const
 
   uint16_t lastEndOffset = 0;
 
-  for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  for (std::map<uint16_t, Ptr<Packet> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
-      if (lastEndOffset != it->second)
+      if (lastEndOffset != it->first)
         {
           break;
         }
-      p->AddAtEnd (it->first);
-      lastEndOffset += it->first->GetSize ();
+      p->AddAtEnd (it->second);
+      lastEndOffset += it->second->GetSize ();
     }
 
   return p;
@@ -34,6 +34,7 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/sgi-hashmap.h"
 
 
 namespace ns3 {
@@ -237,6 +238,13 @@ public:
 /**
  * \class Ipv6ExtensionFragment
  * \brief IPv6 Extension Fragment
+ *
+ * The packets being reassembled are found by a hash of their source
+ * address and identification, and their fragments are kept sorted by
+ * offset. A fragment overlapping another one discards the whole packet
+ * (RFC 5722). The fragments held by all the reassemblies are bounded by
+ * the MaxReassemblyBytes attribute: above it, the oldest reassemblies are
+ * given up without waiting for their timeout.
  */
 class Ipv6ExtensionFragment : public Ipv6Extension
 {
@@ -289,6 +297,12 @@ public:
    */
   void GetFragments (Ptr<Packet> packet, uint32_t fragmentSize, std::list<Ptr<Packet> >& listFragments);
 
+  /**
+   * \brief Get the number of bytes held by the packets being reassembled.
+   * \return the number of bytes
+   */
+  uint32_t GetReassemblyBytes () const;
+
 protected:
   /**
    * \brief Dispose this object.
@@ -315,11 +329,14 @@ public:
 
     /**
      * \brief Add a fragment.
+     *
+     * A copy of a fragment already received is ignored.
      * \param fragment the fragment
      * \param fragmentOffset the offset of the fragment
      * \param moreFragment the bit "More Fragment"
+     * \returns false if the fragment overlaps the others or goes past the end of the packet
      */
-    void AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment);
+    bool AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment);
 
     /**
      * \brief Set the unfragmentable part of the packet.
@@ -333,6 +350,12 @@ public:
      */
     bool IsEntire () const;
 
+    /**
+     * \brief Get the number of bytes held.
+     * \returns the size of the fragments and of the unfragmentable part
+     */
+    uint32_t GetSize () const;
+
     /**
      * \brief Get the entire packet.
      * \return the entire packet
@@ -355,16 +378,31 @@ public:
      */
     void CancelTimeout ();
 
+    /**
+     * \brief Position of the packet in the list of reassemblies by age.
+     */
+    std::list<std::pair<Ipv6Address, uint32_t> >::iterator m_age;
+
 private:
     /**
-     * \brief If other fragments will be sent.
+     * \brief If the last fragment, without the "More Fragment" bit, has been received.
      */
-    bool m_moreFragment;
+    bool m_lastFragment;
 
     /**
-     * \brief The current fragments.
+     * \brief The end of the packet, known once the last fragment is received.
      */
-    std::list<std::pair<Ptr<Packet>, uint16_t> > m_packetFragments;
+    uint32_t m_end;
+
+    /**
+     * \brief The number of bytes in the current fragments.
+     */
+    uint32_t m_size;
+
+    /**
+     * \brief The current fragments, by offset.
+     */
+    std::map<uint16_t, Ptr<Packet> > m_packetFragments;
 
     /**
      * \brief The unfragmentable part.
@@ -384,6 +422,12 @@ private:
    */
   void HandleFragmentsTimeout (std::pair<Ipv6Address, uint32_t> key, Ipv6Header & ipHeader);
 
+  /**
+   * \brief Forget a packet being reassembled and its fragments.
+   * \param key representing the packet fragments
+   */
+  void RemoveFragments (std::pair<Ipv6Address, uint32_t> key);
+
   /**
    * \brief Get the packet parts so far received.
    * \return the partial packet
@@ -400,15 +444,43 @@ private:
    */
   void CancelTimeout ();
 
+  /**
+   * \brief Hash function class for the packet fragments keys.
+   */
+  struct FragmentsIdHash
+  {
+    /**
+     * \brief Hash a source address and identification.
+     * \param key the key
+     * \return the hash of the key
+     */
+    size_t operator () (const std::pair<Ipv6Address, uint32_t> &key) const;
+  };
+
   /**
    * \brief Container for the packet fragments.
    */
-  typedef std::map<std::pair<Ipv6Address, uint32_t>, Ptr<Fragments> > MapFragments_t;
+  typedef sgi::hash_map<std::pair<Ipv6Address, uint32_t>, Ptr<Fragments>, FragmentsIdHash> MapFragments_t;
 
   /**
    * \brief The hash of fragmented packets.
    */
   MapFragments_t m_fragments;
+
+  /**
+   * \brief The keys of the fragmented packets, oldest first.
+   */
+  std::list<std::pair<Ipv6Address, uint32_t> > m_fragmentsAge;
+
+  /**
+   * \brief The number of bytes held by the fragmented packets.
+   */
+  uint32_t m_reassemblyBytes;
+
+  /**
+   * \brief The maximum number of bytes held by the fragmented packets.
+   */
+  uint32_t m_maxReassemblyBytes;
 };
 
 /**
@@ -0,0 +1,505 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <queue>
+#include <functional>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-list-routing.h"
+#include "ipv6-global-routing.h"
+#include "ipv6-global-route-manager-impl.h"
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6GlobalRouteManagerImpl");
+
+namespace ns3 {
+
+Ipv6GlobalRouteManagerImpl::Ipv6GlobalRouteManagerImpl ()
+  : m_initialized (false),
+    m_spfRuns (0),
+    m_routeUpdates (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv6GlobalRouteManagerImpl::~Ipv6GlobalRouteManagerImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteGlobalRoutes ();
+}
+
+uint32_t
+Ipv6GlobalRouteManagerImpl::GetNSpfRuns (void) const
+{
+  return m_spfRuns;
+}
+
+uint32_t
+Ipv6GlobalRouteManagerImpl::GetNRouteUpdates (void) const
+{
+  return m_routeUpdates;
+}
+
+Ptr<Ipv6GlobalRouting>
+Ipv6GlobalRouteManagerImpl::GetGlobalRouting (Ptr<Ipv6> ipv6)
+{
+  Ptr<Ipv6RoutingProtocol> protocol = ipv6->GetRoutingProtocol ();
+  Ptr<Ipv6GlobalRouting> routing = DynamicCast<Ipv6GlobalRouting> (protocol);
+  if (routing)
+    {
+      return routing;
+    }
+  Ptr<Ipv6ListRouting> list = DynamicCast<Ipv6ListRouting> (protocol);
+  if (list)
+    {
+      int16_t priority;
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); i++)
+        {
+          routing = DynamicCast<Ipv6GlobalRouting> (list->GetRoutingProtocol (i, priority));
+          if (routing)
+            {
+              return routing;
+            }
+        }
+    }
+  return 0;
+}
+
+void
+Ipv6GlobalRouteManagerImpl::DeleteGlobalRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Router>::iterator it = m_routers.begin (); it != m_routers.end (); ++it)
+    {
+      it->routing->ClearRoutes ();
+      it->routing->m_populated = false;
+    }
+  m_routers.clear ();
+  m_links.clear ();
+  m_attachments.clear ();
+  m_routerIndex.clear ();
+  m_linkIndex.clear ();
+  m_changed.clear ();
+  m_update.Cancel ();
+  m_initialized = false;
+}
+
+void
+Ipv6GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteGlobalRoutes ();
+
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<Ipv6> ipv6 = (*i)->GetObject<Ipv6> ();
+      if (ipv6 == 0)
+        {
+          continue;
+        }
+      Ptr<Ipv6GlobalRouting> routing = GetGlobalRouting (ipv6);
+      if (routing == 0)
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("Node " << (*i)->GetId () << " is router " << m_routers.size ());
+      m_routerIndex[(*i)->GetId ()] = m_routers.size ();
+      Router router;
+      router.ipv6 = ipv6;
+      router.routing = routing;
+      m_routers.push_back (router);
+    }
+
+  for (uint32_t r = 0; r < m_routers.size (); r++)
+    {
+      std::vector<Attachment> attachments;
+      ScanInterfaces (r, true, attachments);
+      for (std::vector<Attachment>::const_iterator it = attachments.begin (); it != attachments.end (); ++it)
+        {
+          AddAttachment (*it);
+        }
+    }
+  NS_LOG_LOGIC (m_routers.size () << " routers, " << m_links.size () << " links, "
+                                  << m_attachments.size () << " attachments");
+}
+
+bool
+Ipv6GlobalRouteManagerImpl::ScanInterfaces (uint32_t router, bool createLinks, std::vector<Attachment> &attachments)
+{
+  NS_LOG_FUNCTION (this << router << createLinks);
+  Ptr<Ipv6> ipv6 = m_routers[router].ipv6;
+  for (uint32_t i = 0; i < ipv6->GetNInterfaces (); i++)
+    {
+      if (!ipv6->IsUp (i))
+        {
+          continue;
+        }
+      Ptr<Channel> channel = ipv6->GetNetDevice (i)->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+
+      Attachment attachment;
+      attachment.router = router;
+      attachment.interface = i;
+      attachment.metric = ipv6->GetMetric (i);
+      attachment.forwarding = ipv6->IsForwarding (i);
+      attachment.active = true;
+      for (uint32_t j = 0; j < ipv6->GetNAddresses (i); j++)
+        {
+          Ipv6InterfaceAddress address = ipv6->GetAddress (i, j);
+          if (address.GetScope () == Ipv6InterfaceAddress::LINKLOCAL && attachment.address.IsAny ())
+            {
+              attachment.address = address.GetAddress ();
+            }
+          else if (address.GetScope () == Ipv6InterfaceAddress::GLOBAL)
+            {
+              attachment.prefixes.push_back (std::make_pair (address.GetAddress ().CombinePrefix (address.GetPrefix ()),
+                                                             address.GetPrefix ()));
+            }
+        }
+      if (attachment.address.IsAny ())
+        {
+          // Not usable as a next hop
+          continue;
+        }
+
+      std::map<uint32_t, uint32_t>::const_iterator it = m_linkIndex.find (channel->GetId ());
+      if (it != m_linkIndex.end ())
+        {
+          attachment.link = it->second;
+        }
+      else if (createLinks)
+        {
+          attachment.link = m_links.size ();
+          m_linkIndex[channel->GetId ()] = attachment.link;
+          m_links.push_back (Link ());
+        }
+      else
+        {
+          NS_LOG_LOGIC ("New channel " << channel->GetId ());
+          return false;
+        }
+      attachments.push_back (attachment);
+    }
+  return true;
+}
+
+uint32_t
+Ipv6GlobalRouteManagerImpl::AddAttachment (const Attachment &attachment)
+{
+  Router &router = m_routers[attachment.router];
+  for (std::vector<uint32_t>::const_iterator it = router.attachments.begin (); it != router.attachments.end (); ++it)
+    {
+      Attachment &old = m_attachments[*it];
+      if (!old.active && old.link == attachment.link)
+        {
+          old = attachment;
+          return *it;
+        }
+    }
+  uint32_t index = m_attachments.size ();
+  m_attachments.push_back (attachment);
+  router.attachments.push_back (index);
+  m_links[attachment.link].attachments.push_back (index);
+  return index;
+}
+
+void
+Ipv6GlobalRouteManagerImpl::InitializeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t r = 0; r < m_routers.size (); r++)
+    {
+      Spf (r);
+      PopulateRoutes (r);
+    }
+  m_initialized = true;
+}
+
+void
+Ipv6GlobalRouteManagerImpl::Spf (uint32_t root)
+{
+  NS_LOG_FUNCTION (this << root);
+  m_spfRuns++;
+
+  // Vertices: the routers first, then the links
+  uint32_t nRouters = m_routers.size ();
+  uint32_t nVertices = nRouters + m_links.size ();
+  Router &tree = m_routers[root];
+  tree.distance.assign (nVertices, NONE);
+  tree.parent.assign (nVertices, NONE);
+  tree.gateway.assign (nVertices, NONE);
+
+  typedef std::pair<uint32_t, uint32_t> Candidate; // distance, vertex
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate> > candidates;
+  tree.distance[root] = 0;
+  candidates.push (Candidate (0, root));
+
+  while (!candidates.empty ())
+    {
+      Candidate candidate = candidates.top ();
+      candidates.pop ();
+      uint32_t distance = candidate.first;
+      uint32_t v = candidate.second;
+      if (distance > tree.distance[v])
+        {
+          continue; // already reached by a shorter path
+        }
+
+      if (v < nRouters)
+        {
+          if (v != root && !m_attachments[tree.parent[v]].forwarding)
+            {
+              continue; // a host on this link, not a way through
+            }
+          const std::vector<uint32_t> &attachments = m_routers[v].attachments;
+          for (std::vector<uint32_t>::const_iterator it = attachments.begin (); it != attachments.end (); ++it)
+            {
+              const Attachment &attachment = m_attachments[*it];
+              uint32_t w = nRouters + attachment.link;
+              uint64_t d = static_cast<uint64_t> (distance) + attachment.metric;
+              if (attachment.active && d < tree.distance[w])
+                {
+                  tree.distance[w] = d;
+                  tree.parent[w] = *it;
+                  tree.gateway[w] = tree.gateway[v];
+                  candidates.push (Candidate (d, w));
+                }
+            }
+        }
+      else
+        {
+          const std::vector<uint32_t> &attachments = m_links[v - nRouters].attachments;
+          for (std::vector<uint32_t>::const_iterator it = attachments.begin (); it != attachments.end (); ++it)
+            {
+              const Attachment &attachment = m_attachments[*it];
+              uint32_t w = attachment.router;
+              if (attachment.active && distance < tree.distance[w])
+                {
+                  tree.distance[w] = distance;
+                  tree.parent[w] = *it;
+                  // the routers on the links of the root are the first hops
+                  tree.gateway[w] = tree.gateway[v] == NONE ? *it : tree.gateway[v];
+                  candidates.push (Candidate (distance, w));
+                }
+            }
+        }
+    }
+}
+
+void
+Ipv6GlobalRouteManagerImpl::PopulateRoutes (uint32_t root)
+{
+  NS_LOG_FUNCTION (this << root);
+  m_routeUpdates++;
+  uint32_t nRouters = m_routers.size ();
+  Router &tree = m_routers[root];
+  tree.routing->ClearRoutes ();
+
+  // The directly connected prefixes are left to Ipv6StaticRouting
+  std::set<uint32_t> onLink;
+  for (std::vector<uint32_t>::const_iterator it = tree.attachments.begin (); it != tree.attachments.end (); ++it)
+    {
+      if (m_attachments[*it].active)
+        {
+          onLink.insert (m_attachments[*it].link);
+        }
+    }
+
+  for (uint32_t l = 0; l < m_links.size (); l++)
+    {
+      uint32_t gatewayIndex = tree.gateway[nRouters + l];
+      if (gatewayIndex == NONE || onLink.count (l))
+        {
+          continue;
+        }
+      const Attachment &gateway = m_attachments[gatewayIndex];
+      const Attachment &exit = m_attachments[tree.parent[nRouters + gateway.link]];
+      const std::vector<uint32_t> &attachments = m_links[l].attachments;
+      for (std::vector<uint32_t>::const_iterator it = attachments.begin (); it != attachments.end (); ++it)
+        {
+          const Attachment &attachment = m_attachments[*it];
+          if (!attachment.active)
+            {
+              continue;
+            }
+          for (Prefixes::const_iterator p = attachment.prefixes.begin (); p != attachment.prefixes.end (); ++p)
+            {
+              tree.routing->AddNetworkRouteTo (p->first, p->second, gateway.address, exit.interface);
+            }
+        }
+    }
+  tree.routing->m_populated = true;
+}
+
+bool
+Ipv6GlobalRouteManagerImpl::IsAffected (uint32_t root, const std::vector<uint32_t> &removed,
+                                        const std::vector<uint32_t> &added) const
+{
+  uint32_t nRouters = m_routers.size ();
+  const Router &tree = m_routers[root];
+  for (std::vector<uint32_t>::const_iterator it = removed.begin (); it != removed.end (); ++it)
+    {
+      const Attachment &attachment = m_attachments[*it];
+      if (attachment.router == root
+          || tree.parent[nRouters + attachment.link] == *it
+          || tree.parent[attachment.router] == *it)
+        {
+          return true;
+        }
+    }
+  for (std::vector<uint32_t>::const_iterator it = added.begin (); it != added.end (); ++it)
+    {
+      const Attachment &attachment = m_attachments[*it];
+      uint64_t toRouter = tree.distance[attachment.router];
+      uint64_t toLink = tree.distance[nRouters + attachment.link];
+      if (attachment.router == root
+          || (toRouter != NONE && toRouter + attachment.metric < toLink)
+          || toLink < toRouter)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+Ipv6GlobalRouteManagerImpl::ReachesLinks (uint32_t root, const std::set<uint32_t> &links) const
+{
+  uint32_t nRouters = m_routers.size ();
+  const Router &tree = m_routers[root];
+  for (std::set<uint32_t>::const_iterator it = links.begin (); it != links.end (); ++it)
+    {
+      if (tree.gateway[nRouters + *it] != NONE)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+Ipv6GlobalRouteManagerImpl::NotifyRouterChange (uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (this << nodeId);
+  if (!m_initialized)
+    {
+      return;
+    }
+  m_changed.insert (nodeId);
+  if (!m_update.IsRunning ())
+    {
+      m_update = Simulator::ScheduleNow (&Ipv6GlobalRouteManagerImpl::Update, this);
+    }
+}
+
+void
+Ipv6GlobalRouteManagerImpl::Update ()
+{
+  NS_LOG_FUNCTION (this);
+  std::set<uint32_t> changed;
+  changed.swap (m_changed);
+
+  std::vector<uint32_t> removed;
+  std::vector<uint32_t> added;
+  std::set<uint32_t> links; // links whose attachments or prefixes changed
+  for (std::set<uint32_t>::const_iterator i = changed.begin (); i != changed.end (); ++i)
+    {
+      std::map<uint32_t, uint32_t>::const_iterator it = m_routerIndex.find (*i);
+      if (it == m_routerIndex.end ())
+        {
+          continue;
+        }
+      uint32_t r = it->second;
+      std::vector<Attachment> current;
+      if (!ScanInterfaces (r, false, current))
+        {
+          NS_LOG_LOGIC ("Topology changed, rebuilding the database");
+          BuildGlobalRoutingDatabase ();
+          InitializeRoutes ();
+          return;
+        }
+
+      std::map<uint32_t, uint32_t> previous; // attachment of each interface
+      const std::vector<uint32_t> &attachments = m_routers[r].attachments;
+      for (std::vector<uint32_t>::const_iterator j = attachments.begin (); j != attachments.end (); ++j)
+        {
+          if (m_attachments[*j].active)
+            {
+              previous[m_attachments[*j].interface] = *j;
+            }
+        }
+      for (std::vector<Attachment>::const_iterator j = current.begin (); j != current.end (); ++j)
+        {
+          std::map<uint32_t, uint32_t>::iterator k = previous.find (j->interface);
+          if (k != previous.end ())
+            {
+              Attachment &old = m_attachments[k->second];
+              if (old.link == j->link && old.metric == j->metric
+                  && old.forwarding == j->forwarding && old.address == j->address)
+                {
+                  if (old.prefixes != j->prefixes)
+                    {
+                      old.prefixes = j->prefixes;
+                      links.insert (old.link);
+                    }
+                  previous.erase (k);
+                  continue;
+                }
+              // changed in place: the new attachment takes the same slot
+              old.active = false;
+              removed.push_back (k->second);
+              links.insert (old.link);
+              previous.erase (k);
+            }
+          added.push_back (AddAttachment (*j));
+          links.insert (j->link);
+        }
+      for (std::map<uint32_t, uint32_t>::const_iterator k = previous.begin (); k != previous.end (); ++k)
+        {
+          m_attachments[k->second].active = false;
+          removed.push_back (k->second);
+          links.insert (m_attachments[k->second].link);
+        }
+    }
+
+  if (links.empty ())
+    {
+      return;
+    }
+  NS_LOG_LOGIC (removed.size () << " attachments removed, " << added.size () << " added");
+  for (uint32_t r = 0; r < m_routers.size (); r++)
+    {
+      if (IsAffected (r, removed, added))
+        {
+          Spf (r);
+          PopulateRoutes (r);
+        }
+      else if (ReachesLinks (r, links))
+        {
+          PopulateRoutes (r);
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,227 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV6_GLOBAL_ROUTE_MANAGER_IMPL_H
+#define IPV6_GLOBAL_ROUTE_MANAGER_IMPL_H
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <set>
+#include "ns3/ptr.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv6-address.h"
+
+namespace ns3 {
+
+class Ipv6;
+class Ipv6GlobalRouting;
+
+/**
+ * @brief Implementation of the Ipv6GlobalRouteManager singleton
+ *
+ * The topology is a graph of router vertices (the nodes with an
+ * Ipv6GlobalRouting) and link vertices (the channels of their up IPv6
+ * interfaces), as the router and network vertices of OSPF (\RFC{2328},
+ * section 16.1). An attachment of a router to a link, i.e. one of its
+ * interfaces, costs the interface metric from the router to the link, and
+ * nothing back. A router is only crossed if it forwards on the interface
+ * it was reached by.
+ *
+ * Every router keeps the result of its last SPF computation: the distance
+ * of every vertex, the attachment each vertex was reached by, and the
+ * attachment of the first router on the way. The routes to the prefixes of
+ * a link go to the link-local address of that first router.
+ *
+ * When attachments disappear, a router recomputes its tree only if one of
+ * them is in it; when attachments appear, only if one of them shortens the
+ * distance to its router or its link. The other routers refresh their
+ * routes from their current tree only if it reaches a link whose
+ * attachments or prefixes changed. An interface of a known router on a new
+ * channel rebuilds the whole database. A new router is not notified at
+ * all: Ipv6GlobalRoutingHelper::RecomputeRoutingTables must be called once
+ * it is installed.
+ *
+ * Simulator::Destroy deletes the singleton, which deletes the global routes
+ * and releases the Ipv6 and Ipv6GlobalRouting of every router.
+ */
+class Ipv6GlobalRouteManagerImpl
+{
+public:
+  Ipv6GlobalRouteManagerImpl ();
+  virtual ~Ipv6GlobalRouteManagerImpl ();
+
+/**
+ * @brief Delete all the global routes and forget the topology.
+ */
+  virtual void DeleteGlobalRoutes ();
+
+/**
+ * @brief Find the routers and build the graph of their links.
+ */
+  virtual void BuildGlobalRoutingDatabase ();
+
+/**
+ * @brief Run the SPF computation of every router and install its routes.
+ */
+  virtual void InitializeRoutes ();
+
+/**
+ * @brief Schedule an update of the routes for a change of a router.
+ * @param nodeId the node id of the router
+ */
+  void NotifyRouterChange (uint32_t nodeId);
+
+/**
+ * @brief Get the number of SPF computations run so far.
+ * @returns the number of computations
+ */
+  uint32_t GetNSpfRuns (void) const;
+
+/**
+ * @brief Get the number of route tables filled so far.
+ * @returns the number of route table updates
+ */
+  uint32_t GetNRouteUpdates (void) const;
+
+private:
+/**
+ * @brief Global Route Manager Impl copy construction is disallowed.
+ */
+  Ipv6GlobalRouteManagerImpl (Ipv6GlobalRouteManagerImpl& srmi);
+
+/**
+ * @brief Global Route Manager Impl assignment operator is disallowed.
+ */
+  Ipv6GlobalRouteManagerImpl& operator= (Ipv6GlobalRouteManagerImpl& srmi);
+
+  /// No vertex or attachment, and infinite distance
+  static const uint32_t NONE = 0xffffffff;
+
+  /// On-link prefixes, as network addresses and prefixes
+  typedef std::vector<std::pair<Ipv6Address, Ipv6Prefix> > Prefixes;
+
+  /**
+   * @brief An interface of a router on a link
+   */
+  struct Attachment
+  {
+    uint32_t router;     //!< router index
+    uint32_t link;       //!< link index
+    uint32_t interface;  //!< interface index in the router
+    uint16_t metric;     //!< interface metric
+    bool forwarding;     //!< the router forwards the packets received here
+    bool active;         //!< false once the interface is gone
+    Ipv6Address address; //!< link-local address of the interface
+    Prefixes prefixes;   //!< global prefixes of the interface
+  };
+
+  /**
+   * @brief A router and its last shortest path tree, indexed by vertex
+   */
+  struct Router
+  {
+    Ptr<Ipv6> ipv6;                   //!< the IPv6 stack
+    Ptr<Ipv6GlobalRouting> routing;   //!< the routing protocol to fill
+    std::vector<uint32_t> attachments; //!< attachment indexes
+    std::vector<uint32_t> distance;   //!< distance of each vertex
+    std::vector<uint32_t> parent;     //!< attachment each vertex was reached by
+    std::vector<uint32_t> gateway;    //!< attachment of the first router on the way
+  };
+
+  /**
+   * @brief A link: the routers on a channel
+   */
+  struct Link
+  {
+    std::vector<uint32_t> attachments; //!< attachment indexes
+  };
+
+/**
+ * @brief Find the Ipv6GlobalRouting of a stack, possibly in an Ipv6ListRouting.
+ * @param ipv6 the stack
+ * @returns the protocol, or 0
+ */
+  static Ptr<Ipv6GlobalRouting> GetGlobalRouting (Ptr<Ipv6> ipv6);
+
+/**
+ * @brief Get the current attachments of a router from its interfaces.
+ * @param router the router index
+ * @param createLinks add the unknown channels as new links
+ * @param attachments the attachments found
+ * @returns false if a channel is unknown and createLinks is false
+ */
+  bool ScanInterfaces (uint32_t router, bool createLinks, std::vector<Attachment> &attachments);
+
+/**
+ * @brief Add an attachment, in the slot of a former attachment of the
+ * router to the same link if there is one.
+ * @param attachment the attachment
+ * @returns its index
+ */
+  uint32_t AddAttachment (const Attachment &attachment);
+
+/**
+ * @brief Run the Dijkstra SPF computation of a router.
+ * @param root the router index
+ */
+  void Spf (uint32_t root);
+
+/**
+ * @brief Replace the routes of a router by the ones of its current tree.
+ * @param root the router index
+ */
+  void PopulateRoutes (uint32_t root);
+
+/**
+ * @brief Tell whether changed attachments may change the tree of a router.
+ * @param root the router index
+ * @param removed the removed attachments
+ * @param added the added attachments
+ * @returns true if the tree must be recomputed
+ */
+  bool IsAffected (uint32_t root, const std::vector<uint32_t> &removed,
+                   const std::vector<uint32_t> &added) const;
+
+/**
+ * @brief Tell whether the tree of a router reaches one of some links
+ * through another router, i.e. has routes to their prefixes.
+ * @param root the router index
+ * @param links the link indexes
+ * @returns true if the routes of the router must be refreshed
+ */
+  bool ReachesLinks (uint32_t root, const std::set<uint32_t> &links) const;
+
+/**
+ * @brief Apply the changes notified since the last update.
+ */
+  void Update ();
+
+  std::vector<Router> m_routers;          //!< the routers
+  std::vector<Link> m_links;              //!< the links
+  std::vector<Attachment> m_attachments;  //!< the attachments
+  std::map<uint32_t, uint32_t> m_routerIndex; //!< router index of each node id
+  std::map<uint32_t, uint32_t> m_linkIndex;   //!< link index of each channel id
+  std::set<uint32_t> m_changed;           //!< node ids changed since the last update
+  EventId m_update;                       //!< the pending update
+  bool m_initialized;                     //!< the routes were computed
+  uint32_t m_spfRuns;                     //!< number of SPF computations
+  uint32_t m_routeUpdates;                //!< number of route table updates
+};
+
+} // namespace ns3
+
+#endif /* IPV6_GLOBAL_ROUTE_MANAGER_IMPL_H */
@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulation-singleton.h"
+#include "ipv6-global-route-manager.h"
+#include "ipv6-global-route-manager-impl.h"
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6GlobalRouteManager");
+
+namespace ns3 {
+
+void
+Ipv6GlobalRouteManager::DeleteGlobalRoutes ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<Ipv6GlobalRouteManagerImpl>::Get ()->
+  DeleteGlobalRoutes ();
+}
+
+void
+Ipv6GlobalRouteManager::BuildGlobalRoutingDatabase (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<Ipv6GlobalRouteManagerImpl>::Get ()->
+  BuildGlobalRoutingDatabase ();
+}
+
+void
+Ipv6GlobalRouteManager::InitializeRoutes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<Ipv6GlobalRouteManagerImpl>::Get ()->
+  InitializeRoutes ();
+}
+
+void
+Ipv6GlobalRouteManager::NotifyRouterChange (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (node);
+  SimulationSingleton<Ipv6GlobalRouteManagerImpl>::Get ()->
+  NotifyRouterChange (node->GetId ());
+}
+
+} // namespace ns3
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV6_GLOBAL_ROUTE_MANAGER_H
+#define IPV6_GLOBAL_ROUTE_MANAGER_H
+
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * @brief A global router for IPv6
+ *
+ * The IPv6 counterpart of GlobalRouteManager. This singleton object finds
+ * every node whose IPv6 routing includes an Ipv6GlobalRouting, builds the
+ * graph of their links from their IPv6 interfaces, runs a Dijkstra SPF
+ * computation from each of them, and fills their Ipv6GlobalRouting tables.
+ *
+ * When the interfaces of a router change, only the routers whose shortest
+ * path tree may be affected recompute it.
+ */
+class Ipv6GlobalRouteManager
+{
+public:
+/**
+ * @brief Delete all the routes installed in the Ipv6GlobalRouting
+ * protocols, and forget the topology.
+ */
+  static void DeleteGlobalRoutes ();
+
+/**
+ * @brief Build the graph of the routers and their links.
+ */
+  static void BuildGlobalRoutingDatabase ();
+
+/**
+ * @brief Compute the routes of every router and populate their
+ * Ipv6GlobalRouting tables.
+ */
+  static void InitializeRoutes ();
+
+/**
+ * @brief Update the routes after a change of the interfaces or addresses
+ * of a router.
+ *
+ * The changes notified at the same time are handled together, in an event
+ * scheduled now.
+ *
+ * @param node the router
+ */
+  static void NotifyRouterChange (Ptr<Node> node);
+
+private:
+/**
+ * @brief Global Route Manager copy construction is disallowed.
+ */
+  Ipv6GlobalRouteManager (Ipv6GlobalRouteManager& srm);
+
+/**
+ * @brief Global Router copy assignment operator is disallowed.
+ */
+  Ipv6GlobalRouteManager& operator= (Ipv6GlobalRouteManager& srm);
+};
+
+} // namespace ns3
+
+#endif /* IPV6_GLOBAL_ROUTE_MANAGER_H */
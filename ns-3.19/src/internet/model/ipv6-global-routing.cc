@@ -0,0 +1,386 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iomanip>
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/net-device.h"
+#include "ns3/names.h"
+
+#include "ipv6-global-routing.h"
+#include "ipv6-global-route-manager.h"
+
+NS_LOG_COMPONENT_DEFINE ("Ipv6GlobalRouting");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (Ipv6GlobalRouting)
+  ;
+
+TypeId
+Ipv6GlobalRouting::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::Ipv6GlobalRouting")
+    .SetParent<Ipv6RoutingProtocol> ()
+    .AddConstructor<Ipv6GlobalRouting> ()
+    .AddAttribute ("RespondToInterfaceEvents",
+                   "Update the global routes when an interface goes up or down, or an address is added or removed",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&Ipv6GlobalRouting::m_respondToInterfaceEvents),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+Ipv6GlobalRouting::Ipv6GlobalRouting ()
+  : m_respondToInterfaceEvents (true),
+    m_populated (false),
+    m_nRoutes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv6GlobalRouting::~Ipv6GlobalRouting ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv6GlobalRouting::AddHostRouteTo (Ipv6Address dest, Ipv6Address nextHop, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << dest << nextHop << interface);
+  AddNetworkRouteTo (dest, Ipv6Prefix (128), nextHop, interface);
+}
+
+void
+Ipv6GlobalRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << network << networkPrefix << nextHop << interface);
+  uint8_t length = networkPrefix.GetPrefixLength ();
+  NS_ASSERT_MSG (networkPrefix == Ipv6Prefix (length), "Non-contiguous prefix " << networkPrefix);
+  PrefixRoutes &level = m_routes[length];
+  level.prefix = networkPrefix;
+  network = network.CombinePrefix (networkPrefix);
+  std::pair<NetworkRoutes::iterator, bool> ret =
+    level.routes.insert (std::make_pair (network, Ipv6RoutingTableEntry ()));
+  if (ret.second)
+    {
+      m_nRoutes++;
+    }
+  if (nextHop.IsAny ())
+    {
+      ret.first->second = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
+    }
+  else
+    {
+      ret.first->second = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
+    }
+}
+
+void
+Ipv6GlobalRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface)
+{
+  NS_LOG_FUNCTION (this << network << networkPrefix << interface);
+  AddNetworkRouteTo (network, networkPrefix, Ipv6Address::GetAny (), interface);
+}
+
+bool
+Ipv6GlobalRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix networkPrefix)
+{
+  NS_LOG_FUNCTION (this << network << networkPrefix);
+  RoutingTable::iterator it = m_routes.find (networkPrefix.GetPrefixLength ());
+  if (it == m_routes.end () || it->second.routes.erase (network.CombinePrefix (networkPrefix)) == 0)
+    {
+      return false;
+    }
+  m_nRoutes--;
+  if (it->second.routes.empty ())
+    {
+      m_routes.erase (it);
+    }
+  return true;
+}
+
+void
+Ipv6GlobalRouting::ClearRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routes.clear ();
+  m_nRoutes = 0;
+}
+
+uint32_t
+Ipv6GlobalRouting::GetNRoutes (void) const
+{
+  return m_nRoutes;
+}
+
+Ipv6RoutingTableEntry
+Ipv6GlobalRouting::GetRoute (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  for (RoutingTable::const_iterator it = m_routes.begin (); it != m_routes.end (); ++it)
+    {
+      if (i < it->second.routes.size ())
+        {
+          NetworkRoutes::const_iterator j = it->second.routes.begin ();
+          std::advance (j, i);
+          return j->second;
+        }
+      i -= it->second.routes.size ();
+    }
+  NS_ASSERT_MSG (false, "Route index out of range");
+  return Ipv6RoutingTableEntry ();
+}
+
+Ptr<Ipv6Route>
+Ipv6GlobalRouting::LookupGlobal (Ipv6Address dst, Ptr<NetDevice> interface)
+{
+  NS_LOG_FUNCTION (this << dst << interface);
+  for (RoutingTable::iterator it = m_routes.begin (); it != m_routes.end (); ++it)
+    {
+      NetworkRoutes::const_iterator j = it->second.routes.find (dst.CombinePrefix (it->second.prefix));
+      if (j == it->second.routes.end ())
+        {
+          continue;
+        }
+      const Ipv6RoutingTableEntry &route = j->second;
+      uint32_t interfaceIdx = route.GetInterface ();
+      /* if interface is given, check the route will output on this interface */
+      if (interface && interface != m_ipv6->GetNetDevice (interfaceIdx))
+        {
+          NS_LOG_LOGIC ("Not on requested interface, skipping");
+          continue;
+        }
+      NS_LOG_LOGIC ("Found global route " << route);
+      Ptr<Ipv6Route> rtentry = Create<Ipv6Route> ();
+      rtentry->SetSource (SourceAddressSelection (interfaceIdx, dst));
+      rtentry->SetDestination (route.GetDest ());
+      rtentry->SetGateway (route.GetGateway ());
+      rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+      return rtentry;
+    }
+  return 0;
+}
+
+Ptr<Ipv6Route>
+Ipv6GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
+{
+  NS_LOG_FUNCTION (this << header << oif);
+  Ipv6Address destination = header.GetDestinationAddress ();
+  if (destination.IsMulticast ())
+    {
+      NS_LOG_LOGIC ("Multicast destination-- returning false");
+      return 0; // Let other routing protocols try to handle this
+    }
+
+  Ptr<Ipv6Route> rtentry = LookupGlobal (destination, oif);
+  if (rtentry)
+    {
+      sockerr = Socket::ERROR_NOTERROR;
+    }
+  else
+    {
+      sockerr = Socket::ERROR_NOROUTETOHOST;
+    }
+  return rtentry;
+}
+
+bool
+Ipv6GlobalRouting::RouteInput (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                               UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                               LocalDeliverCallback lcb, ErrorCallback ecb)
+{
+  NS_LOG_FUNCTION (this << p << header << header.GetSourceAddress () << header.GetDestinationAddress () << idev);
+  NS_ASSERT (m_ipv6 != 0);
+  // Check if input device supports IP
+  NS_ASSERT (m_ipv6->GetInterfaceForDevice (idev) >= 0);
+  uint32_t iif = m_ipv6->GetInterfaceForDevice (idev);
+  Ipv6Address dst = header.GetDestinationAddress ();
+
+  if (dst.IsMulticast ())
+    {
+      NS_LOG_LOGIC ("Multicast destination-- returning false");
+      return false; // Let other routing protocols try to handle this
+    }
+
+  // As Ipv6StaticRouting, accept the packets to any of our addresses
+  if (m_ipv6->GetInterfaceForAddress (dst) >= 0)
+    {
+      NS_LOG_LOGIC ("For me (destination " << dst << " match)");
+      lcb (p, header, iif);
+      return true;
+    }
+
+  // Check if input device supports IP forwarding
+  if (m_ipv6->IsForwarding (iif) == false)
+    {
+      NS_LOG_LOGIC ("Forwarding disabled for this interface");
+      ecb (p, header, Socket::ERROR_NOROUTETOHOST);
+      return false;
+    }
+
+  NS_LOG_LOGIC ("Unicast destination- looking up global route");
+  Ptr<Ipv6Route> rtentry = LookupGlobal (dst);
+  if (rtentry != 0)
+    {
+      NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
+      ucb (idev, rtentry, p, header);
+      return true;
+    }
+  NS_LOG_LOGIC ("Did not find unicast destination- returning false");
+  return false; // Let other routing protocols try to handle this
+}
+
+void
+Ipv6GlobalRouting::NotifyTopologyChange (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Before the first computation, the whole database is built anyway
+  if (m_respondToInterfaceEvents && m_populated)
+    {
+      Ipv6GlobalRouteManager::NotifyRouterChange (m_ipv6->GetObject<Node> ());
+    }
+}
+
+void
+Ipv6GlobalRouting::NotifyInterfaceUp (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  NotifyTopologyChange ();
+}
+
+void
+Ipv6GlobalRouting::NotifyInterfaceDown (uint32_t i)
+{
+  NS_LOG_FUNCTION (this << i);
+  NotifyTopologyChange ();
+}
+
+void
+Ipv6GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  NotifyTopologyChange ();
+}
+
+void
+Ipv6GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  NotifyTopologyChange ();
+}
+
+void
+Ipv6GlobalRouting::NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse)
+{
+  // The routes learnt by the stack (redirects, router advertisements) go
+  // to Ipv6StaticRouting
+}
+
+void
+Ipv6GlobalRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse)
+{
+}
+
+void
+Ipv6GlobalRouting::SetIpv6 (Ptr<Ipv6> ipv6)
+{
+  NS_LOG_FUNCTION (this << ipv6);
+  NS_ASSERT (m_ipv6 == 0 && ipv6 != 0);
+  m_ipv6 = ipv6;
+}
+
+Ipv6Address
+Ipv6GlobalRouting::SourceAddressSelection (uint32_t interface, Ipv6Address dest)
+{
+  NS_LOG_FUNCTION (this << interface << dest);
+  Ipv6InterfaceAddress dst (dest);
+
+  /* first address of an IPv6 interface is link-local ones */
+  for (uint32_t i = 1; i < m_ipv6->GetNAddresses (interface); i++)
+    {
+      Ipv6InterfaceAddress test = m_ipv6->GetAddress (interface, i);
+      if (test.GetScope () == dst.GetScope ())
+        {
+          return test.GetAddress ();
+        }
+    }
+  return m_ipv6->GetAddress (interface, 0).GetAddress ();
+}
+
+void
+Ipv6GlobalRouting::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  ClearRoutes ();
+  m_ipv6 = 0;
+  Ipv6RoutingProtocol::DoDispose ();
+}
+
+// Formatted like output of "route -n" command
+void
+Ipv6GlobalRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
+{
+  NS_LOG_FUNCTION (this << stream);
+  std::ostream* os = stream->GetStream ();
+
+  *os << "Node: " << m_ipv6->GetObject<Node> ()->GetId ()
+      << " Time: " << Simulator::Now ().GetSeconds () << "s "
+      << "Ipv6GlobalRouting table" << std::endl;
+
+  if (GetNRoutes () > 0)
+    {
+      *os << "Destination                    Next Hop                   Flag Met Ref Use If" << std::endl;
+      for (RoutingTable::const_iterator it = m_routes.begin (); it != m_routes.end (); ++it)
+        {
+          for (NetworkRoutes::const_iterator j = it->second.routes.begin (); j != it->second.routes.end (); ++j)
+            {
+              std::ostringstream dest, gw, flags;
+              const Ipv6RoutingTableEntry &route = j->second;
+              dest << route.GetDest () << "/" << int(route.GetDestNetworkPrefix ().GetPrefixLength ());
+              *os << std::setiosflags (std::ios::left) << std::setw (31) << dest.str ();
+              gw << route.GetGateway ();
+              *os << std::setiosflags (std::ios::left) << std::setw (27) << gw.str ();
+              flags << "U";
+              if (route.IsGateway ())
+                {
+                  flags << "G";
+                }
+              *os << std::setiosflags (std::ios::left) << std::setw (5) << flags.str ();
+              // Metric, ref ct and use not implemented
+              *os << "-" << "   ";
+              *os << "-" << "   ";
+              *os << "-" << "   ";
+              if (Names::FindName (m_ipv6->GetNetDevice (route.GetInterface ())) != "")
+                {
+                  *os << Names::FindName (m_ipv6->GetNetDevice (route.GetInterface ()));
+                }
+              else
+                {
+                  *os << route.GetInterface ();
+                }
+              *os << std::endl;
+            }
+        }
+    }
+}
+
+} // namespace ns3
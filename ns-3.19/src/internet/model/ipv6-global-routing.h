@@ -0,0 +1,201 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV6_GLOBAL_ROUTING_H
+#define IPV6_GLOBAL_ROUTING_H
+
+#include <stdint.h>
+#include <map>
+#include <functional>
+
+#include "ns3/ptr.h"
+#include "ns3/sgi-hashmap.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-routing-protocol.h"
+#include "ns3/ipv6-routing-table-entry.h"
+
+namespace ns3 {
+
+class Packet;
+class NetDevice;
+class Ipv6Route;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Global routing protocol for IP version 6 stacks.
+ *
+ * The IPv6 counterpart of Ipv4GlobalRouting: the routes are computed by
+ * the Ipv6GlobalRouteManager, which knows the whole topology, and stored
+ * here. The routes lead to the on-link prefixes of the other routers, via
+ * the link-local address of the next router; the directly connected
+ * prefixes are left to Ipv6StaticRouting, so this protocol is meant to be
+ * added to an Ipv6ListRouting next to it.
+ *
+ * The routes are kept in a hash map per prefix length, longest first, so a
+ * lookup costs one hash lookup per prefix length in use instead of a scan
+ * of the whole table.
+ *
+ * When an interface goes up or down, or an address is added or removed,
+ * the manager is told to update the routes. Only the routers whose
+ * shortest path tree may change recompute it.
+ *
+ * \see Ipv6GlobalRouteManager
+ */
+class Ipv6GlobalRouting : public Ipv6RoutingProtocol
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  Ipv6GlobalRouting ();
+  virtual ~Ipv6GlobalRouting ();
+
+  // These methods inherited from base class
+  virtual Ptr<Ipv6Route> RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+  virtual bool RouteInput  (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                            UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                            LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address);
+  virtual void NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
+  virtual void NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse = Ipv6Address::GetZero ());
+  virtual void SetIpv6 (Ptr<Ipv6> ipv6);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
+
+  /**
+   * \brief Add a host route to the global routing table.
+   * \param dest the destination
+   * \param nextHop the next hop
+   * \param interface the interface index
+   */
+  void AddHostRouteTo (Ipv6Address dest, Ipv6Address nextHop, uint32_t interface);
+
+  /**
+   * \brief Add a network route to the global routing table.
+   *
+   * A route to the same network replaces the previous one.
+   *
+   * \param network the network
+   * \param networkPrefix the prefix of the network
+   * \param nextHop the next hop
+   * \param interface the interface index
+   */
+  void AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface);
+
+  /**
+   * \brief Add an on-link network route to the global routing table.
+   * \param network the network
+   * \param networkPrefix the prefix of the network
+   * \param interface the interface index
+   */
+  void AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface);
+
+  /**
+   * \brief Remove the route to a network.
+   * \param network the network
+   * \param networkPrefix the prefix of the network
+   * \return true if there was such a route
+   */
+  bool RemoveRoute (Ipv6Address network, Ipv6Prefix networkPrefix);
+
+  /**
+   * \brief Get the number of routes.
+   * \return the number of routes
+   */
+  uint32_t GetNRoutes (void) const;
+
+  /**
+   * \brief Get a route, longest prefixes first.
+   *
+   * The routes are not kept in a list, so this walks the table: it is
+   * meant for printing and tests.
+   *
+   * \param i the index of the route
+   * \return the route
+   */
+  Ipv6RoutingTableEntry GetRoute (uint32_t i) const;
+
+  /**
+   * \brief Look up the route to a destination.
+   * \param dst the destination
+   * \param interface the output device, if the route must use it
+   * \return the route, or 0 if none
+   */
+  Ptr<Ipv6Route> LookupGlobal (Ipv6Address dst, Ptr<NetDevice> interface = 0);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  friend class Ipv6GlobalRouteManagerImpl;
+
+  /// Routes to the networks of one prefix length, by network address
+  typedef sgi::hash_map<Ipv6Address, Ipv6RoutingTableEntry, Ipv6AddressHash> NetworkRoutes;
+
+  /**
+   * \brief The routes of one prefix length.
+   */
+  struct PrefixRoutes
+  {
+    Ipv6Prefix prefix;     //!< the prefix
+    NetworkRoutes routes;  //!< the routes, by network address
+  };
+
+  /// The routes, longest prefix first
+  typedef std::map<uint8_t, PrefixRoutes, std::greater<uint8_t> > RoutingTable;
+
+  /**
+   * \brief Remove all the routes.
+   */
+  void ClearRoutes (void);
+
+  /**
+   * \brief Tell the manager the interfaces of this router changed.
+   */
+  void NotifyTopologyChange (void);
+
+  /**
+   * \brief Choose the source address of a packet.
+   * \param interface the output interface
+   * \param dest the destination
+   * \return the address of the interface with the same scope as the
+   * destination, else its link-local address
+   */
+  Ipv6Address SourceAddressSelection (uint32_t interface, Ipv6Address dest);
+
+  /// Recompute the routes on interface events
+  bool m_respondToInterfaceEvents;
+  /// The manager installed routes here
+  bool m_populated;
+  /// The routes
+  RoutingTable m_routes;
+  /// The number of routes
+  uint32_t m_nRoutes;
+  /// The IPv6 stack
+  Ptr<Ipv6> m_ipv6;
+};
+
+} // namespace ns3
+
+#endif /* IPV6_GLOBAL_ROUTING_H */
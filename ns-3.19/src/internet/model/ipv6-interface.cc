@@ -123,6 +123,20 @@ void Ipv6Interface::DoSetup ()
     }
 }
 
+void Ipv6Interface::NotifyAddressRemoved (Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  if (m_node == 0)
+    {
+      return;
+    }
+  Ptr<Ipv6L3Protocol> ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
+  if (ipv6 != 0)
+    {
+      ipv6->NotifyAddressRemoved (this, address);
+    }
+}
+
 void Ipv6Interface::SetNode (Ptr<Node> node)
 {
   NS_LOG_FUNCTION (this << node);
@@ -143,6 +157,12 @@ Ptr<NetDevice> Ipv6Interface::GetDevice () const
   return m_device;
 }
 
+Ptr<NdiscCache> Ipv6Interface::GetNdiscCache () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ndCache;
+}
+
 void Ipv6Interface::SetMetric (uint16_t metric)
 {
   NS_LOG_FUNCTION (this << metric);
@@ -182,7 +202,12 @@ void Ipv6Interface::SetDown ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_ifup = false;
-  m_addresses.clear ();
+  Ipv6InterfaceAddressList addresses;
+  addresses.swap (m_addresses);
+  for (Ipv6InterfaceAddressListCI it = addresses.begin (); it != addresses.end (); ++it)
+    {
+      NotifyAddressRemoved (it->GetAddress ());
+    }
 }
 
 bool Ipv6Interface::IsForwarding () const
@@ -214,16 +239,16 @@ bool Ipv6Interface::AddAddress (Ipv6InterfaceAddress iface)
         }
 
       m_addresses.push_back (iface);
+      m_node->GetObject<Ipv6L3Protocol> ()->NotifyAddressAdded (this, addr);
 
       if (!addr.IsAny () || !addr.IsLocalhost ())
         {
           /* DAD handling */
           Ptr<Icmpv6L4Protocol> icmpv6 = m_node->GetObject<Ipv6L3Protocol> ()->GetIcmpv6 ();
 
-          if (icmpv6 && icmpv6->IsAlwaysDad ())
+          if (icmpv6)
             {
-              Simulator::Schedule (Seconds (0.), &Icmpv6L4Protocol::DoDAD, icmpv6, addr, this);
-              Simulator::Schedule (Seconds (1.), &Icmpv6L4Protocol::FunctionDadTimeout, icmpv6, this, addr);
+              icmpv6->StartDad (addr, this);
             }
         }
       return true;
@@ -294,6 +319,7 @@ Ipv6InterfaceAddress Ipv6Interface::RemoveAddress (uint32_t index)
         {
           Ipv6InterfaceAddress iface = (*it);
           m_addresses.erase (it);
+          NotifyAddressRemoved (iface.GetAddress ());
           return iface;
         }
 
@@ -322,6 +348,7 @@ Ipv6Interface::RemoveAddress(Ipv6Address address)
         {
           Ipv6InterfaceAddress iface = (*it);
           m_addresses.erase(it);
+          NotifyAddressRemoved (iface.GetAddress ());
           return iface;
         }
     }
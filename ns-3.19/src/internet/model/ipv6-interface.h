@@ -83,6 +83,12 @@ public:
    */
   virtual Ptr<NetDevice> GetDevice () const;
 
+  /**
+   * \brief Get the Neighbor Discovery cache of the interface.
+   * \return the cache, 0 if the device does not need address resolution
+   */
+  Ptr<NdiscCache> GetNdiscCache () const;
+
   /**
    * \brief Set the metric.
    * \param metric configured routing metric (cost) of this interface
@@ -277,6 +283,12 @@ private:
    */
   void DoSetup ();
 
+  /**
+   * \brief Tell the IPv6 stack of the node that an address was removed.
+   * \param address the address
+   */
+  void NotifyAddressRemoved (Ipv6Address address);
+
   /**
    * \brief The addresses assigned to this interface.
    */
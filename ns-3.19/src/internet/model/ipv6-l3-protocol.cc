@@ -118,6 +118,9 @@ void Ipv6L3Protocol::DoDispose ()
       *it = 0;
     }
   m_interfaces.clear ();
+  m_deviceIndex.clear ();
+  m_addressIndex.clear ();
+  m_prefixIndexes.clear ();
 
   /* remove raw sockets */
   for (SocketList::iterator it = m_sockets.begin (); it != m_sockets.end (); ++it)
@@ -174,49 +177,185 @@ uint32_t Ipv6L3Protocol::AddIpv6Interface (Ptr<Ipv6Interface> interface)
 
   m_interfaces.push_back (interface);
   m_nInterfaces++;
+
+  Ptr<NetDevice> device = interface->GetDevice ();
+  if (device != 0)
+    {
+      uint32_t ifIndex = device->GetIfIndex ();
+      if (ifIndex >= m_deviceIndex.size ())
+        {
+          m_deviceIndex.resize (ifIndex + 1, -1);
+        }
+      if (m_deviceIndex[ifIndex] < 0)
+        {
+          m_deviceIndex[ifIndex] = index;
+        }
+    }
+
+  /* the addresses set up before the interface was added, such as the link-local one */
+  for (uint32_t j = 0; j < interface->GetNAddresses (); j++)
+    {
+      IndexAddress (index, interface->GetAddress (j).GetAddress ());
+    }
   return index;
 }
 
 Ptr<Ipv6Interface> Ipv6L3Protocol::GetInterface (uint32_t index) const
 {
   NS_LOG_FUNCTION (this << index);
-  uint32_t tmp = 0;
+  if (index < m_interfaces.size ())
+    {
+      return m_interfaces[index];
+    }
+  return 0;
+}
 
-  for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
+int32_t Ipv6L3Protocol::GetInterfaceIndex (Ptr<const Ipv6Interface> interface) const
+{
+  NS_LOG_FUNCTION (this << interface);
+  if (interface->GetDevice () != 0)
     {
-      if (index == tmp)
+      int32_t index = GetInterfaceForDevice (interface->GetDevice ());
+      if (index >= 0 && m_interfaces[index] == interface)
         {
-          return *it;
+          return index;
+        }
+      if (index < 0 && m_node != 0 && interface->GetDevice ()->GetNode () == m_node)
+        {
+          /* the device has no interface yet */
+          return -1;
         }
-      tmp++;
     }
-  return 0;
+  for (uint32_t i = 0; i < m_interfaces.size (); i++)
+    {
+      if (m_interfaces[i] == interface)
+        {
+          return i;
+        }
+    }
+  return -1;
 }
 
-uint32_t Ipv6L3Protocol::GetNInterfaces () const
+void Ipv6L3Protocol::IndexAddress (uint32_t index, Ipv6Address address) const
 {
-  NS_LOG_FUNCTION_NOARGS ();
-  return m_nInterfaces;
+  NS_LOG_FUNCTION (this << index << address);
+  Ipv6AddressIndex::iterator it = m_addressIndex.find (address);
+  if (it == m_addressIndex.end () || it->second > index)
+    {
+      m_addressIndex[address] = index;
+    }
+  for (std::map<uint8_t, Ipv6AddressIndex>::iterator i = m_prefixIndexes.begin (); i != m_prefixIndexes.end (); ++i)
+    {
+      Ipv6Address prefix = address.CombinePrefix (Ipv6Prefix (i->first));
+      it = i->second.find (prefix);
+      if (it == i->second.end () || it->second > index)
+        {
+          i->second[prefix] = index;
+        }
+    }
 }
 
-int32_t Ipv6L3Protocol::GetInterfaceForAddress (Ipv6Address address) const
+Ipv6L3Protocol::Ipv6AddressIndex &Ipv6L3Protocol::GetPrefixIndex (Ipv6Prefix prefix) const
 {
-  NS_LOG_FUNCTION (this << address);
-  int32_t index = 0;
+  NS_LOG_FUNCTION (this << prefix);
+  uint8_t length = prefix.GetPrefixLength ();
+  std::map<uint8_t, Ipv6AddressIndex>::iterator it = m_prefixIndexes.find (length);
+  if (it != m_prefixIndexes.end ())
+    {
+      return it->second;
+    }
+  Ipv6AddressIndex &index = m_prefixIndexes[length];
+  for (uint32_t i = 0; i < m_interfaces.size (); i++)
+    {
+      for (uint32_t j = 0; j < m_interfaces[i]->GetNAddresses (); j++)
+        {
+          Ipv6Address combined = m_interfaces[i]->GetAddress (j).GetAddress ().CombinePrefix (prefix);
+          if (index.find (combined) == index.end ())
+            {
+              index[combined] = i;
+            }
+        }
+    }
+  return index;
+}
 
-  for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
+void Ipv6L3Protocol::NotifyAddressAdded (Ptr<const Ipv6Interface> interface, Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  int32_t index = GetInterfaceIndex (interface);
+  if (index >= 0)
     {
-      uint32_t j = 0;
-      uint32_t max = (*it)->GetNAddresses ();
+      IndexAddress (index, address);
+    }
+}
+
+void Ipv6L3Protocol::NotifyAddressRemoved (Ptr<const Ipv6Interface> interface, Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << interface << address);
+  int32_t index = GetInterfaceIndex (interface);
+  if (index < 0)
+    {
+      return;
+    }
 
-      for (j = 0; j < max; j++)
+  /* only the entries pointing to this interface change */
+  std::vector<IndexEntry> removed;
+  Ipv6AddressIndex::iterator it = m_addressIndex.find (address);
+  if (it != m_addressIndex.end () && it->second == static_cast<uint32_t> (index))
+    {
+      m_addressIndex.erase (it);
+      IndexEntry entry = { &m_addressIndex, address, Ipv6Prefix (128) };
+      removed.push_back (entry);
+    }
+  for (std::map<uint8_t, Ipv6AddressIndex>::iterator i = m_prefixIndexes.begin (); i != m_prefixIndexes.end (); ++i)
+    {
+      Ipv6Prefix prefix (i->first);
+      Ipv6Address key = address.CombinePrefix (prefix);
+      it = i->second.find (key);
+      if (it != i->second.end () && it->second == static_cast<uint32_t> (index))
+        {
+          i->second.erase (it);
+          IndexEntry entry = { &i->second, key, prefix };
+          removed.push_back (entry);
+        }
+    }
+
+  /* this interface, through another address, or a higher one may still
+   * hold them: the lowest interface was the one indexed */
+  for (uint32_t i = index; i < m_interfaces.size () && !removed.empty (); i++)
+    {
+      for (uint32_t j = 0; j < m_interfaces[i]->GetNAddresses (); j++)
         {
-          if ((*it)->GetAddress (j).GetAddress () == address)
+          Ipv6Address other = m_interfaces[i]->GetAddress (j).GetAddress ();
+          for (std::vector<IndexEntry>::iterator e = removed.begin (); e != removed.end (); )
             {
-              return index;
+              if (other.CombinePrefix (e->prefix) == e->key)
+                {
+                  (*e->index)[e->key] = i;
+                  e = removed.erase (e);
+                }
+              else
+                {
+                  ++e;
+                }
             }
         }
-      index++;
+    }
+}
+
+uint32_t Ipv6L3Protocol::GetNInterfaces () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_nInterfaces;
+}
+
+int32_t Ipv6L3Protocol::GetInterfaceForAddress (Ipv6Address address) const
+{
+  NS_LOG_FUNCTION (this << address);
+  Ipv6AddressIndex::const_iterator it = m_addressIndex.find (address);
+  if (it != m_addressIndex.end ())
+    {
+      return it->second;
     }
   return -1;
 }
@@ -224,6 +363,18 @@ int32_t Ipv6L3Protocol::GetInterfaceForAddress (Ipv6Address address) const
 int32_t Ipv6L3Protocol::GetInterfaceForPrefix (Ipv6Address address, Ipv6Prefix mask) const
 {
   NS_LOG_FUNCTION (this << address << mask);
+  if (Ipv6Prefix (mask.GetPrefixLength ()) == mask)
+    {
+      Ipv6AddressIndex &prefixes = GetPrefixIndex (mask);
+      Ipv6AddressIndex::const_iterator it = prefixes.find (address.CombinePrefix (mask));
+      if (it != prefixes.end ())
+        {
+          return it->second;
+        }
+      return -1;
+    }
+
+  /* not a contiguous mask */
   int32_t index = 0;
 
   for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
@@ -250,6 +401,22 @@ Ptr<NetDevice> Ipv6L3Protocol::GetNetDevice (uint32_t i)
 int32_t Ipv6L3Protocol::GetInterfaceForDevice (Ptr<const NetDevice> device) const
 {
   NS_LOG_FUNCTION (this << device);
+  if (device != 0)
+    {
+      uint32_t ifIndex = device->GetIfIndex ();
+      int32_t interface = ifIndex < m_deviceIndex.size () ? m_deviceIndex[ifIndex] : -1;
+      if (interface >= 0 && m_interfaces[interface]->GetDevice () == device)
+        {
+          return interface;
+        }
+      if (interface < 0 && m_node != 0 && ifIndex < m_node->GetNDevices () && m_node->GetDevice (ifIndex) == device)
+        {
+          /* a device of this node without an interface */
+          return -1;
+        }
+    }
+
+  /* a device of another node, or whose ifIndex changed */
   int32_t index = 0;
 
   for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
@@ -473,6 +640,12 @@ void Ipv6L3Protocol::SetPmtu (Ipv6Address dst, uint32_t pmtu)
   m_pmtuCache->SetPmtu (dst, pmtu);
 }
 
+uint32_t Ipv6L3Protocol::GetPmtu (Ipv6Address dst) const
+{
+  NS_LOG_FUNCTION (this << dst);
+  return m_pmtuCache->GetPmtu (dst);
+}
+
 
 bool Ipv6L3Protocol::IsUp (uint32_t i) const
 {
@@ -799,31 +972,26 @@ void Ipv6L3Protocol::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16
 {
   NS_LOG_FUNCTION (this << device << p << protocol << from << to << packetType);
   NS_LOG_LOGIC ("Packet from " << from << " received on node " << m_node->GetId ());
-  uint32_t interface = 0;
   Ptr<Packet> packet = p->Copy ();
-  Ptr<Ipv6Interface> ipv6Interface = 0;
+  int32_t index = GetInterfaceForDevice (device);
+  uint32_t interface = index >= 0 ? index : m_nInterfaces;
 
-  for (Ipv6InterfaceList::const_iterator it = m_interfaces.begin (); it != m_interfaces.end (); it++)
+  if (index >= 0)
     {
-      ipv6Interface = *it;
+      Ptr<Ipv6Interface> ipv6Interface = m_interfaces[index];
 
-      if (ipv6Interface->GetDevice () == device)
+      if (ipv6Interface->IsUp ())
         {
-          if (ipv6Interface->IsUp ())
-            {
-              m_rxTrace (packet, m_node->GetObject<Ipv6> (), interface);
-              break;
-            }
-          else
-            {
-              NS_LOG_LOGIC ("Dropping received packet-- interface is down");
-              Ipv6Header hdr;
-              packet->RemoveHeader (hdr);
-              m_dropTrace (hdr, packet, DROP_INTERFACE_DOWN, m_node->GetObject<Ipv6> (), interface);
-              return;
-            }
+          m_rxTrace (packet, m_node->GetObject<Ipv6> (), interface);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Dropping received packet-- interface is down");
+          Ipv6Header hdr;
+          packet->RemoveHeader (hdr);
+          m_dropTrace (hdr, packet, DROP_INTERFACE_DOWN, m_node->GetObject<Ipv6> (), interface);
+          return;
         }
-      interface++;
     }
 
   Ipv6Header hdr;
@@ -945,8 +1113,6 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
 
           if (fragments.size () != 0)
             {
-              std::ostringstream oss;
-
               /* IPv6 header is already added in fragments */
               for (std::list<Ptr<Packet> >::const_iterator it = fragments.begin (); it != fragments.end (); it++)
                 {
@@ -975,8 +1141,6 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
 
           if (fragments.size () != 0)
             {
-              std::ostringstream oss;
-
               /* IPv6 header is already added in fragments */
               for (std::list<Ptr<Packet> >::const_iterator it = fragments.begin (); it != fragments.end (); it++)
                 {
@@ -22,8 +22,11 @@
 #define IPV6_L3_PROTOCOL_H
 
 #include <list>
+#include <vector>
+#include <map>
 
 #include "ns3/traced-callback.h"
+#include "ns3/sgi-hashmap.h"
 #include "ns3/net-device.h"
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-address.h"
@@ -288,6 +291,13 @@ public:
    */
   virtual void SetPmtu (Ipv6Address dst, uint32_t pmtu);
 
+  /**
+   * \brief Get the Path MTU for the specified IPv6 destination address.
+   * \param dst Ipv6 destination address
+   * \return the Path MTU (zero if unknown)
+   */
+  uint32_t GetPmtu (Ipv6Address dst) const;
+
   /**
    * \brief Is specified interface up ?
    * \param i interface index
@@ -384,11 +394,29 @@ private:
   /* for unit-tests */
   friend class Ipv6L3ProtocolTestCase;
   friend class Ipv6ExtensionLooseRouting;
+  /* to keep the address indexes up to date */
+  friend class Ipv6Interface;
 
   /**
    * \brief Container of the IPv6 Interfaces.
    */
-  typedef std::list<Ptr<Ipv6Interface> > Ipv6InterfaceList;
+  typedef std::vector<Ptr<Ipv6Interface> > Ipv6InterfaceList;
+
+  /**
+   * \brief Index of the lowest interface holding each address, or each
+   * prefix of a given length.
+   */
+  typedef sgi::hash_map<Ipv6Address, uint32_t, Ipv6AddressHash> Ipv6AddressIndex;
+
+  /**
+   * \brief An entry of the address index or of a prefix index.
+   */
+  struct IndexEntry
+  {
+    Ipv6AddressIndex *index; //!< the index holding the entry
+    Ipv6Address key;         //!< the address or prefix
+    Ipv6Prefix prefix;       //!< the prefix length of the index
+  };
 
   /**
    * \brief Container of the IPv6 Raw Sockets.
@@ -453,6 +481,42 @@ private:
   Ipv6Header BuildHeader (Ipv6Address src, Ipv6Address dst, uint8_t protocol,
                           uint16_t payloadSize, uint8_t hopLimit, uint8_t tclass);
 
+  /**
+   * \brief Get the index of an interface.
+   * \param interface the interface
+   * \returns its index, or -1 if it is not one of the interfaces of this stack
+   */
+  int32_t GetInterfaceIndex (Ptr<const Ipv6Interface> interface) const;
+
+  /**
+   * \brief Notify that an address was added to an interface.
+   * \param interface the interface
+   * \param address the address
+   */
+  void NotifyAddressAdded (Ptr<const Ipv6Interface> interface, Ipv6Address address);
+
+  /**
+   * \brief Notify that an address was removed from an interface.
+   * \param interface the interface
+   * \param address the address
+   */
+  void NotifyAddressRemoved (Ptr<const Ipv6Interface> interface, Ipv6Address address);
+
+  /**
+   * \brief Add an address of an interface to the address and prefix indexes.
+   * \param index the index of the interface
+   * \param address the address
+   */
+  void IndexAddress (uint32_t index, Ipv6Address address) const;
+
+  /**
+   * \brief Get the index of the prefixes of a given length, building it
+   * the first time this length is looked up.
+   * \param prefix the prefix length
+   * \returns the index
+   */
+  Ipv6AddressIndex &GetPrefixIndex (Ipv6Prefix prefix) const;
+
   /**
    * \brief Send packet with route.
    * \param route route 
@@ -578,6 +642,21 @@ private:
    */
   uint32_t m_nInterfaces;
 
+  /**
+   * \brief Interface of each device, indexed by the device ifIndex (-1 if none).
+   */
+  std::vector<int32_t> m_deviceIndex;
+
+  /**
+   * \brief Interface of each address.
+   */
+  mutable Ipv6AddressIndex m_addressIndex;
+
+  /**
+   * \brief Interface of each prefix, for the prefix lengths looked up so far.
+   */
+  mutable std::map<uint8_t, Ipv6AddressIndex> m_prefixIndexes;
+
   /**
    * \brief Default TTL for outgoing packets.
    */
@@ -64,9 +64,10 @@ uint32_t Ipv6PmtuCache::GetPmtu (Ipv6Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
 
-  if (m_pathMtu.find (dst) != m_pathMtu.end ())
+  std::map<Ipv6Address, uint32_t>::const_iterator it = m_pathMtu.find (dst);
+  if (it != m_pathMtu.end ())
     {
-      return m_pathMtu[dst];
+      return it->second;
     }
   return 0;
 }
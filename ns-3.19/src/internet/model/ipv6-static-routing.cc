@@ -695,6 +695,7 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
       if (route.GetInterface () == i)
         {
           RemoveRoute (j);
+          max--;
         }
       else
         {
@@ -20,6 +20,8 @@
 
 #include "ns3/log.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
 #include "ns3/node.h"
 
 #include "ipv6-l3-protocol.h" 
@@ -45,6 +47,19 @@ TypeId NdiscCache::GetTypeId ()
                    UintegerValue (DEFAULT_UNRES_QLEN),
                    MakeUintegerAccessor (&NdiscCache::m_unresQlen),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("SharedTimers",
+                   "Serve the timers of all the entries with a single event per TimerGranularity slot.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NdiscCache::m_sharedTimers),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TimerGranularity",
+                   "Width of a slot of the shared timers. The timers expire at the end of their slot.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&NdiscCache::m_timerGranularity),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Drop",
+                     "Packet dropped because the queue of an entry waiting for an NA reply is full.",
+                     MakeTraceSourceAccessor (&NdiscCache::m_dropTrace))
   ;
   return tid;
 } 
@@ -64,6 +79,7 @@ void NdiscCache::DoDispose ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   Flush ();
+  m_timerEvent.Cancel ();
   m_device = 0;
   m_interface = 0;
   Object::DoDispose ();
@@ -92,10 +108,10 @@ NdiscCache::Entry* NdiscCache::Lookup (Ipv6Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
 
-  if (m_ndCache.find (dst) != m_ndCache.end ())
+  CacheI it = m_ndCache.find (dst);
+  if (it != m_ndCache.end ())
     {
-      NdiscCache::Entry* entry = m_ndCache[dst];
-      return entry;
+      return it->second;
     }
   return 0;
 }
@@ -111,19 +127,34 @@ NdiscCache::Entry* NdiscCache::Add (Ipv6Address to)
   return entry;
 }
 
+NdiscCache::Entry* NdiscCache::AddStatic (Ipv6Address to, Address mac)
+{
+  NS_LOG_FUNCTION (this << to << mac);
+
+  NdiscCache::Entry* entry = Lookup (to);
+  if (entry == 0)
+    {
+      entry = Add (to);
+    }
+  std::list<Ptr<Packet> > waiting = entry->MarkStatic (mac);
+  entry->ClearWaitingPacket ();
+  for (std::list<Ptr<Packet> >::const_iterator it = waiting.begin (); it != waiting.end (); it++)
+    {
+      m_interface->Send (*it, to);
+    }
+  return entry;
+}
+
 void NdiscCache::Remove (NdiscCache::Entry* entry)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  CacheI i = m_ndCache.find (entry->GetIpv6Address ());
+  if (i != m_ndCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
-        {
-          m_ndCache.erase (i);
-          entry->ClearWaitingPacket ();
-          delete entry;
-          return;
-        }
+      m_ndCache.erase (i);
+      entry->ClearWaitingPacket ();
+      delete entry;
     }
 }
 
@@ -137,6 +168,9 @@ void NdiscCache::Flush ()
     }
 
   m_ndCache.erase (m_ndCache.begin (), m_ndCache.end ());
+
+  m_timerSlots.clear ();
+  m_timerEvent.Cancel ();
 }
 
 void NdiscCache::SetUnresQlen (uint32_t unresQlen)
@@ -151,6 +185,67 @@ uint32_t NdiscCache::GetUnresQlen ()
   return m_unresQlen;
 }
 
+uint64_t NdiscCache::StartSharedTimer (Ipv6Address to, Entry::NdiscCacheEntryTimer_e timer, Time delay)
+{
+  NS_LOG_FUNCTION (this << to << timer << delay);
+
+  /* round up to the end of the slot, slot 0 is never used */
+  uint64_t granularity = m_timerGranularity.GetTimeStep ();
+  NS_ASSERT (granularity > 0);
+  uint64_t slot = ((Simulator::Now () + delay).GetTimeStep () + granularity - 1) / granularity;
+  if (slot == 0)
+    {
+      slot = 1;
+    }
+  m_timerSlots[slot].push_back (std::make_pair (to, timer));
+  ScheduleSharedTimers ();
+  return slot;
+}
+
+void NdiscCache::ScheduleSharedTimers ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  if (m_timerSlots.empty ())
+    {
+      return;
+    }
+  uint64_t ts = m_timerSlots.begin ()->first * m_timerGranularity.GetTimeStep ();
+  if (m_timerEvent.IsRunning () && m_timerEvent.GetTs () == ts)
+    {
+      return;
+    }
+  m_timerEvent.Cancel ();
+  m_timerEvent = Simulator::Schedule (TimeStep (ts) - Simulator::Now (), &NdiscCache::HandleSharedTimers, this);
+}
+
+void NdiscCache::HandleSharedTimers ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  uint64_t now = Simulator::Now ().GetTimeStep ();
+  uint64_t granularity = m_timerGranularity.GetTimeStep ();
+  while (!m_timerSlots.empty () && m_timerSlots.begin ()->first * granularity <= now)
+    {
+      /* the timeouts may start timers, in later slots, or flush the cache */
+      uint64_t slot = m_timerSlots.begin ()->first;
+      TimerSlot timers;
+      timers.swap (m_timerSlots.begin ()->second);
+      m_timerSlots.erase (m_timerSlots.begin ());
+
+      for (TimerSlot::const_iterator it = timers.begin (); it != timers.end (); it++)
+        {
+          /* the entry may have been removed since */
+          NdiscCache::Entry* entry = Lookup (it->first);
+          if (entry != 0)
+            {
+              entry->ExpireTimer (it->second, slot);
+            }
+        }
+    }
+  ScheduleSharedTimers ();
+}
+
 NdiscCache::Entry::Entry (NdiscCache* nd)
   : m_ndCache (nd),
     m_waiting (),
@@ -159,10 +254,15 @@ NdiscCache::Entry::Entry (NdiscCache* nd)
     m_retransTimer (Timer::CANCEL_ON_DESTROY),
     m_probeTimer (Timer::CANCEL_ON_DESTROY),
     m_delayTimer (Timer::CANCEL_ON_DESTROY),
+    m_static (false),
     m_lastReachabilityConfirmation (Seconds (0.0)),
     m_nsRetransmit (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+      m_timerSlot[i] = 0;
+    }
 }
 
 void NdiscCache::Entry::SetRouter (bool router)
@@ -181,11 +281,17 @@ void NdiscCache::Entry::AddWaitingPacket (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << p);
 
-  if (m_waiting.size () >= m_ndCache->GetUnresQlen ())
+  uint32_t unresQlen = m_ndCache->GetUnresQlen ();
+  if (unresQlen == 0)
+    {
+      m_ndCache->m_dropTrace (p);
+      return;
+    }
+  if (m_waiting.size () >= unresQlen)
     {
       /* we store only m_unresQlen packet => first packet in first packet remove */
-      /** \todo report packet as 'dropped' */
-      m_waiting.remove (0);
+      m_ndCache->m_dropTrace (m_waiting.front ());
+      m_waiting.pop_front ();
     }
   m_waiting.push_back (p);
 }
@@ -337,6 +443,12 @@ void NdiscCache::Entry::SetIpv6Address (Ipv6Address ipv6Address)
   m_ipv6Address = ipv6Address;
 }
 
+Ipv6Address NdiscCache::Entry::GetIpv6Address () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ipv6Address;
+}
+
 uint8_t NdiscCache::Entry::GetNSRetransmit () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -366,32 +478,123 @@ void NdiscCache::Entry::UpdateLastReachabilityconfirmation ()
   NS_LOG_FUNCTION_NOARGS ();
 }
 
+void NdiscCache::Entry::StartTimer (NdiscCacheEntryTimer_e timer, Time delay)
+{
+  NS_LOG_FUNCTION (this << timer << delay);
+
+  if (m_static)
+    {
+      /* no Neighbor Unreachability Detection */
+      return;
+    }
+  if (m_ndCache->m_sharedTimers)
+    {
+      m_timerSlot[timer] = m_ndCache->StartSharedTimer (m_ipv6Address, timer, delay);
+      return;
+    }
+  switch (timer)
+    {
+    case REACHABLE_TIMER:
+      m_reachableTimer.SetFunction (&NdiscCache::Entry::FunctionReachableTimeout, this);
+      m_reachableTimer.SetDelay (delay);
+      m_reachableTimer.Schedule ();
+      break;
+    case RETRANSMIT_TIMER:
+      m_retransTimer.SetFunction (&NdiscCache::Entry::FunctionRetransmitTimeout, this);
+      m_retransTimer.SetDelay (delay);
+      m_retransTimer.Schedule ();
+      break;
+    case PROBE_TIMER:
+      m_probeTimer.SetFunction (&NdiscCache::Entry::FunctionProbeTimeout, this);
+      m_probeTimer.SetDelay (delay);
+      m_probeTimer.Schedule ();
+      break;
+    case DELAY_TIMER:
+      m_delayTimer.SetFunction (&NdiscCache::Entry::FunctionDelayTimeout, this);
+      m_delayTimer.SetDelay (delay);
+      m_delayTimer.Schedule ();
+      break;
+    default:
+      NS_ASSERT_MSG (false, "Unknown timer " << timer);
+    }
+}
+
+void NdiscCache::Entry::StopTimer (NdiscCacheEntryTimer_e timer)
+{
+  NS_LOG_FUNCTION (this << timer);
+
+  /* the slot is left as is, the expiration is ignored */
+  m_timerSlot[timer] = 0;
+  switch (timer)
+    {
+    case REACHABLE_TIMER:
+      m_reachableTimer.Cancel ();
+      break;
+    case RETRANSMIT_TIMER:
+      m_retransTimer.Cancel ();
+      break;
+    case PROBE_TIMER:
+      m_probeTimer.Cancel ();
+      break;
+    case DELAY_TIMER:
+      m_delayTimer.Cancel ();
+      break;
+    default:
+      NS_ASSERT_MSG (false, "Unknown timer " << timer);
+    }
+}
+
+void NdiscCache::Entry::ExpireTimer (NdiscCacheEntryTimer_e timer, uint64_t slot)
+{
+  NS_LOG_FUNCTION (this << timer << slot);
+
+  if (m_timerSlot[timer] != slot)
+    {
+      /* stopped or restarted since */
+      return;
+    }
+  m_timerSlot[timer] = 0;
+  switch (timer)
+    {
+    case REACHABLE_TIMER:
+      FunctionReachableTimeout ();
+      break;
+    case RETRANSMIT_TIMER:
+      FunctionRetransmitTimeout ();
+      break;
+    case PROBE_TIMER:
+      FunctionProbeTimeout ();
+      break;
+    case DELAY_TIMER:
+      FunctionDelayTimeout ();
+      break;
+    default:
+      NS_ASSERT_MSG (false, "Unknown timer " << timer);
+    }
+}
+
 void NdiscCache::Entry::StartReachableTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_reachableTimer.SetFunction (&NdiscCache::Entry::FunctionReachableTimeout, this);
-  m_reachableTimer.SetDelay (MilliSeconds (Icmpv6L4Protocol::REACHABLE_TIME));
-  m_reachableTimer.Schedule ();
+  StartTimer (REACHABLE_TIMER, MilliSeconds (Icmpv6L4Protocol::REACHABLE_TIME));
 }
 
 void NdiscCache::Entry::StopReachableTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_reachableTimer.Cancel ();
+  StopTimer (REACHABLE_TIMER);
 }
 
 void NdiscCache::Entry::StartProbeTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_probeTimer.SetFunction (&NdiscCache::Entry::FunctionProbeTimeout, this);
-  m_probeTimer.SetDelay (MilliSeconds (Icmpv6L4Protocol::RETRANS_TIMER));
-  m_probeTimer.Schedule ();
+  StartTimer (PROBE_TIMER, MilliSeconds (Icmpv6L4Protocol::RETRANS_TIMER));
 }
 
 void NdiscCache::Entry::StopProbeTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_probeTimer.Cancel ();
+  StopTimer (PROBE_TIMER);
   ResetNSRetransmit ();
 }
 
@@ -399,47 +602,51 @@ void NdiscCache::Entry::StopProbeTimer ()
 void NdiscCache::Entry::StartDelayTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_delayTimer.SetFunction (&NdiscCache::Entry::FunctionDelayTimeout, this);
-  m_delayTimer.SetDelay (Seconds (Icmpv6L4Protocol::DELAY_FIRST_PROBE_TIME));
-  m_delayTimer.Schedule ();
+  StartTimer (DELAY_TIMER, Seconds (Icmpv6L4Protocol::DELAY_FIRST_PROBE_TIME));
 }
 
 void NdiscCache::Entry::StopDelayTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_delayTimer.Cancel ();
+  StopTimer (DELAY_TIMER);
   ResetNSRetransmit ();
 }
 
 void NdiscCache::Entry::StartRetransmitTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_retransTimer.SetFunction (&NdiscCache::Entry::FunctionRetransmitTimeout, this);
-  m_retransTimer.SetDelay (MilliSeconds (Icmpv6L4Protocol::RETRANS_TIMER));
-  m_retransTimer.Schedule ();
+  StartTimer (RETRANSMIT_TIMER, MilliSeconds (Icmpv6L4Protocol::RETRANS_TIMER));
 }
 
 void NdiscCache::Entry::StopRetransmitTimer ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_retransTimer.Cancel ();
+  StopTimer (RETRANSMIT_TIMER);
   ResetNSRetransmit ();
 }
 
 void NdiscCache::Entry::MarkIncomplete (Ptr<Packet> p)
 {
   NS_LOG_FUNCTION (this << p);
+  if (m_static)
+    {
+      return;
+    }
   m_state = INCOMPLETE;
 
   if (p)
     {
-      m_waiting.push_back (p);
+      AddWaitingPacket (p);
     }
 }
 
 std::list<Ptr<Packet> > NdiscCache::Entry::MarkReachable (Address mac)
 {
   NS_LOG_FUNCTION (this << mac);
+  if (m_static)
+    {
+      return m_waiting;
+    }
   m_state = REACHABLE;
   m_macAddress = mac;
   return m_waiting;
@@ -448,12 +655,20 @@ std::list<Ptr<Packet> > NdiscCache::Entry::MarkReachable (Address mac)
 void NdiscCache::Entry::MarkProbe ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (m_static)
+    {
+      return;
+    }
   m_state = PROBE;
 }
 
 void NdiscCache::Entry::MarkStale ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (m_static)
+    {
+      return;
+    }
   m_state = STALE;
 }
 
@@ -466,6 +681,10 @@ void NdiscCache::Entry::MarkReachable ()
 std::list<Ptr<Packet> > NdiscCache::Entry::MarkStale (Address mac)
 {
   NS_LOG_FUNCTION (this << mac);
+  if (m_static)
+    {
+      return m_waiting;
+    }
   m_state = STALE;
   m_macAddress = mac;
   return m_waiting;
@@ -474,9 +693,27 @@ std::list<Ptr<Packet> > NdiscCache::Entry::MarkStale (Address mac)
 void NdiscCache::Entry::MarkDelay ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (m_static)
+    {
+      return;
+    }
   m_state = DELAY;
 }
 
+std::list<Ptr<Packet> > NdiscCache::Entry::MarkStatic (Address mac)
+{
+  NS_LOG_FUNCTION (this << mac);
+  for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+      StopTimer (static_cast<NdiscCacheEntryTimer_e> (i));
+    }
+  ResetNSRetransmit ();
+  m_static = true;
+  m_state = REACHABLE;
+  m_macAddress = mac;
+  return m_waiting;
+}
+
 bool NdiscCache::Entry::IsStale () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -507,6 +744,12 @@ bool NdiscCache::Entry::IsProbe () const
   return (m_state == PROBE);
 }
 
+bool NdiscCache::Entry::IsStatic () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_static;
+}
+
 Address NdiscCache::Entry::GetMacAddress () const
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -516,6 +759,10 @@ Address NdiscCache::Entry::GetMacAddress () const
 void NdiscCache::Entry::SetMacAddress (Address mac)
 {
   NS_LOG_FUNCTION (this << mac);
+  if (m_static)
+    {
+      return;
+    }
   m_macAddress = mac;
 }
 
@@ -24,6 +24,8 @@
 #include <stdint.h>
 
 #include <list>
+#include <map>
+#include <vector>
 
 #include "ns3/packet.h"
 #include "ns3/nstime.h"
@@ -31,7 +33,9 @@
 #include "ns3/ipv6-address.h"
 #include "ns3/ptr.h"
 #include "ns3/timer.h"
+#include "ns3/event-id.h"
 #include "ns3/sgi-hashmap.h"
+#include "ns3/traced-callback.h"
 
 namespace ns3
 {
@@ -42,6 +46,16 @@ class Ipv6Interface;
 /**
  * \class NdiscCache
  * \brief IPv6 Neighbor Discovery cache.
+ *
+ * By default every entry runs its own timers. With the SharedTimers
+ * attribute set, the timers of all the entries are rounded up to a
+ * multiple of TimerGranularity and served together by a single event per
+ * slot, which keeps the number of scheduled events low on links with many
+ * neighbors.
+ *
+ * Static entries, added with AddStatic (), never go through the Neighbor
+ * Unreachability Detection and are not changed by the Neighbor Discovery
+ * messages received.
  */
 class NdiscCache : public Object
 {
@@ -94,6 +108,19 @@ public:
    */
   NdiscCache::Entry* Add (Ipv6Address to);
 
+  /**
+   * \brief Add a static entry.
+   *
+   * The entry stays REACHABLE without any NS/NA exchange. An existing entry
+   * for the address is turned into a static one, and the packets waiting
+   * for its resolution are sent.
+   *
+   * \param to address to add
+   * \param mac the L2 address of the neighbor
+   * \return the static Entry
+   */
+  NdiscCache::Entry* AddStatic (Ipv6Address to, Address mac);
+
   /**
    * \brief Delete an entry.
    * \param entry pointer to delete from the list.
@@ -101,7 +128,7 @@ public:
   void Remove (NdiscCache::Entry* entry);
 
   /**
-   * \brief Flush the cache.
+   * \brief Flush the cache, static entries included.
    */
   void Flush ();
 
@@ -137,6 +164,18 @@ public:
      */
     Entry (NdiscCache* nd);
 
+    /**
+     * \brief The Entry timers.
+     */
+    enum NdiscCacheEntryTimer_e
+    {
+      REACHABLE_TIMER, /**< Reachable timer */
+      RETRANSMIT_TIMER, /**< Retransmission timer */
+      PROBE_TIMER, /**< Probe timer */
+      DELAY_TIMER, /**< Delay timer */
+      TIMER_COUNT /**< Number of timers */
+    };
+
     /**
      * \brief Changes the state to this entry to INCOMPLETE.
      * \param p packet that wait to be sent
@@ -177,6 +216,13 @@ public:
      */
     void MarkDelay ();
 
+    /**
+     * \brief Make this entry static and REACHABLE.
+     * \param mac L2 address
+     * \return the list of packet waiting
+     */
+    std::list<Ptr<Packet> > MarkStatic (Address mac);
+
     /**
      * \brief Add a packet (or replace old value) in the queue.
      * \param p packet to add
@@ -218,6 +264,12 @@ public:
      */
     bool IsProbe () const;
 
+    /**
+     * \brief Is the entry static
+     * \return true if the entry was added with NdiscCache::AddStatic ()
+     */
+    bool IsStatic () const;
+
     /**
      * \brief Get the MAC address of this entry.
      * \return the L2 address
@@ -337,7 +389,34 @@ public:
      */
     void SetIpv6Address (Ipv6Address ipv6Address);
 
+    /**
+     * \brief Get the IPv6 address.
+     * \return the IPv6 address
+     */
+    Ipv6Address GetIpv6Address () const;
+
+    /**
+     * \brief Function called when a timer served by the shared timers of
+     * the cache expires.
+     * \param timer the timer
+     * \param slot the slot served
+     */
+    void ExpireTimer (NdiscCacheEntryTimer_e timer, uint64_t slot);
+
 private:
+    /**
+     * \brief Start a timer.
+     * \param timer the timer
+     * \param delay the delay before it expires
+     */
+    void StartTimer (NdiscCacheEntryTimer_e timer, Time delay);
+
+    /**
+     * \brief Stop a timer.
+     * \param timer the timer
+     */
+    void StopTimer (NdiscCacheEntryTimer_e timer);
+
     /**
      * \brief The IPv6 address.
      */
@@ -400,6 +479,16 @@ private:
      */
     Timer m_delayTimer;
 
+    /**
+     * \brief Slot of each timer with the shared timers, 0 if not running.
+     */
+    uint64_t m_timerSlot[TIMER_COUNT];
+
+    /**
+     * \brief Whether the entry is static.
+     */
+    bool m_static;
+
     /**
      * \brief Last time we see a reachability confirmation.
      */
@@ -441,6 +530,25 @@ private:
    */
   void DoDispose ();
 
+  /**
+   * \brief Start a timer of an entry in the shared timers.
+   * \param to the address of the entry
+   * \param timer the timer
+   * \param delay the delay before the timer expires
+   * \return the slot the timer expires in
+   */
+  uint64_t StartSharedTimer (Ipv6Address to, Entry::NdiscCacheEntryTimer_e timer, Time delay);
+
+  /**
+   * \brief Serve the shared timers of the elapsed slots.
+   */
+  void HandleSharedTimers ();
+
+  /**
+   * \brief Schedule the event serving the first slot of the shared timers.
+   */
+  void ScheduleSharedTimers ();
+
   /**
    * \brief The NetDevice.
    */
@@ -460,6 +568,36 @@ private:
    * \brief Max number of packet stored in m_waiting.
    */
   uint32_t m_unresQlen;
+
+  /**
+   * \brief Whether the entries share the timers of the cache.
+   */
+  bool m_sharedTimers;
+
+  /**
+   * \brief Width of a slot of the shared timers.
+   */
+  Time m_timerGranularity;
+
+  /**
+   * \brief Timers of one slot: entry address and timer.
+   */
+  typedef std::vector<std::pair<Ipv6Address, Entry::NdiscCacheEntryTimer_e> > TimerSlot;
+
+  /**
+   * \brief Shared timers, by slot.
+   */
+  std::map<uint64_t, TimerSlot> m_timerSlots;
+
+  /**
+   * \brief Event serving the first slot of the shared timers.
+   */
+  EventId m_timerEvent;
+
+  /**
+   * \brief Trace of the packets dropped because the queue of an entry is full.
+   */
+  TracedCallback<Ptr<const Packet> > m_dropTrace;
 };
 
 } /* namespace ns3 */
@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "tcp-congestion-ops.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+
+NS_LOG_COMPONENT_DEFINE ("TcpCongestionOps");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TcpCongestionOps)
+  ;
+
+TypeId
+TcpCongestionOps::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpCongestionOps")
+    .SetParent<Object> ()
+  ;
+  return tid;
+}
+
+TcpCongestionOps::TcpCongestionOps ()
+{
+}
+
+TcpCongestionOps::TcpCongestionOps (const TcpCongestionOps &other)
+  : Object (other)
+{
+}
+
+TcpCongestionOps::~TcpCongestionOps ()
+{
+}
+
+void
+TcpCongestionOps::PktsAcked (uint32_t bytesAcked, const Time &rtt)
+{
+}
+
+void
+TcpCongestionOps::Timeout (void)
+{
+}
+
+uint64_t
+TcpCongestionOps::GetPacingRate (uint32_t cWnd, uint32_t ssThresh, const Time &srtt) const
+{
+  if (!srtt.IsStrictlyPositive ())
+    { // No RTT to spread the window over
+      return 0;
+    }
+  double factor = cWnd < ssThresh ? 2.0 : 1.2;
+  return static_cast<uint64_t> (factor * cWnd * 8 / srtt.GetSeconds ());
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TcpNewRenoOps)
+  ;
+
+TypeId
+TcpNewRenoOps::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpNewRenoOps")
+    .SetParent<TcpCongestionOps> ()
+    .AddConstructor<TcpNewRenoOps> ()
+  ;
+  return tid;
+}
+
+TcpNewRenoOps::TcpNewRenoOps ()
+{
+}
+
+TcpNewRenoOps::TcpNewRenoOps (const TcpNewRenoOps &other)
+  : TcpCongestionOps (other)
+{
+}
+
+TcpNewRenoOps::~TcpNewRenoOps ()
+{
+}
+
+std::string
+TcpNewRenoOps::GetName (void) const
+{
+  return "TcpNewReno";
+}
+
+uint32_t
+TcpNewRenoOps::IncreaseWindow (uint32_t cWnd, uint32_t ssThresh,
+                               uint32_t segmentSize, uint32_t bytesAcked)
+{
+  if (cWnd < ssThresh)
+    { // Slow start mode, add one segSize to cWnd (RFC2001, sec.1)
+      return cWnd + segmentSize;
+    }
+  // Congestion avoidance mode, increase by (segSize*segSize)/cwnd (RFC2581, sec.3.1)
+  double adder = static_cast<double> (segmentSize * segmentSize) / cWnd;
+  adder = std::max (1.0, adder);
+  return cWnd + static_cast<uint32_t> (adder);
+}
+
+uint32_t
+TcpNewRenoOps::GetSsThresh (uint32_t cWnd, uint32_t bytesInFlight,
+                            uint32_t segmentSize)
+{
+  // Half of the flight size (RFC2581, sec.3.1)
+  return std::max (2 * segmentSize, bytesInFlight / 2);
+}
+
+Ptr<TcpCongestionOps>
+TcpNewRenoOps::Copy (void) const
+{
+  return CopyObject<TcpNewRenoOps> (this);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (TcpCubic)
+  ;
+
+TypeId
+TcpCubic::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpCubic")
+    .SetParent<TcpCongestionOps> ()
+    .AddConstructor<TcpCubic> ()
+    .AddAttribute ("C", "Scaling constant of the cubic function, in segments per second cubed",
+                   DoubleValue (0.4),
+                   MakeDoubleAccessor (&TcpCubic::m_c),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("Beta", "Multiplicative decrease factor of the window on a loss",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&TcpCubic::m_beta),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("FastConvergence", "Release bandwidth to new flows by lowering Wmax when the window shrinks",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_fastConvergence),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TcpFriendliness", "Grow the window at least as fast as NewReno would",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpCubic::m_tcpFriendliness),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+TcpCubic::TcpCubic ()
+  : m_c (0.4), // mute valgrind, actual value set by the attribute system
+    m_beta (0.7),
+    m_fastConvergence (true),
+    m_tcpFriendliness (true),
+    m_minRtt (Seconds (0))
+{
+  NS_LOG_FUNCTION (this);
+  Reset ();
+}
+
+TcpCubic::TcpCubic (const TcpCubic &other)
+  : TcpCongestionOps (other),
+    m_c (other.m_c),
+    m_beta (other.m_beta),
+    m_fastConvergence (other.m_fastConvergence),
+    m_tcpFriendliness (other.m_tcpFriendliness),
+    m_wMax (other.m_wMax),
+    m_epochStart (other.m_epochStart),
+    m_k (other.m_k),
+    m_origin (other.m_origin),
+    m_wEst (other.m_wEst),
+    m_cWndCnt (other.m_cWndCnt),
+    m_minRtt (other.m_minRtt)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpCubic::~TcpCubic ()
+{
+}
+
+std::string
+TcpCubic::GetName (void) const
+{
+  return "TcpCubic";
+}
+
+void
+TcpCubic::Reset (void)
+{
+  m_wMax = 0;
+  m_epochStart = Seconds (-1);
+  m_k = 0;
+  m_origin = 0;
+  m_wEst = 0;
+  m_cWndCnt = 0;
+}
+
+uint32_t
+TcpCubic::IncreaseWindow (uint32_t cWnd, uint32_t ssThresh,
+                          uint32_t segmentSize, uint32_t bytesAcked)
+{
+  NS_LOG_FUNCTION (this << cWnd << ssThresh << segmentSize << bytesAcked);
+  if (cWnd < ssThresh)
+    { // Slow start, as NewReno
+      return cWnd + segmentSize;
+    }
+
+  double w = static_cast<double> (cWnd) / segmentSize;
+  double acked = static_cast<double> (bytesAcked) / segmentSize;
+  Time now = Simulator::Now ();
+  if (m_epochStart.IsStrictlyNegative ())
+    { // First ACK in congestion avoidance since the loss (RFC8312, sec.4.1)
+      m_epochStart = now;
+      m_cWndCnt = 0;
+      if (w < m_wMax)
+        {
+          m_k = std::pow ((m_wMax - w) / m_c, 1.0 / 3.0);
+          m_origin = m_wMax;
+        }
+      else
+        {
+          m_k = 0;
+          m_origin = w;
+        }
+      m_wEst = w;
+      NS_LOG_LOGIC ("New epoch: Wmax " << m_wMax << " K " << m_k);
+    }
+
+  // Target of the window one RTT from now
+  double t = (now + m_minRtt - m_epochStart).GetSeconds ();
+  double target = m_origin + m_c * std::pow (t - m_k, 3);
+  if (m_tcpFriendliness)
+    { // Window NewReno would have with the same multiplicative decrease (RFC8312, sec.4.2)
+      m_wEst += 3 * (1 - m_beta) / (1 + m_beta) * acked / w;
+      target = std::max (target, m_wEst);
+    }
+
+  double increase;
+  if (target > w)
+    { // Reach the target in one RTT, but do not grow faster than slow start would
+      increase = std::min ((target - w) / w, 0.5) * acked;
+    }
+  else
+    { // Plateau: a segment every hundred RTTs
+      increase = 0.01 * acked / w;
+    }
+  m_cWndCnt += increase * segmentSize;
+  uint32_t adder = static_cast<uint32_t> (m_cWndCnt);
+  m_cWndCnt -= adder;
+  return cWnd + adder;
+}
+
+uint32_t
+TcpCubic::GetSsThresh (uint32_t cWnd, uint32_t bytesInFlight,
+                       uint32_t segmentSize)
+{
+  NS_LOG_FUNCTION (this << cWnd << bytesInFlight << segmentSize);
+  double w = static_cast<double> (cWnd) / segmentSize;
+  if (m_fastConvergence && w < m_wMax)
+    { // The available bandwidth shrank: leave some to the others (RFC8312, sec.4.6)
+      m_wMax = w * (1 + m_beta) / 2;
+    }
+  else
+    {
+      m_wMax = w;
+    }
+  m_epochStart = Seconds (-1);
+  return std::max (2 * segmentSize, static_cast<uint32_t> (cWnd * m_beta));
+}
+
+void
+TcpCubic::PktsAcked (uint32_t bytesAcked, const Time &rtt)
+{
+  if (rtt.IsStrictlyPositive () && (m_minRtt.IsZero () || rtt < m_minRtt))
+    {
+      m_minRtt = rtt;
+    }
+}
+
+void
+TcpCubic::Timeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The window starts over from slow start (RFC8312, sec.4.7)
+  Reset ();
+}
+
+Ptr<TcpCongestionOps>
+TcpCubic::Copy (void) const
+{
+  return CopyObject<TcpCubic> (this);
+}
+
+} // namespace ns3
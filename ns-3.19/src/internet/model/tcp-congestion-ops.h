@@ -0,0 +1,217 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_CONGESTION_OPS_H
+#define TCP_CONGESTION_OPS_H
+
+#include <string>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Congestion control algorithm of a TCP socket
+ *
+ * The socket keeps the loss detection and the recovery; the algorithm
+ * decides how the congestion window grows with the acknowledgements, where
+ * the slow start threshold falls after a loss, and at which rate the
+ * segments are paced. TcpL4Protocol gives a new instance, of the type set
+ * by its CongestionOpsType attribute, to every socket it creates; a
+ * connection accepted by a listening socket gets a copy of it.
+ * TcpNewReno, TcpReno and TcpTahoe use it. TcpWestwood and TcpRfc793
+ * only accept the default TcpNewRenoOps, which they ignore.
+ */
+class TcpCongestionOps : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpCongestionOps ();
+  /**
+   * \brief Copy constructor
+   * \param other the object to copy
+   */
+  TcpCongestionOps (const TcpCongestionOps &other);
+  virtual ~TcpCongestionOps ();
+
+  /**
+   * \brief Get the name of the algorithm
+   * \returns the name
+   */
+  virtual std::string GetName (void) const = 0;
+
+  /**
+   * \brief Get the congestion window after an ACK of new data
+   * \param cWnd the congestion window, in bytes
+   * \param ssThresh the slow start threshold, in bytes
+   * \param segmentSize the segment size
+   * \param bytesAcked the number of bytes newly acknowledged
+   * \returns the new congestion window, in bytes
+   */
+  virtual uint32_t IncreaseWindow (uint32_t cWnd, uint32_t ssThresh,
+                                   uint32_t segmentSize, uint32_t bytesAcked) = 0;
+
+  /**
+   * \brief Get the slow start threshold after a loss
+   * \param cWnd the congestion window, in bytes
+   * \param bytesInFlight the bytes sent and not yet acknowledged
+   * \param segmentSize the segment size
+   * \returns the new slow start threshold, in bytes
+   */
+  virtual uint32_t GetSsThresh (uint32_t cWnd, uint32_t bytesInFlight,
+                                uint32_t segmentSize) = 0;
+
+  /**
+   * \brief Note the ACK of new data
+   *
+   * Called by TcpSocketBase::ReceivedAck () for every ACK moving the left
+   * edge of the window, before the socket updates its window.
+   *
+   * \param bytesAcked the number of bytes newly acknowledged
+   * \param rtt the last RTT sample
+   */
+  virtual void PktsAcked (uint32_t bytesAcked, const Time &rtt);
+
+  /**
+   * \brief Note a retransmission timeout
+   *
+   * Called after GetSsThresh (), when the window restarts from one segment.
+   */
+  virtual void Timeout (void);
+
+  /**
+   * \brief Get the rate at which a socket with pacing enabled sends
+   *
+   * The default paces the window over the smoothed RTT, twice as fast in
+   * slow start and with a 20% margin in congestion avoidance, so that the
+   * pacing does not limit the growth of the window.
+   *
+   * \param cWnd the window the socket may have in flight, in bytes
+   * \param ssThresh the slow start threshold, in bytes
+   * \param srtt the smoothed RTT
+   * \returns the pacing rate in bit/s, or zero to send back-to-back
+   */
+  virtual uint64_t GetPacingRate (uint32_t cWnd, uint32_t ssThresh, const Time &srtt) const;
+
+  /**
+   * \brief Copy the algorithm and its state, for a forked socket
+   * \returns the copy
+   */
+  virtual Ptr<TcpCongestionOps> Copy (void) const = 0;
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief The NewReno window update (RFC 2581, RFC 2582)
+ *
+ * Slow start adds one segment per ACK, congestion avoidance
+ * segmentSize*segmentSize/cwnd bytes per ACK, and a loss halves the
+ * bytes in flight.
+ */
+class TcpNewRenoOps : public TcpCongestionOps
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpNewRenoOps ();
+  /**
+   * \brief Copy constructor
+   * \param other the object to copy
+   */
+  TcpNewRenoOps (const TcpNewRenoOps &other);
+  virtual ~TcpNewRenoOps ();
+
+  virtual std::string GetName (void) const;
+  virtual uint32_t IncreaseWindow (uint32_t cWnd, uint32_t ssThresh,
+                                   uint32_t segmentSize, uint32_t bytesAcked);
+  virtual uint32_t GetSsThresh (uint32_t cWnd, uint32_t bytesInFlight,
+                                uint32_t segmentSize);
+  virtual Ptr<TcpCongestionOps> Copy (void) const;
+};
+
+/**
+ * \ingroup tcp
+ *
+ * \brief The CUBIC window update (RFC 8312)
+ *
+ * After a loss, the window follows W(t) = C*(t-K)^3 + Wmax, where Wmax is
+ * the window at the loss and K the time to grow back to it: the window
+ * climbs quickly towards Wmax, plateaus around it, then probes beyond it.
+ * The growth is independent of the RTT, which keeps the bandwidth of long
+ * fat links in use. Where NewReno would grow faster (short RTT, small
+ * windows), the window follows the NewReno estimate instead.
+ */
+class TcpCubic : public TcpCongestionOps
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpCubic ();
+  /**
+   * \brief Copy constructor
+   * \param other the object to copy
+   */
+  TcpCubic (const TcpCubic &other);
+  virtual ~TcpCubic ();
+
+  virtual std::string GetName (void) const;
+  virtual uint32_t IncreaseWindow (uint32_t cWnd, uint32_t ssThresh,
+                                   uint32_t segmentSize, uint32_t bytesAcked);
+  virtual uint32_t GetSsThresh (uint32_t cWnd, uint32_t bytesInFlight,
+                                uint32_t segmentSize);
+  virtual void PktsAcked (uint32_t bytesAcked, const Time &rtt);
+  virtual void Timeout (void);
+  virtual Ptr<TcpCongestionOps> Copy (void) const;
+
+private:
+  /**
+   * \brief Restart the window growth from scratch
+   */
+  void Reset (void);
+
+  double m_c;               //!< Scaling constant C of the cubic function
+  double m_beta;            //!< Multiplicative decrease factor
+  bool   m_fastConvergence; //!< Lower Wmax when the window shrinks between losses
+  bool   m_tcpFriendliness; //!< Grow at least as fast as NewReno
+
+  double m_wMax;       //!< Window at the last loss, in segments (Wmax)
+  Time   m_epochStart; //!< Start of the current growth epoch, negative outside
+  double m_k;          //!< Time from the epoch start to Wmax, in seconds
+  double m_origin;     //!< Window the cubic function plateaus at, in segments
+  double m_wEst;       //!< NewReno window estimate, in segments
+  double m_cWndCnt;    //!< Growth not yet added to the window, in bytes
+  Time   m_minRtt;     //!< Smallest RTT sample, zero without sample
+};
+
+} // namespace ns3
+
+#endif /* TCP_CONGESTION_OPS_H */
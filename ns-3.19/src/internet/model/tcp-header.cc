@@ -29,6 +29,17 @@ namespace ns3 {
 NS_OBJECT_ENSURE_REGISTERED (TcpHeader)
   ;
 
+const uint32_t TcpHeader::MAX_SACK_BLOCKS;
+
+/// TCP option kinds (RFC 793, RFC 2018)
+enum
+{
+  OPTION_END = 0,
+  OPTION_NOP = 1,
+  OPTION_SACK_PERMITTED = 4,
+  OPTION_SACK = 5
+};
+
 TcpHeader::TcpHeader ()
   : m_sourcePort (0),
     m_destinationPort (0),
@@ -38,6 +49,7 @@ TcpHeader::TcpHeader ()
     m_flags (0),
     m_windowSize (0xffff),
     m_urgentPointer (0),
+    m_sackPermitted (false),
     m_calcChecksum (false),
     m_goodChecksum (true)
 {
@@ -119,6 +131,56 @@ uint16_t TcpHeader::GetUrgentPointer () const
   return m_urgentPointer;
 }
 
+void
+TcpHeader::SetSackPermitted (bool permitted)
+{
+  m_sackPermitted = permitted;
+  UpdateLength ();
+}
+bool
+TcpHeader::IsSackPermitted (void) const
+{
+  return m_sackPermitted;
+}
+bool
+TcpHeader::AddSackBlock (const SackBlock &block)
+{
+  if (m_sackBlocks.size () >= MAX_SACK_BLOCKS)
+    {
+      return false;
+    }
+  m_sackBlocks.push_back (block);
+  UpdateLength ();
+  return true;
+}
+void
+TcpHeader::ClearSackBlocks (void)
+{
+  m_sackBlocks.clear ();
+  UpdateLength ();
+}
+const TcpHeader::SackList &
+TcpHeader::GetSackBlocks (void) const
+{
+  return m_sackBlocks;
+}
+
+void
+TcpHeader::UpdateLength (void)
+{
+  // Each option is preceded by two NOPs, so that it ends on a word boundary
+  uint32_t options = 0;
+  if (m_sackPermitted)
+    {
+      options += 4;
+    }
+  if (!m_sackBlocks.empty ())
+    {
+      options += 4 + 8 * m_sackBlocks.size ();
+    }
+  m_length = 5 + options / 4;
+}
+
 void 
 TcpHeader::InitializeChecksum (Ipv4Address source, 
                                Ipv4Address destination,
@@ -253,6 +315,18 @@ void TcpHeader::Print (std::ostream &os)  const
       os<<"]";
     }
   os<<" Seq="<<m_sequenceNumber<<" Ack="<<m_ackNumber<<" Win="<<m_windowSize;
+  if (m_sackPermitted)
+    {
+      os<<" SackPermitted";
+    }
+  if (!m_sackBlocks.empty ())
+    {
+      os<<" Sack=";
+      for (SackList::const_iterator it = m_sackBlocks.begin (); it != m_sackBlocks.end (); ++it)
+        {
+          os<<"["<<it->first<<","<<it->second<<")";
+        }
+    }
 }
 uint32_t TcpHeader::GetSerializedSize (void)  const
 {
@@ -270,6 +344,33 @@ void TcpHeader::Serialize (Buffer::Iterator start)  const
   i.WriteHtonU16 (0);
   i.WriteHtonU16 (m_urgentPointer);
 
+  uint32_t optionsSize = 4*m_length - 20;
+  if (m_sackPermitted && optionsSize >= 4)
+    {
+      i.WriteU8 (OPTION_NOP);
+      i.WriteU8 (OPTION_NOP);
+      i.WriteU8 (OPTION_SACK_PERMITTED);
+      i.WriteU8 (2);
+      optionsSize -= 4;
+    }
+  if (!m_sackBlocks.empty () && optionsSize >= 4 + 8 * m_sackBlocks.size ())
+    {
+      i.WriteU8 (OPTION_NOP);
+      i.WriteU8 (OPTION_NOP);
+      i.WriteU8 (OPTION_SACK);
+      i.WriteU8 (2 + 8 * m_sackBlocks.size ());
+      for (SackList::const_iterator it = m_sackBlocks.begin (); it != m_sackBlocks.end (); ++it)
+        {
+          i.WriteHtonU32 (it->first.GetValue ());
+          i.WriteHtonU32 (it->second.GetValue ());
+        }
+      optionsSize -= 4 + 8 * m_sackBlocks.size ();
+    }
+  for (; optionsSize > 0; optionsSize--)
+    { // Pad a header length set by hand with end of option list
+      i.WriteU8 (OPTION_END);
+    }
+
   if(m_calcChecksum)
     {
       uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
@@ -295,6 +396,49 @@ uint32_t TcpHeader::Deserialize (Buffer::Iterator start)
   i.Next (2);
   m_urgentPointer = i.ReadNtohU16 ();
 
+  m_sackPermitted = false;
+  m_sackBlocks.clear ();
+  uint32_t optionsSize = m_length > 5 ? 4*m_length - 20 : 0;
+  while (optionsSize > 0)
+    {
+      uint8_t kind = i.ReadU8 ();
+      optionsSize--;
+      if (kind == OPTION_END)
+        {
+          break;
+        }
+      if (kind == OPTION_NOP)
+        {
+          continue;
+        }
+      if (optionsSize == 0)
+        {
+          break;
+        }
+      uint8_t size = i.ReadU8 ();
+      optionsSize--;
+      if (size < 2 || size - 2u > optionsSize)
+        { // Malformed option, ignore the rest
+          break;
+        }
+      uint32_t skip = size - 2;
+      if (kind == OPTION_SACK_PERMITTED && size == 2)
+        {
+          m_sackPermitted = true;
+        }
+      else if (kind == OPTION_SACK && skip % 8 == 0)
+        {
+          for (; skip > 0; skip -= 8)
+            {
+              SequenceNumber32 left (i.ReadNtohU32 ());
+              SequenceNumber32 right (i.ReadNtohU32 ());
+              m_sackBlocks.push_back (SackBlock (left, right));
+            }
+        }
+      i.Next (skip);
+      optionsSize -= size - 2;
+    }
+
   if(m_calcChecksum)
     {
       uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
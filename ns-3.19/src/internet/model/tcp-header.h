@@ -22,6 +22,8 @@
 #define TCP_HEADER_H
 
 #include <stdint.h>
+#include <list>
+#include <utility>
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "ns3/tcp-socket-factory.h"
@@ -38,6 +40,10 @@ namespace ns3 {
  * This class has fields corresponding to those in a network TCP header
  * (port numbers, sequence and acknowledgement numbers, flags, etc) as well
  * as methods for serialization to and deserialization from a byte buffer.
+ *
+ * The only options understood are SACK-permitted and SACK (RFC 2018); the
+ * header length follows the options set, and the other options of a
+ * received header are skipped.
  */
 
 class TcpHeader : public Header 
@@ -175,6 +181,47 @@ public:
                            Address destination,
                            uint8_t protocol);
 
+  /**
+   * \brief A SACK block: the left edge and the right edge (excluded) of a
+   *        block of data received
+   */
+  typedef std::pair<SequenceNumber32, SequenceNumber32> SackBlock;
+  /**
+   * \brief The SACK blocks of a header, the first one reporting the most
+   *        recently received segment
+   */
+  typedef std::list<SackBlock> SackList;
+
+  /**
+   * \brief Maximum number of SACK blocks in a header
+   *
+   * Four blocks fill the option space together with the NOP padding.
+   */
+  static const uint32_t MAX_SACK_BLOCKS = 4;
+
+  /**
+   * \param permitted whether to send the SACK-permitted option (SYN only)
+   */
+  void SetSackPermitted (bool permitted);
+  /**
+   * \return true if the header carries the SACK-permitted option
+   */
+  bool IsSackPermitted (void) const;
+  /**
+   * \brief Append a block to the SACK option
+   * \param block the block, ignored once MAX_SACK_BLOCKS blocks are set
+   * \return true if the block was added
+   */
+  bool AddSackBlock (const SackBlock &block);
+  /**
+   * \brief Remove the SACK option
+   */
+  void ClearSackBlocks (void);
+  /**
+   * \return the SACK blocks of the header, in the order they were added
+   */
+  const SackList & GetSackBlocks (void) const;
+
   /**
    * \brief TCP flag field values
    */
@@ -205,6 +252,11 @@ private:
    * \returns the checksum
    */
   uint16_t CalculateHeaderChecksum (uint16_t size) const;
+
+  /**
+   * \brief Set the header length from the options
+   */
+  void UpdateLength (void);
   uint16_t m_sourcePort;        //!< Source port
   uint16_t m_destinationPort;   //!< Destination port
   SequenceNumber32 m_sequenceNumber;  //!< Sequence number
@@ -213,6 +265,8 @@ private:
   uint8_t m_flags;              //!< Flags (really a uint6_t)
   uint16_t m_windowSize;        //!< Window size
   uint16_t m_urgentPointer;     //!< Urgent pointer
+  bool m_sackPermitted;         //!< SACK-permitted option present
+  SackList m_sackBlocks;        //!< SACK option blocks
 
   Address m_source;       //!< Source IP address
   Address m_destination;  //!< Destination IP address
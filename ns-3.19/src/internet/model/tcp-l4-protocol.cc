@@ -20,6 +20,7 @@
 
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/nstime.h"
 #include "ns3/boolean.h"
 #include "ns3/object-vector.h"
@@ -41,7 +42,10 @@
 #include "ipv6-routing-protocol.h"
 #include "tcp-socket-factory-impl.h"
 #include "tcp-newreno.h"
+#include "tcp-reno.h"
+#include "tcp-tahoe.h"
 #include "rtt-estimator.h"
+#include "tcp-congestion-ops.h"
 
 #include <vector>
 #include <sstream>
@@ -79,6 +83,11 @@ TcpL4Protocol::GetTypeId (void)
                    TypeIdValue (TcpNewReno::GetTypeId ()),
                    MakeTypeIdAccessor (&TcpL4Protocol::m_socketTypeId),
                    MakeTypeIdChecker ())
+    .AddAttribute ("CongestionOpsType",
+                   "Type of TcpCongestionOps objects.",
+                   TypeIdValue (TcpNewRenoOps::GetTypeId ()),
+                   MakeTypeIdAccessor (&TcpL4Protocol::m_congestionTypeId),
+                   MakeTypeIdChecker ())
     .AddAttribute ("SocketList", "The list of sockets associated to this protocol.",
                    ObjectVectorValue (),
                    MakeObjectVectorAccessor (&TcpL4Protocol::m_sockets),
@@ -176,19 +185,39 @@ TcpL4Protocol::DoDispose (void)
   IpL4Protocol::DoDispose ();
 }
 
+/**
+ * \returns true if tid is base or one of its subclasses
+ */
+static bool
+IsTypeOrChildOf (TypeId tid, TypeId base)
+{
+  return tid == base || tid.IsChildOf (base);
+}
+
 Ptr<Socket>
 TcpL4Protocol::CreateSocket (TypeId socketTypeId)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  // TcpWestwood and TcpRfc793 have their own congestion control, or none
+  NS_ABORT_MSG_UNLESS (m_congestionTypeId == TcpNewRenoOps::GetTypeId ()
+                       || IsTypeOrChildOf (socketTypeId, TcpNewReno::GetTypeId ())
+                       || IsTypeOrChildOf (socketTypeId, TcpReno::GetTypeId ())
+                       || IsTypeOrChildOf (socketTypeId, TcpTahoe::GetTypeId ()),
+                       "TcpL4Protocol::CreateSocket(): " << socketTypeId.GetName ()
+                       << " does not use CongestionOpsType " << m_congestionTypeId.GetName ());
   ObjectFactory rttFactory;
   ObjectFactory socketFactory;
+  ObjectFactory congestionFactory;
   rttFactory.SetTypeId (m_rttTypeId);
   socketFactory.SetTypeId (socketTypeId);
+  congestionFactory.SetTypeId (m_congestionTypeId);
   Ptr<RttEstimator> rtt = rttFactory.Create<RttEstimator> ();
   Ptr<TcpSocketBase> socket = socketFactory.Create<TcpSocketBase> ();
+  Ptr<TcpCongestionOps> algo = congestionFactory.Create<TcpCongestionOps> ();
   socket->SetNode (m_node);
   socket->SetTcp (this);
   socket->SetRtt (rtt);
+  socket->SetCongestionControl (algo);
   m_sockets.push_back (socket);
   return socket;
 }
@@ -612,7 +641,6 @@ TcpL4Protocol::SendPacket (Ptr<Packet> packet, const TcpHeader &outgoing,
   // XXX outgoingHeader cannot be logged
 
   TcpHeader outgoingHeader = outgoing;
-  outgoingHeader.SetLength (5); //header length in units of 32bit words
   /** \todo UrgentPointer */
   /* outgoingHeader.SetUrgentPointer (0); */
   if(Node::ChecksumEnabled ())
@@ -664,7 +692,6 @@ TcpL4Protocol::SendPacket (Ptr<Packet> packet, const TcpHeader &outgoing,
       return (SendPacket (packet, outgoing, saddr.GetIpv4MappedAddress(), daddr.GetIpv4MappedAddress(), oif));
     }
   TcpHeader outgoingHeader = outgoing;
-  outgoingHeader.SetLength (5); //header length in units of 32bit words
   /** \todo UrgentPointer */
   /* outgoingHeader.SetUrgentPointer (0); */
   if(Node::ChecksumEnabled ())
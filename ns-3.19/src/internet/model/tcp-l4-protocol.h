@@ -232,6 +232,7 @@ private:
   Ipv6EndPointDemux *m_endPoints6; //!< A list of IPv6 end points.
   TypeId m_rttTypeId; //!< The RTT Estimator TypeId
   TypeId m_socketTypeId; //!< The socket TypeId
+  TypeId m_congestionTypeId; //!< The congestion control TypeId
 private:
   friend class TcpSocketBase;
   void SendPacket (Ptr<Packet>, const TcpHeader &,
@@ -57,8 +57,7 @@ TcpNewReno::GetTypeId (void)
 }
 
 TcpNewReno::TcpNewReno (void)
-  : m_retxThresh (3), // mute valgrind, actual value set by the attribute system
-    m_inFastRec (false),
+  : m_inFastRec (false),
     m_limitedTx (false) // mute valgrind, actual value set by the attribute system
 {
   NS_LOG_FUNCTION (this);
@@ -69,7 +68,6 @@ TcpNewReno::TcpNewReno (const TcpNewReno& sock)
     m_cWnd (sock.m_cWnd),
     m_ssThresh (sock.m_ssThresh),
     m_initialCWnd (sock.m_initialCWnd),
-    m_retxThresh (sock.m_retxThresh),
     m_inFastRec (false),
     m_limitedTx (sock.m_limitedTx)
 {
@@ -123,7 +121,17 @@ TcpNewReno::NewAck (const SequenceNumber32& seq)
                 " ssthresh " << m_ssThresh);
 
   // Check for exit condition of fast recovery
-  if (m_inFastRec && seq < m_recover)
+  if (m_inFastRec && seq < m_recover && m_sackRecovery)
+    { // Partial ACK with SACK: the window is left as is (RFC6675 sec.5)
+      bool headRetransmitted = m_highRxt > seq;
+      TcpSocketBase::NewAck (seq); // retransmit the holes and send new data if allowed by pipe
+      if (!headRetransmitted)
+        {
+          DoRetransmit (); // Assume the next seq is lost, as without SACK
+        }
+      return;
+    }
+  else if (m_inFastRec && seq < m_recover)
     { // Partial ACK, partial window deflation (RFC2582 sec.3 bullet #5 paragraph 3)
       m_cWnd -= seq - m_txBuffer.HeadSequence ();
       m_cWnd += m_segmentSize;  // increase cwnd
@@ -136,23 +144,17 @@ TcpNewReno::NewAck (const SequenceNumber32& seq)
     { // Full ACK (RFC2582 sec.3 bullet #5 paragraph 2, option 1)
       m_cWnd = std::min (m_ssThresh, BytesInFlight () + m_segmentSize);
       m_inFastRec = false;
+      ExitSackRecovery ();
       NS_LOG_INFO ("Received full ACK. Leaving fast recovery with cwnd set to " << m_cWnd);
     }
 
-  // Increase of cwnd based on current phase (slow start or congestion avoidance)
-  if (m_cWnd < m_ssThresh)
-    { // Slow start mode, add one segSize to cWnd. Default m_ssThresh is 65535. (RFC2001, sec.1)
-      m_cWnd += m_segmentSize;
-      NS_LOG_INFO ("In SlowStart, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
-    }
-  else
-    { // Congestion avoidance mode, increase by (segSize*segSize)/cwnd. (RFC2581, sec.3.1)
-      // To increase cwnd for one segSize per RTT, it should be (ackBytes*segSize)/cwnd
-      double adder = static_cast<double> (m_segmentSize * m_segmentSize) / m_cWnd.Get ();
-      adder = std::max (1.0, adder);
-      m_cWnd += static_cast<uint32_t> (adder);
-      NS_LOG_INFO ("In CongAvoid, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
-    }
+  // Increase of cwnd based on current phase (slow start or congestion avoidance),
+  // as the congestion control algorithm sees fit
+  bool slowStart = m_cWnd < m_ssThresh;
+  m_cWnd = m_congestionOps->IncreaseWindow (m_cWnd, m_ssThresh, m_segmentSize,
+                                            seq - m_txBuffer.HeadSequence ());
+  NS_LOG_INFO ((slowStart ? "In SlowStart" : "In CongAvoid") << ", updated to cwnd " << m_cWnd <<
+               " ssthresh " << m_ssThresh << " (" << m_congestionOps->GetName () << ")");
 
   // Complete newAck processing
   TcpSocketBase::NewAck (seq);
@@ -163,15 +165,28 @@ void
 TcpNewReno::DupAck (const TcpHeader& t, uint32_t count)
 {
   NS_LOG_FUNCTION (this << count);
-  if (count == m_retxThresh && !m_inFastRec)
-    { // triple duplicate ack triggers fast retransmit (RFC2582 sec.3 bullet #1)
-      m_ssThresh = std::max (2 * m_segmentSize, BytesInFlight () / 2);
+  if ((count == m_retxThresh || SackDetectsLoss ()) && !m_inFastRec)
+    { // triple duplicate ack, or SACKed data, triggers fast retransmit (RFC2582 sec.3 bullet #1, RFC6675 sec.5)
+      m_ssThresh = m_congestionOps->GetSsThresh (m_cWnd, BytesInFlight (), m_segmentSize);
       m_cWnd = m_ssThresh + 3 * m_segmentSize;
       m_recover = m_highTxMark;
       m_inFastRec = true;
+      if (m_sackPermitted)
+        { // The pipe accounts for the SACKed segments, no window inflation
+          m_cWnd = m_ssThresh;
+          EnterSackRecovery ();
+        }
       NS_LOG_INFO ("Triple dupack. Enter fast recovery mode. Reset cwnd to " << m_cWnd <<
                    ", ssthresh to " << m_ssThresh << " at fast recovery seqnum " << m_recover);
       DoRetransmit ();
+      if (m_sackRecovery)
+        {
+          SendPendingData (m_connected);
+        }
+    }
+  else if (m_inFastRec && m_sackRecovery)
+    { // The SACK blocks of the dupack have shrunk the pipe
+      SendPendingData (m_connected);
     }
   else if (m_inFastRec)
     { // Increase cwnd for every additional dupack (RFC2582, sec.3 bullet #3)
@@ -202,8 +217,9 @@ TcpNewReno::Retransmit (void)
 
   // According to RFC2581 sec.3.1, upon RTO, ssthresh is set to half of flight
   // size and cwnd is set to 1*MSS, then the lost packet is retransmitted and
-  // TCP back to slow start
-  m_ssThresh = std::max (2 * m_segmentSize, BytesInFlight () / 2);
+  // TCP back to slow start. The congestion control algorithm may set another ssthresh.
+  m_ssThresh = m_congestionOps->GetSsThresh (m_cWnd, BytesInFlight (), m_segmentSize);
+  m_congestionOps->Timeout ();
   m_cWnd = m_segmentSize;
   m_nextTxSequence = m_txBuffer.HeadSequence (); // Restart from highest Ack
   NS_LOG_INFO ("RTO. Reset cwnd to " << m_cWnd <<
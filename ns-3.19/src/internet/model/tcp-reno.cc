@@ -52,7 +52,7 @@ TcpReno::GetTypeId (void)
   return tid;
 }
 
-TcpReno::TcpReno (void) : m_retxThresh (3), m_inFastRec (false)
+TcpReno::TcpReno (void) : m_inFastRec (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -62,7 +62,6 @@ TcpReno::TcpReno (const TcpReno& sock)
     m_cWnd (sock.m_cWnd),
     m_ssThresh (sock.m_ssThresh),
     m_initialCWnd (sock.m_initialCWnd),
-    m_retxThresh (sock.m_retxThresh),
     m_inFastRec (false)
 {
   NS_LOG_FUNCTION (this);
@@ -120,23 +119,17 @@ TcpReno::NewAck (const SequenceNumber32& seq)
       // First new ACK after fast recovery: reset cwnd
       m_cWnd = m_ssThresh;
       m_inFastRec = false;
+      ExitSackRecovery ();
       NS_LOG_INFO ("Reset cwnd to " << m_cWnd);
     };
 
-  // Increase of cwnd based on current phase (slow start or congestion avoidance)
-  if (m_cWnd < m_ssThresh)
-    { // Slow start mode, add one segSize to cWnd. Default m_ssThresh is 65535. (RFC2001, sec.1)
-      m_cWnd += m_segmentSize;
-      NS_LOG_INFO ("In SlowStart, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
-    }
-  else
-    { // Congestion avoidance mode, increase by (segSize*segSize)/cwnd. (RFC2581, sec.3.1)
-      // To increase cwnd for one segSize per RTT, it should be (ackBytes*segSize)/cwnd
-      double adder = static_cast<double> (m_segmentSize * m_segmentSize) / m_cWnd.Get ();
-      adder = std::max (1.0, adder);
-      m_cWnd += static_cast<uint32_t> (adder);
-      NS_LOG_INFO ("In CongAvoid, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
-    }
+  // Increase of cwnd based on current phase (slow start or congestion avoidance),
+  // as the congestion control algorithm sees fit
+  bool slowStart = m_cWnd < m_ssThresh;
+  m_cWnd = m_congestionOps->IncreaseWindow (m_cWnd, m_ssThresh, m_segmentSize,
+                                            seq - m_txBuffer.HeadSequence ());
+  NS_LOG_INFO ((slowStart ? "In SlowStart" : "In CongAvoid") << ", updated to cwnd " << m_cWnd <<
+               " ssthresh " << m_ssThresh << " (" << m_congestionOps->GetName () << ")");
 
   // Complete newAck processing
   TcpSocketBase::NewAck (seq);
@@ -147,13 +140,26 @@ void
 TcpReno::DupAck (const TcpHeader& t, uint32_t count)
 {
   NS_LOG_FUNCTION (this << "t " << count);
-  if (count == m_retxThresh && !m_inFastRec)
+  if ((count == m_retxThresh || SackDetectsLoss ()) && !m_inFastRec)
     { // triple duplicate ack triggers fast retransmit (RFC2581, sec.3.2)
-      m_ssThresh = std::max (2 * m_segmentSize, BytesInFlight () / 2);
+      m_ssThresh = m_congestionOps->GetSsThresh (m_cWnd, BytesInFlight (), m_segmentSize);
       m_cWnd = m_ssThresh + 3 * m_segmentSize;
       m_inFastRec = true;
+      if (m_sackPermitted)
+        { // The pipe accounts for the SACKed segments, no window inflation (RFC6675)
+          m_cWnd = m_ssThresh;
+          EnterSackRecovery ();
+        }
       NS_LOG_INFO ("Triple dupack. Reset cwnd to " << m_cWnd << ", ssthresh to " << m_ssThresh);
       DoRetransmit ();
+      if (m_sackRecovery)
+        {
+          SendPendingData (m_connected);
+        }
+    }
+  else if (m_inFastRec && m_sackRecovery)
+    { // The SACK blocks of the dupack have shrunk the pipe
+      SendPendingData (m_connected);
     }
   else if (m_inFastRec)
     { // In fast recovery, inc cwnd for every additional dupack (RFC2581, sec.3.2)
@@ -177,8 +183,9 @@ void TcpReno::Retransmit (void)
 
   // According to RFC2581 sec.3.1, upon RTO, ssthresh is set to half of flight
   // size and cwnd is set to 1*MSS, then the lost packet is retransmitted and
-  // TCP back to slow start
-  m_ssThresh = std::max (2 * m_segmentSize, BytesInFlight () / 2);
+  // TCP back to slow start. The congestion control algorithm may set another ssthresh.
+  m_ssThresh = m_congestionOps->GetSsThresh (m_cWnd, BytesInFlight (), m_segmentSize);
+  m_congestionOps->Timeout ();
   m_cWnd = m_segmentSize;
   m_nextTxSequence = m_txBuffer.HeadSequence (); // Restart from highest Ack
   NS_LOG_INFO ("RTO. Reset cwnd to " << m_cWnd <<
@@ -81,7 +81,6 @@ protected:
   TracedValue<uint32_t>  m_cWnd;         //!< Congestion window
   uint32_t               m_ssThresh;     //!< Slow Start Threshold
   uint32_t               m_initialCWnd;  //!< Initial cWnd value
-  uint32_t               m_retxThresh;   //!< Fast Retransmit threshold
   bool                   m_inFastRec;    //!< currently in fast recovery
 };
 
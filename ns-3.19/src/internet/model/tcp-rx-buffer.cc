@@ -18,6 +18,8 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <iterator>
+
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
@@ -152,8 +154,13 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. Buffered packets do not overlap, so
+  // only the last one starting before headSeq may overlap the incoming head.
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -186,22 +193,20 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
     {
       uint32_t start = headSeq - tcph.GetSequenceNumber ();
       uint32_t length = tailSeq - headSeq;
-      p = p->CreateFragment (start, length);
+      // Keep a reference to the received data, sliced only when trimmed
+      p = (length == pktSize) ? p->Copy () : p->CreateFragment (start, length);
       NS_ASSERT (length == p->GetSize ());
     }
   // Insert packet into buffer
   NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
   m_data [ headSeq ] = p;
+  m_lastSeq = headSeq;
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  for (BufIterator i = m_data.lower_bound (m_nextRxSeq); i != m_data.end (); ++i)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
+      if (i->first > m_nextRxSeq)
         {
           break;
         };
@@ -216,6 +221,44 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   return true;
 }
 
+TcpHeader::SackList
+TcpRxBuffer::GetSackBlocks (void) const
+{
+  NS_LOG_FUNCTION (this);
+  TcpHeader::SackList blocks;
+  // Merge the out-of-order segments, which all start after RCV.NXT, into
+  // contiguous blocks
+  std::map<SequenceNumber32, Ptr<Packet> >::const_iterator i = m_data.upper_bound (m_nextRxSeq);
+  for (; i != m_data.end (); ++i)
+    {
+      SequenceNumber32 tail = i->first + SequenceNumber32 (i->second->GetSize ());
+      if (!blocks.empty () && blocks.back ().second == i->first)
+        {
+          blocks.back ().second = tail;
+        }
+      else
+        {
+          blocks.push_back (TcpHeader::SackBlock (i->first, tail));
+        }
+    }
+  // Report the block of the most recent segment first
+  for (TcpHeader::SackList::iterator b = blocks.begin (); b != blocks.end (); ++b)
+    {
+      if (b->first <= m_lastSeq && m_lastSeq < b->second)
+        {
+          blocks.splice (blocks.begin (), blocks, b);
+          break;
+        }
+    }
+  if (blocks.size () > TcpHeader::MAX_SACK_BLOCKS)
+    {
+      TcpHeader::SackList::iterator end = blocks.begin ();
+      std::advance (end, TcpHeader::MAX_SACK_BLOCKS);
+      blocks.erase (end, blocks.end ());
+    }
+  return blocks;
+}
+
 Ptr<Packet>
 TcpRxBuffer::Extract (uint32_t maxSize)
 {
@@ -225,7 +268,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return 0;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  Ptr<Packet> outPkt; // The packet that contains all the data to return
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
@@ -234,8 +277,15 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       // Check if we send the whole pkt or just a partial
       uint32_t pktSize = i->second->GetSize ();
       if (pktSize <= extractSize)
-        { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
+        { // Whole packet is extracted, the first one is handed over as is
+          if (outPkt == 0)
+            {
+              outPkt = i->second;
+            }
+          else
+            {
+              outPkt->AddAtEnd (i->second);
+            }
           m_data.erase (i);
           m_size -= pktSize;
           m_availBytes -= pktSize;
@@ -243,7 +293,14 @@ TcpRxBuffer::Extract (uint32_t maxSize)
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
+          if (outPkt == 0)
+            {
+              outPkt = i->second->CreateFragment (0, extractSize);
+            }
+          else
+            {
+              outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
+            }
           m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
           m_data.erase (i);
           m_size -= extractSize;
@@ -251,7 +308,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
           extractSize = 0;
         }
     }
-  if (outPkt->GetSize () == 0)
+  if (outPkt == 0 || outPkt->GetSize () == 0)
     {
       NS_LOG_LOGIC ("Nothing extracted.");
       return 0;
@@ -36,6 +36,10 @@ class Packet;
  *
  * \brief class for the reordering buffer that keeps the data from lower layer, i.e.
  *        TcpL4Protocol, sent to the application
+ *
+ * Segments are kept by reference to the received data, and handed over to
+ * the application without being copied when a read covers whole segments;
+ * only the data of a read spanning several segments is concatenated.
  */
 class TcpRxBuffer : public Object
 {
@@ -124,6 +128,16 @@ public:
    * \returns a packet
    */
   Ptr<Packet> Extract (uint32_t maxSize);
+
+  /**
+   * Get the SACK blocks describing the out-of-order data in the buffer
+   * (RFC 2018): the block holding the most recently received segment
+   * first, followed by the other blocks in sequence order.
+   *
+   * \returns at most TcpHeader::MAX_SACK_BLOCKS blocks, none if there is
+   *          no out-of-order data
+   */
+  TcpHeader::SackList GetSackBlocks (void) const;
 public:
   /// container for data stored in the buffer
   typedef std::map<SequenceNumber32, Ptr<Packet> >::iterator BufIterator;
@@ -133,6 +147,7 @@ public:
   uint32_t m_size;                           //!< Number of total data bytes in the buffer, not necessarily contiguous
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
+  SequenceNumber32 m_lastSeq;                //!< Seqnum of the last data buffered
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
 };
 
@@ -39,6 +39,7 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
@@ -84,6 +85,14 @@ TcpSocketBase::GetTypeId (void)
                    CallbackValue (),
                    MakeCallbackAccessor (&TcpSocketBase::m_icmpCallback6),
                    MakeCallbackChecker ())                   
+    .AddAttribute ("Sack", "Enable the selective acknowledgement option (RFC 2018) and the loss recovery using it (RFC 6675)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_sackEnabled),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Pacing", "Space the segments at the pacing rate of the congestion control instead of sending them back-to-back",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TcpSocketBase::m_pacing),
+                   MakeBooleanChecker ())
     .AddTraceSource ("RTO",
                      "Retransmission timeout",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rto))
@@ -114,6 +123,8 @@ TcpSocketBase::TcpSocketBase (void)
     m_node (0),
     m_tcp (0),
     m_rtt (0),
+    m_congestionOps (CreateObject<TcpNewRenoOps> ()), // replaced by TcpL4Protocol::CreateSocket
+    m_pacing (false),
     m_nextTxSequence (0),
     // Change this for non-zero initial sequence number
     m_highTxMark (0),
@@ -128,7 +139,11 @@ TcpSocketBase::TcpSocketBase (void)
     m_connected (false),
     m_segmentSize (0),
     // For attribute initialization consistency (quiet valgrind)
-    m_rWnd (0)
+    m_rWnd (0),
+    m_retxThresh (3), // actual value set by the attribute system of the subclasses
+    m_sackEnabled (false),
+    m_sackPermitted (false),
+    m_sackRecovery (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -149,6 +164,8 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_node (sock.m_node),
     m_tcp (sock.m_tcp),
     m_rtt (0),
+    m_congestionOps (0),
+    m_pacing (sock.m_pacing),
     m_nextTxSequence (sock.m_nextTxSequence),
     m_highTxMark (sock.m_highTxMark),
     m_rxBuffer (sock.m_rxBuffer),
@@ -163,7 +180,11 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_msl (sock.m_msl),
     m_segmentSize (sock.m_segmentSize),
     m_maxWinSize (sock.m_maxWinSize),
-    m_rWnd (sock.m_rWnd)
+    m_rWnd (sock.m_rWnd),
+    m_retxThresh (sock.m_retxThresh),
+    m_sackEnabled (sock.m_sackEnabled),
+    m_sackPermitted (sock.m_sackPermitted),
+    m_sackRecovery (false)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -172,6 +193,11 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     {
       m_rtt = sock.m_rtt->Copy ();
     }
+  // Copy the congestion control if it is set
+  if (sock.m_congestionOps)
+    {
+      m_congestionOps = sock.m_congestionOps->Copy ();
+    }
   // Reset all callbacks to null
   Callback<void, Ptr< Socket > > vPS = MakeNullCallback<void, Ptr<Socket> > ();
   Callback<void, Ptr<Socket>, const Address &> vPSA = MakeNullCallback<void, Ptr<Socket>, const Address &> ();
@@ -232,6 +258,13 @@ TcpSocketBase::SetRtt (Ptr<RttEstimator> rtt)
   m_rtt = rtt;
 }
 
+/* Set the congestion control algorithm of this socket */
+void
+TcpSocketBase::SetCongestionControl (Ptr<TcpCongestionOps> algo)
+{
+  m_congestionOps = algo;
+}
+
 /* Inherit from Socket class: Returns error code */
 enum Socket::SocketErrno
 TcpSocketBase::GetErrno (void) const
@@ -1098,6 +1131,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
     }
   else if (tcpHeader.GetAckNumber () == m_txBuffer.HeadSequence ())
     { // Case 2: Potentially a duplicated ACK
+      if (m_sackPermitted)
+        {
+          m_txBuffer.Sack (tcpHeader.GetSackBlocks ());
+        }
       if (tcpHeader.GetAckNumber () < m_nextTxSequence && packet->GetSize() == 0)
         {
           NS_LOG_LOGIC ("Dupack of " << tcpHeader.GetAckNumber ());
@@ -1109,6 +1146,11 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
   else if (tcpHeader.GetAckNumber () > m_txBuffer.HeadSequence ())
     { // Case 3: New ACK, reset m_dupAckCount and update m_txBuffer
       NS_LOG_LOGIC ("New ack of " << tcpHeader.GetAckNumber ());
+      if (m_sackPermitted)
+        {
+          m_txBuffer.Sack (tcpHeader.GetSackBlocks ());
+        }
+      m_congestionOps->PktsAcked (tcpHeader.GetAckNumber () - m_txBuffer.HeadSequence (), m_lastRtt);
       NewAck (tcpHeader.GetAckNumber ());
       m_dupAckCount = 0;
     }
@@ -1945,8 +1987,29 @@ TcpSocketBase::SendPendingData (bool withAck)
       return false; // Is this the right way to handle this condition?
     }
   uint32_t nPacketsSent = 0;
+  if (m_sackRecovery)
+    { // Retransmit the data deemed lost first (RFC 6675 NextSeg)
+      SequenceNumber32 seq;
+      uint32_t length;
+      while (AvailableWindow () >= m_segmentSize
+             && m_txBuffer.NextLostSegment (m_highRxt, m_retxThresh, m_segmentSize, seq, length))
+        {
+          NS_LOG_LOGIC ("TcpSocketBase " << this << " retxing lost seq " << seq);
+          m_highRxt = seq + SendDataPacket (seq, length, withAck);
+          nPacketsSent++;
+        }
+    }
   while (m_txBuffer.SizeFromSequence (m_nextTxSequence))
     {
+      uint32_t hole = m_segmentSize;
+      if (m_sackPermitted)
+        { // Do not send again the data the receiver has SACKed
+          m_nextTxSequence = m_txBuffer.NextUnsacked (m_nextTxSequence, hole);
+          if (m_txBuffer.SizeFromSequence (m_nextTxSequence) == 0)
+            {
+              break;
+            }
+        }
       uint32_t w = AvailableWindow (); // Get available window size
       NS_LOG_LOGIC ("TcpSocketBase " << this << " SendPendingData" <<
                     " w " << w <<
@@ -1969,10 +2032,24 @@ TcpSocketBase::SendPendingData (bool withAck)
           NS_LOG_LOGIC ("Invoking Nagle's algorithm. Wait to send.");
           break;
         }
-      uint32_t s = std::min (w, m_segmentSize);  // Send no more than window
+      if (m_pacingEvent.IsRunning ())
+        {
+          NS_LOG_LOGIC ("Pacing. Wait to send.");
+          break;
+        }
+      uint32_t s = std::min (std::min (w, m_segmentSize), hole);  // Send no more than window
       uint32_t sz = SendDataPacket (m_nextTxSequence, s, withAck);
       nPacketsSent++;                             // Count sent this loop
       m_nextTxSequence += sz;                     // Advance next tx sequence
+      if (m_pacing)
+        { // Hold the next segment for the time this one takes at the pacing rate
+          uint64_t rate = m_congestionOps->GetPacingRate (Window (), GetSSThresh (), m_rtt->GetCurrentEstimate ());
+          if (rate > 0)
+            {
+              m_pacingEvent = Simulator::Schedule (Seconds (sz * 8.0 / rate),
+                                                   &TcpSocketBase::PacingTimeout, this);
+            }
+        }
     }
   NS_LOG_LOGIC ("SendPendingData sent " << nPacketsSent << " packets");
   return (nPacketsSent > 0);
@@ -2004,6 +2081,11 @@ TcpSocketBase::AvailableWindow ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   uint32_t unack = UnAckDataCount (); // Number of outstanding bytes
+  if (m_sackPermitted)
+    { // Leave out the bytes SACKed or lost, as RFC 6675 pipe does
+      unack = m_txBuffer.Pipe (m_nextTxSequence, m_sackRecovery ? m_highRxt : m_txBuffer.HeadSequence (),
+                               m_retxThresh, m_segmentSize);
+    }
   uint32_t win = Window (); // Number of bytes allowed to be outstanding
   NS_LOG_LOGIC ("UnAckCount=" << unack << ", Win=" << win);
   return (win < unack) ? 0 : (win - unack);
@@ -2127,13 +2209,13 @@ TcpSocketBase::NewAck (SequenceNumber32 const& ack)
   NS_LOG_LOGIC ("TCP " << this << " NewAck " << ack <<
                 " numberAck " << (ack - m_txBuffer.HeadSequence ())); // Number bytes ack'ed
   m_txBuffer.DiscardUpTo (ack);
-  if (GetTxAvailable () > 0)
+  if (ack > m_nextTxSequence)
     {
-      NotifySend (GetTxAvailable ());
+      m_nextTxSequence = ack; // If advanced, before the application sends more
     }
-  if (ack > m_nextTxSequence)
+  if (GetTxAvailable () > 0)
     {
-      m_nextTxSequence = ack; // If advanced
+      NotifySend (GetTxAvailable ());
     }
   if (m_txBuffer.Size () == 0 && m_state != FIN_WAIT_1 && m_state != CLOSING)
     { // No retransmit timer if no data to retransmit
@@ -2161,6 +2243,9 @@ TcpSocketBase::ReTxTimeout ()
     {
       return;
     }
+  // The receiver may have dropped the data it SACKed (RFC 2018, section 8)
+  m_txBuffer.ResetScoreboard ();
+  ExitSackRecovery ();
 
   Retransmit ();
 }
@@ -2266,7 +2351,16 @@ TcpSocketBase::DoRetransmit ()
     }
   // Retransmit a data packet: Call SendDataPacket
   NS_LOG_LOGIC ("TcpSocketBase " << this << " retxing seq " << m_txBuffer.HeadSequence ());
-  uint32_t sz = SendDataPacket (m_txBuffer.HeadSequence (), m_segmentSize, true);
+  uint32_t hole = m_segmentSize;
+  if (m_sackPermitted)
+    { // Stop at the data the receiver has SACKed
+      m_txBuffer.NextUnsacked (m_txBuffer.HeadSequence (), hole);
+    }
+  uint32_t sz = SendDataPacket (m_txBuffer.HeadSequence (), std::min (m_segmentSize, hole), true);
+  if (m_sackRecovery)
+    {
+      m_highRxt = std::max (m_highRxt, m_txBuffer.HeadSequence () + sz);
+    }
   // In case of RTO, advance m_nextTxSequence
   m_nextTxSequence = std::max (m_nextTxSequence.Get (), m_txBuffer.HeadSequence () + sz);
 
@@ -2280,6 +2374,7 @@ TcpSocketBase::CancelAllTimers ()
   m_delAckEvent.Cancel ();
   m_lastAckEvent.Cancel ();
   m_timewaitEvent.Cancel ();
+  m_pacingEvent.Cancel ();
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -2419,16 +2514,64 @@ TcpSocketBase::GetAllowBroadcast (void) const
   return false;
 }
 
-/* Placeholder function for future extension that reads more from the TCP header */
+/* Read the options of the TCP header: SACK is used if both ends offered it
+   in their SYN */
 void
-TcpSocketBase::ReadOptions (const TcpHeader&)
+TcpSocketBase::ReadOptions (const TcpHeader& tcpHeader)
 {
+  if (tcpHeader.GetFlags () & TcpHeader::SYN)
+    {
+      m_sackPermitted = m_sackEnabled && tcpHeader.IsSackPermitted ();
+    }
 }
 
-/* Placeholder function for future extension that changes the TCP header */
+/* Add the options to the TCP header: offer SACK in the SYN, and report the
+   out-of-order data received in the ACKs once it is agreed */
 void
-TcpSocketBase::AddOptions (TcpHeader&)
+TcpSocketBase::AddOptions (TcpHeader& tcpHeader)
 {
+  uint8_t flags = tcpHeader.GetFlags ();
+  if (flags & TcpHeader::SYN)
+    { // A SYN+ACK only answers an offer
+      tcpHeader.SetSackPermitted (m_sackEnabled && (!(flags & TcpHeader::ACK) || m_sackPermitted));
+    }
+  else if (m_sackPermitted && (flags & TcpHeader::ACK))
+    {
+      TcpHeader::SackList blocks = m_rxBuffer.GetSackBlocks ();
+      for (TcpHeader::SackList::const_iterator i = blocks.begin (); i != blocks.end (); ++i)
+        {
+          tcpHeader.AddSackBlock (*i);
+        }
+    }
+}
+
+bool
+TcpSocketBase::SackDetectsLoss (void) const
+{
+  return m_sackPermitted
+         && m_txBuffer.IsLost (m_txBuffer.HeadSequence (), m_retxThresh, m_segmentSize);
+}
+
+void
+TcpSocketBase::EnterSackRecovery (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sackRecovery = true;
+  m_highRxt = m_txBuffer.HeadSequence ();
+}
+
+void
+TcpSocketBase::ExitSackRecovery (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sackRecovery = false;
+}
+
+void
+TcpSocketBase::PacingTimeout (void)
+{
+  NS_LOG_FUNCTION (this);
+  SendPendingData (m_connected);
 }
 
 } // namespace ns3
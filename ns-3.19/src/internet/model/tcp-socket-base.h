@@ -36,6 +36,7 @@
 #include "tcp-tx-buffer.h"
 #include "tcp-rx-buffer.h"
 #include "rtt-estimator.h"
+#include "tcp-congestion-ops.h"
 
 namespace ns3 {
 
@@ -101,6 +102,12 @@ public:
    */
   virtual void SetRtt (Ptr<RttEstimator> rtt);
 
+  /**
+   * \brief Set the congestion control algorithm.
+   * \param algo the congestion control algorithm
+   */
+  virtual void SetCongestionControl (Ptr<TcpCongestionOps> algo);
+
   // Necessary implementations of null functions from ns3::Socket
   virtual enum SocketErrno GetErrno (void) const;    // returns m_errno
   virtual enum SocketType GetSocketType (void) const; // returns socket type
@@ -550,6 +557,33 @@ protected:
    */
   virtual void AddOptions (TcpHeader& tcpHeader);
 
+  // SACK-based loss recovery (RFC 2018, RFC 6675)
+
+  /**
+   * \brief Whether the SACK scoreboard shows the oldest unacknowledged
+   *        segment lost, before the duplicate ACK threshold is reached
+   * \returns true if SACK is in use and the first unacknowledged byte is lost
+   */
+  bool SackDetectsLoss (void) const;
+
+  /**
+   * \brief Enter loss recovery driven by the SACK scoreboard
+   *
+   * The window is no longer inflated by duplicate ACKs: SendPendingData ()
+   * retransmits the data deemed lost ahead of new data, as long as the
+   * estimate of the bytes in the network (the pipe) is below the window.
+   */
+  void EnterSackRecovery (void);
+
+  /**
+   * \brief Leave the loss recovery driven by the SACK scoreboard
+   */
+  void ExitSackRecovery (void);
+
+  /**
+   * \brief Send the segments held back by the pacing
+   */
+  void PacingTimeout (void);
 
 protected:
   // Counters and events
@@ -558,6 +592,7 @@ protected:
   EventId           m_delAckEvent;     //!< Delayed ACK timeout event
   EventId           m_persistEvent;    //!< Persist event: Send 1 byte to probe for a non-zero Rx window
   EventId           m_timewaitEvent;   //!< TIME_WAIT expiration event: Move this socket to CLOSED state
+  EventId           m_pacingEvent;     //!< Pacing event: Send the next segment
   uint32_t          m_dupAckCount;     //!< Dupack counter
   uint32_t          m_delAckCount;     //!< Delayed ACK counter
   uint32_t          m_delAckMaxCount;  //!< Number of packet to fire an ACK before delay timeout
@@ -579,6 +614,8 @@ protected:
   Callback<void, Ipv6Address,uint8_t,uint8_t,uint8_t,uint32_t> m_icmpCallback6; //!< ICMPv6 callback
 
   Ptr<RttEstimator> m_rtt; //!< Round trip time estimator
+  Ptr<TcpCongestionOps> m_congestionOps; //!< Congestion control algorithm
+  bool              m_pacing; //!< Space the segments at the rate of the congestion control
 
   // Rx and Tx buffer management
   TracedValue<SequenceNumber32> m_nextTxSequence; //!< Next seqnum to be sent (SND.NXT), ReTx pushes it back
@@ -600,6 +637,13 @@ protected:
   uint32_t              m_segmentSize; //!< Segment size
   uint16_t              m_maxWinSize;  //!< Maximum window size to advertise
   TracedValue<uint32_t> m_rWnd;        //!< Flow control window at remote side
+  uint32_t              m_retxThresh;  //!< Fast Retransmit threshold, also the DupThresh of the SACK scoreboard
+
+  // SACK
+  bool             m_sackEnabled;   //!< Offer and accept the SACK option
+  bool             m_sackPermitted; //!< SACK negotiated on this connection
+  bool             m_sackRecovery;  //!< In SACK-based loss recovery
+  SequenceNumber32 m_highRxt;       //!< Highest seqno retransmitted during the recovery (HighRxt)
 };
 
 } // namespace ns3
@@ -52,7 +52,7 @@ TcpTahoe::GetTypeId (void)
   return tid;
 }
 
-TcpTahoe::TcpTahoe (void) : m_initialCWnd (1), m_retxThresh (3)
+TcpTahoe::TcpTahoe (void) : m_initialCWnd (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -61,8 +61,7 @@ TcpTahoe::TcpTahoe (const TcpTahoe& sock)
   : TcpSocketBase (sock),
     m_cWnd (sock.m_cWnd),
     m_ssThresh (sock.m_ssThresh),
-    m_initialCWnd (sock.m_initialCWnd),
-    m_retxThresh (sock.m_retxThresh)
+    m_initialCWnd (sock.m_initialCWnd)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -112,19 +111,13 @@ TcpTahoe::NewAck (SequenceNumber32 const& seq)
   NS_LOG_LOGIC ("TcpTahoe receieved ACK for seq " << seq <<
                 " cwnd " << m_cWnd <<
                 " ssthresh " << m_ssThresh);
-  if (m_cWnd < m_ssThresh)
-    { // Slow start mode, add one segSize to cWnd. Default m_ssThresh is 65535. (RFC2001, sec.1)
-      m_cWnd += m_segmentSize;
-      NS_LOG_INFO ("In SlowStart, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
-    }
-  else
-    { // Congestion avoidance mode, increase by (segSize*segSize)/cwnd. (RFC2581, sec.3.1)
-      // To increase cwnd for one segSize per RTT, it should be (ackBytes*segSize)/cwnd
-      double adder = static_cast<double> (m_segmentSize * m_segmentSize) / m_cWnd.Get ();
-      adder = std::max (1.0, adder);
-      m_cWnd += static_cast<uint32_t> (adder);
-      NS_LOG_INFO ("In CongAvoid, updated to cwnd " << m_cWnd << " ssthresh " << m_ssThresh);
-    }
+  // Increase of cwnd based on current phase (slow start or congestion avoidance),
+  // as the congestion control algorithm sees fit
+  bool slowStart = m_cWnd < m_ssThresh;
+  m_cWnd = m_congestionOps->IncreaseWindow (m_cWnd, m_ssThresh, m_segmentSize,
+                                            seq - m_txBuffer.HeadSequence ());
+  NS_LOG_INFO ((slowStart ? "In SlowStart" : "In CongAvoid") << ", updated to cwnd " << m_cWnd <<
+               " ssthresh " << m_ssThresh << " (" << m_congestionOps->GetName () << ")");
   TcpSocketBase::NewAck (seq);           // Complete newAck processing
 }
 
@@ -139,7 +132,9 @@ TcpTahoe::DupAck (const TcpHeader& t, uint32_t count)
       // fast retransmit in Tahoe means triggering RTO earlier. Tx is restarted
       // from the highest ack and run slow start again.
       // (Fall & Floyd 1996, sec.1)
-      m_ssThresh = std::max (static_cast<unsigned> (m_cWnd / 2), m_segmentSize * 2);  // Half ssthresh
+      // Tahoe halves the window (RFC2001, sec.3): the flight size given to the
+      // congestion control algorithm is the window
+      m_ssThresh = m_congestionOps->GetSsThresh (m_cWnd, m_cWnd, m_segmentSize);
       m_cWnd = m_segmentSize; // Run slow start again
       m_nextTxSequence = m_txBuffer.HeadSequence (); // Restart from highest Ack
       NS_LOG_INFO ("Triple Dup Ack: new ssthresh " << m_ssThresh << " cwnd " << m_cWnd);
@@ -158,7 +153,8 @@ void TcpTahoe::Retransmit (void)
   // If all data are received (non-closing socket and nothing to send), just return
   if (m_state <= ESTABLISHED && m_txBuffer.HeadSequence () >= m_highTxMark) return;
 
-  m_ssThresh = std::max (static_cast<unsigned> (m_cWnd / 2), m_segmentSize * 2);  // Half ssthresh
+  m_ssThresh = m_congestionOps->GetSsThresh (m_cWnd, m_cWnd, m_segmentSize);  // Half the window
+  m_congestionOps->Timeout ();
   m_cWnd = m_segmentSize;                   // Set cwnd to 1 segSize (RFC2001, sec.2)
   m_nextTxSequence = m_txBuffer.HeadSequence (); // Restart from highest Ack
   m_rtt->IncreaseMultiplier ();             // Double the next RTO
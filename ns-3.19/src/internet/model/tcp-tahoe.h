@@ -85,7 +85,6 @@ protected:
   TracedValue<uint32_t>  m_cWnd;         //!< Congestion window
   uint32_t               m_ssThresh;     //!< Slow Start Threshold
   uint32_t               m_initialCWnd;  //!< Initial cWnd value
-  uint32_t               m_retxThresh;   //!< Fast Retransmit threshold
 };
 
 } // namespace ns3
@@ -53,7 +53,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_firstByteSeq (n), m_size (0), m_maxBuffer (32768), m_data (0)
+  : m_firstByteSeq (n), m_firstByteOffset (0), m_size (0), m_maxBuffer (32768),
+    m_sackedBytes (0)
 {
 }
 
@@ -107,7 +108,10 @@ TcpTxBuffer::Add (Ptr<Packet> p)
     {
       if (p->GetSize () > 0)
         {
-          m_data.push_back (p);
+          Chunk chunk;
+          chunk.offset = m_firstByteOffset + m_size;
+          chunk.data = p;
+          m_data.push_back (chunk);
           m_size += p->GetSize ();
           NS_LOG_LOGIC ("Updated size=" << m_size << ", lastSeq=" << m_firstByteSeq + SequenceNumber32 (m_size));
         }
@@ -129,6 +133,31 @@ TcpTxBuffer::SizeFromSequence (const SequenceNumber32& seq) const
   return lastSeq - seq;
 }
 
+TcpTxBuffer::BufIterator
+TcpTxBuffer::Find (uint32_t offset) const
+{
+  // Offsets are compared relative to the first packet, to be safe from wrap around
+  uint32_t base = m_data.front ().offset;
+  BufIterator first = m_data.begin ();
+  uint32_t count = m_data.size ();
+  while (count > 0)
+    { // Binary search for the last packet starting at or before offset
+      uint32_t half = count / 2;
+      BufIterator middle = first + half;
+      if (middle->offset - base <= offset - base)
+        {
+          first = middle + 1;
+          count -= half + 1;
+        }
+      else
+        {
+          count = half;
+        }
+    }
+  NS_ASSERT (first != m_data.begin ());
+  return first - 1;
+}
+
 Ptr<Packet>
 TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
 {
@@ -144,54 +173,37 @@ TcpTxBuffer::CopyFromSequence (uint32_t numBytes, const SequenceNumber32& seq)
     }
 
   // Extract data from the buffer and return
-  uint32_t offset = seq - m_firstByteSeq.Get ();
-  uint32_t count = 0;      // Offset of the first byte of a packet in the buffer
-  uint32_t pktSize = 0;
-  bool beginFound = false;
-  int pktCount = 0;
-  Ptr<Packet> outPacket;
-  NS_LOG_LOGIC ("There are " << m_data.size () << " number of packets in buffer");
-  for (BufIterator i = m_data.begin (); i != m_data.end (); ++i)
+  uint32_t offset = m_firstByteOffset + (seq - m_firstByteSeq.Get ());
+  BufIterator i = Find (offset);
+  uint32_t packetOffset = offset - i->offset;
+  uint32_t pktSize = i->data->GetSize ();
+  NS_LOG_LOGIC ("First byte found at packet offset " << packetOffset << ", packet len=" << pktSize);
+  if (packetOffset == 0 && pktSize == s)
+    { // Data to be copied is exactly this packet
+      return i->data->Copy ();
+    }
+  if (pktSize - packetOffset >= s)
+    { // Data to be copied falls entirely in this packet
+      return i->data->CreateFragment (packetOffset, s);
+    }
+  // This packet only fulfills part of the request
+  Ptr<Packet> outPacket = i->data->CreateFragment (packetOffset, pktSize - packetOffset);
+  uint32_t remaining = s - outPacket->GetSize ();
+  while (remaining > 0)
     {
-      pktCount++;
-      pktSize = (*i)->GetSize ();
-      if (!beginFound)
-        { // Look for first fragment
-          if (count + pktSize > offset)
-            {
-              NS_LOG_LOGIC ("First byte found in packet #" << pktCount << " at buffer offset " << count
-                                                           << ", packet len=" << pktSize);
-              beginFound = true;
-              uint32_t packetOffset = offset - count;
-              uint32_t fragmentLength = count + pktSize - offset;
-              if (fragmentLength >= s)
-                { // Data to be copied falls entirely in this packet
-                  return (*i)->CreateFragment (packetOffset, s);
-                }
-              else
-                { // This packet only fulfills part of the request
-                  outPacket = (*i)->CreateFragment (packetOffset, fragmentLength);
-                }
-              NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-            }
-        }
-      else if (count + pktSize >= offset + s)
+      ++i;
+      pktSize = i->data->GetSize ();
+      if (pktSize > remaining)
         { // Last packet fragment found
-          NS_LOG_LOGIC ("Last byte found in packet #" << pktCount << " at buffer offset " << count
-                                                      << ", packet len=" << pktSize);
-          uint32_t fragmentLength = offset + s - count;
-          Ptr<Packet> endFragment = (*i)->CreateFragment (0, fragmentLength);
-          outPacket->AddAtEnd (endFragment);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
-          break;
+          outPacket->AddAtEnd (i->data->CreateFragment (0, remaining));
+          remaining = 0;
         }
       else
         {
-          NS_LOG_LOGIC ("Appending to output the packet #" << pktCount << " of offset " << count << " len=" << pktSize);
-          outPacket->AddAtEnd (*i);
-          NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
+          outPacket->AddAtEnd (i->data);
+          remaining -= pktSize;
         }
-      count += pktSize;
+      NS_LOG_LOGIC ("Output packet is now of size " << outPacket->GetSize ());
     }
   NS_ASSERT (outPacket->GetSize () == s);
   return outPacket;
@@ -213,40 +225,185 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
   // Cases do not need to scan the buffer
   if (m_firstByteSeq >= seq) return;
 
-  // Scan the buffer and discard packets
-  uint32_t offset = seq - m_firstByteSeq.Get ();  // Number of bytes to remove
-  uint32_t pktSize;
+  // Skip the acknowledged bytes (all of them when ACKing a FIN), and
+  // release the packets they were fully contained in
+  uint32_t offset = std::min<uint32_t> (seq - m_firstByteSeq.Get (), m_size);
+  m_firstByteOffset += offset;
+  m_size -= offset;
+  m_firstByteSeq = seq;
   NS_LOG_LOGIC ("Offset=" << offset);
-  BufIterator i = m_data.begin ();
-  while (i != m_data.end ())
+  while (!m_data.empty ()
+         && m_firstByteOffset - m_data.front ().offset >= m_data.front ().data->GetSize ())
     {
-      if (offset > (*i)->GetSize ())
-        { // This packet is behind the seqnum. Remove this packet from the buffer
-          pktSize = (*i)->GetSize ();
-          m_size -= pktSize;
-          offset -= pktSize;
-          m_firstByteSeq += pktSize;
-          i = m_data.erase (i);
-          NS_LOG_LOGIC ("Removed one packet of size " << pktSize << ", offset=" << offset);
-        }
-      else if (offset > 0)
-        { // Part of the packet is behind the seqnum. Fragment
-          pktSize = (*i)->GetSize () - offset;
-          *i = (*i)->CreateFragment (offset, pktSize);
-          m_size -= offset;
-          m_firstByteSeq += offset;
-          NS_LOG_LOGIC ("Fragmented one packet by size " << offset << ", new size=" << pktSize);
-          break;
-        }
+      NS_LOG_LOGIC ("Removed one packet of size " << m_data.front ().data->GetSize ());
+      m_data.pop_front ();
     }
-  // Catching the case of ACKing a FIN
-  if (m_size == 0)
+  // Forget the SACKed blocks now acknowledged
+  while (!m_sacked.empty () && m_sacked.begin ()->first < seq)
     {
-      m_firstByteSeq = seq;
+      Scoreboard::iterator first = m_sacked.begin ();
+      SequenceNumber32 right = first->second;
+      m_sackedBytes -= std::min (right, seq) - first->first;
+      m_sacked.erase (first);
+      if (right > seq)
+        {
+          m_sacked[seq] = right;
+          break;
+        }
     }
   NS_LOG_LOGIC ("size=" << m_size << " headSeq=" << m_firstByteSeq << " maxBuffer=" << m_maxBuffer
                         <<" numPkts="<< m_data.size ());
   NS_ASSERT (m_firstByteSeq == seq);
 }
 
+bool
+TcpTxBuffer::Sack (const TcpHeader::SackList &blocks)
+{
+  NS_LOG_FUNCTION (this);
+  bool updated = false;
+  for (TcpHeader::SackList::const_iterator b = blocks.begin (); b != blocks.end (); ++b)
+    {
+      // Ignore what was acknowledged already (D-SACK) and what was never sent
+      SequenceNumber32 left = std::max (b->first, m_firstByteSeq.Get ());
+      SequenceNumber32 right = std::min (b->second, TailSequence ());
+      if (left >= right)
+        {
+          continue;
+        }
+      // Merge with the interval starting before left, if it reaches it
+      Scoreboard::iterator i = m_sacked.upper_bound (left);
+      if (i != m_sacked.begin ())
+        {
+          Scoreboard::iterator previous = i;
+          --previous;
+          if (previous->second >= right)
+            { // Already SACKed
+              continue;
+            }
+          if (previous->second >= left)
+            {
+              left = previous->first;
+              m_sackedBytes -= previous->second - previous->first;
+              m_sacked.erase (previous);
+            }
+        }
+      // and with the intervals starting up to right
+      while (i != m_sacked.end () && i->first <= right)
+        {
+          right = std::max (right, i->second);
+          m_sackedBytes -= i->second - i->first;
+          m_sacked.erase (i++);
+        }
+      m_sacked[left] = right;
+      m_sackedBytes += right - left;
+      updated = true;
+      NS_LOG_LOGIC ("SACKed [" << left << "," << right << "), " << m_sackedBytes << " bytes SACKed");
+    }
+  return updated;
+}
+
+void
+TcpTxBuffer::ResetScoreboard (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sacked.clear ();
+  m_sackedBytes = 0;
+}
+
+uint32_t
+TcpTxBuffer::SackedBytes (void) const
+{
+  return m_sackedBytes;
+}
+
+SequenceNumber32
+TcpTxBuffer::LossBoundary (uint32_t dupThresh, uint32_t segmentSize) const
+{
+  // Walk down from the highest block until enough is SACKed above
+  uint32_t blocks = 0;
+  uint32_t bytes = 0;
+  for (Scoreboard::const_reverse_iterator i = m_sacked.rbegin (); i != m_sacked.rend (); ++i)
+    {
+      blocks++;
+      bytes += i->second - i->first;
+      if (blocks >= dupThresh || bytes > (dupThresh - 1) * segmentSize)
+        {
+          return i->first;
+        }
+    }
+  return m_firstByteSeq;
+}
+
+uint32_t
+TcpTxBuffer::UnsackedBytes (const SequenceNumber32& from, const SequenceNumber32& to) const
+{
+  if (to <= from)
+    {
+      return 0;
+    }
+  uint32_t bytes = to - from;
+  Scoreboard::const_iterator i = m_sacked.upper_bound (from);
+  if (i != m_sacked.begin ())
+    {
+      --i;
+      if (i->second <= from)
+        {
+          ++i;
+        }
+    }
+  for (; i != m_sacked.end () && i->first < to; ++i)
+    {
+      bytes -= std::min (i->second, to) - std::max (i->first, from);
+    }
+  return bytes;
+}
+
+bool
+TcpTxBuffer::IsLost (const SequenceNumber32& seq, uint32_t dupThresh, uint32_t segmentSize) const
+{
+  uint32_t length;
+  return seq < LossBoundary (dupThresh, segmentSize) && NextUnsacked (seq, length) == seq;
+}
+
+bool
+TcpTxBuffer::NextLostSegment (const SequenceNumber32& from, uint32_t dupThresh, uint32_t segmentSize,
+                              SequenceNumber32& seq, uint32_t& length) const
+{
+  NS_LOG_FUNCTION (this << from);
+  SequenceNumber32 hole = NextUnsacked (std::max (from, m_firstByteSeq.Get ()), length);
+  if (hole >= LossBoundary (dupThresh, segmentSize))
+    {
+      return false;
+    }
+  seq = hole;
+  length = std::min (length, segmentSize);
+  return true;
+}
+
+SequenceNumber32
+TcpTxBuffer::NextUnsacked (const SequenceNumber32& seq, uint32_t& length) const
+{
+  SequenceNumber32 hole = seq;
+  Scoreboard::const_iterator i = m_sacked.upper_bound (seq);
+  if (i != m_sacked.begin ())
+    {
+      Scoreboard::const_iterator previous = i;
+      --previous;
+      if (previous->second > hole)
+        { // seq is SACKed, the next block starts after the hole
+          hole = previous->second;
+        }
+    }
+  length = (i != m_sacked.end ()) ? i->first - hole : SizeFromSequence (hole);
+  return hole;
+}
+
+uint32_t
+TcpTxBuffer::Pipe (const SequenceNumber32& highTx, const SequenceNumber32& highRxt,
+                   uint32_t dupThresh, uint32_t segmentSize) const
+{
+  SequenceNumber32 lost = std::min (LossBoundary (dupThresh, segmentSize), highTx);
+  return UnsackedBytes (lost, highTx) + UnsackedBytes (m_firstByteSeq, std::min (highRxt, lost));
+}
+
 } // namepsace ns3
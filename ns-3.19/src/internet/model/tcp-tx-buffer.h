@@ -21,12 +21,14 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
-#include <list>
+#include <deque>
+#include <map>
 #include "ns3/traced-value.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/object.h"
 #include "ns3/sequence-number.h"
 #include "ns3/ptr.h"
+#include "ns3/tcp-header.h"
 
 namespace ns3 {
 class Packet;
@@ -36,6 +38,16 @@ class Packet;
  *
  * \brief class for keeping the data sent by the application to the TCP socket, i.e.
  *        the sending buffer.
+ *
+ * The packets added by the application are kept as they are, together with
+ * their offset in the byte stream, so that a segment is found by a binary
+ * search and, when it falls within a single packet, is a fragment sharing
+ * the data of that packet.  Acknowledged bytes are only skipped, the packets
+ * are released once all their bytes have been acknowledged.
+ *
+ * The buffer also keeps the SACK scoreboard of the connection (RFC 6675):
+ * the blocks of data the receiver reported with SACK options, merged into
+ * disjoint intervals ordered by sequence number.
  */
 class TcpTxBuffer : public Object
 {
@@ -127,14 +139,122 @@ public:
    */
   void DiscardUpTo (const SequenceNumber32& seq);
 
+  // SACK scoreboard (RFC 6675)
+
+  /**
+   * Record the blocks of a SACK option in the scoreboard
+   *
+   * \param blocks the SACK blocks, clipped to the data in the buffer
+   * \returns true if data not SACKed before was SACKed
+   */
+  bool Sack (const TcpHeader::SackList &blocks);
+
+  /**
+   * Forget all the SACKed blocks, e.g. on a retransmission timeout (RFC 2018)
+   */
+  void ResetScoreboard (void);
+
+  /**
+   * Returns the number of SACKed bytes
+   * \returns the number of bytes SACKed above the head sequence
+   */
+  uint32_t SackedBytes (void) const;
+
+  /**
+   * Whether a byte is deemed lost (RFC 6675 IsLost): it is not SACKed and
+   * either dupThresh discontiguous blocks or more than
+   * (dupThresh - 1) * segmentSize bytes are SACKed above it
+   *
+   * \param seq sequence number of the byte
+   * \param dupThresh the duplicate ACK threshold
+   * \param segmentSize the sender maximum segment size
+   * \returns true if the byte is deemed lost
+   */
+  bool IsLost (const SequenceNumber32& seq, uint32_t dupThresh, uint32_t segmentSize) const;
+
+  /**
+   * Find the next lost data to retransmit (RFC 6675 NextSeg, rule 1)
+   *
+   * \param from the lowest sequence number to consider (HighRxt)
+   * \param dupThresh the duplicate ACK threshold
+   * \param segmentSize the sender maximum segment size
+   * \param seq set to the first lost byte at or after from
+   * \param length set to the number of bytes to send, at most segmentSize
+   *        and not running into SACKed data
+   * \returns false if no data at or after from is deemed lost
+   */
+  bool NextLostSegment (const SequenceNumber32& from, uint32_t dupThresh, uint32_t segmentSize,
+                        SequenceNumber32& seq, uint32_t& length) const;
+
+  /**
+   * Skip the SACKed data
+   *
+   * \param seq a sequence number
+   * \param length set to the number of bytes until the next SACKed block,
+   *        or to the end of the buffer
+   * \returns the first byte at or after seq which is not SACKed
+   */
+  SequenceNumber32 NextUnsacked (const SequenceNumber32& seq, uint32_t& length) const;
+
+  /**
+   * Estimate the bytes in the network (RFC 6675 SetPipe): the bytes sent
+   * and neither acknowledged, SACKed nor deemed lost, plus the lost bytes
+   * retransmitted
+   *
+   * \param highTx the sequence number following the last byte sent
+   * \param highRxt the sequence number following the last byte retransmitted
+   * \param dupThresh the duplicate ACK threshold
+   * \param segmentSize the sender maximum segment size
+   * \returns the number of bytes in the network
+   */
+  uint32_t Pipe (const SequenceNumber32& highTx, const SequenceNumber32& highRxt,
+                 uint32_t dupThresh, uint32_t segmentSize) const;
+
 private:
+  /// a packet added to the buffer and the stream offset of its first byte
+  struct Chunk
+  {
+    uint32_t offset;  //!< Stream offset of the first byte of the packet
+    Ptr<Packet> data; //!< The packet added by the application
+  };
+
   /// container for data stored in the buffer
-  typedef std::list<Ptr<Packet> >::iterator BufIterator;
+  typedef std::deque<Chunk>::const_iterator BufIterator;
+
+  /**
+   * Find the packet holding a byte of the buffer
+   * \param offset stream offset of the byte
+   * \returns the packet holding the byte
+   */
+  BufIterator Find (uint32_t offset) const;
+
+  /// SACKed intervals [left, right), indexed by their left edge
+  typedef std::map<SequenceNumber32, SequenceNumber32> Scoreboard;
+
+  /**
+   * Returns the lowest sequence number below which unSACKed bytes are lost
+   * \param dupThresh the duplicate ACK threshold
+   * \param segmentSize the sender maximum segment size
+   * \returns the left edge of the block making the bytes below it lost,
+   *          or the head sequence if none
+   */
+  SequenceNumber32 LossBoundary (uint32_t dupThresh, uint32_t segmentSize) const;
+
+  /**
+   * Returns the number of bytes not SACKed in a range
+   * \param from first sequence number of the range
+   * \param to sequence number following the range
+   * \returns the number of bytes of [from, to) not SACKed
+   */
+  uint32_t UnsackedBytes (const SequenceNumber32& from, const SequenceNumber32& to) const;
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
+  uint32_t m_firstByteOffset;                   //!< Stream offset of the first byte in data
   uint32_t m_size;                              //!< Number of data bytes
   uint32_t m_maxBuffer;                         //!< Max number of data bytes in buffer (SND.WND)
-  std::list<Ptr<Packet> > m_data;               //!< Corresponding data (may be null)
+  std::deque<Chunk> m_data;                     //!< Corresponding data, the first packet may start before the first byte
+  Scoreboard m_sacked;                          //!< SACKed intervals above the first byte
+  uint32_t m_sackedBytes;                       //!< Number of SACKed bytes
 };
 
 } // namepsace ns3
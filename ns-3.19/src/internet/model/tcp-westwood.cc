@@ -153,6 +153,7 @@ TcpWestwood::NewAck (const SequenceNumber32& seq)
     {// First new ACK after fast recovery, reset cwnd as in Reno
       m_cWnd = m_ssThresh;
       m_inFastRec = false;
+      ExitSackRecovery ();
       NS_LOG_INFO ("Reset cwnd to " << m_cWnd);
     };
 
@@ -270,7 +271,7 @@ TcpWestwood::DupAck (const TcpHeader& header, uint32_t count)
 {
   NS_LOG_FUNCTION (this << count << m_cWnd);
 
-  if (count == 3 && !m_inFastRec)
+  if ((count == 3 || SackDetectsLoss ()) && !m_inFastRec)
     {// Triple duplicate ACK triggers fast retransmit
      // Adjust cwnd and ssthresh based on the estimated BW
       m_ssThresh = m_currentBW * static_cast<double> (m_minRtt.GetSeconds());
@@ -280,7 +281,19 @@ TcpWestwood::DupAck (const TcpHeader& header, uint32_t count)
         }
       m_inFastRec = true;
       NS_LOG_INFO ("Triple dupack. Enter fast recovery mode. Reset cwnd to " << m_cWnd <<", ssthresh to " << m_ssThresh);
+      if (m_sackPermitted)
+        { // The pipe accounts for the SACKed segments, no window inflation (RFC6675)
+          EnterSackRecovery ();
+        }
       DoRetransmit ();
+      if (m_sackRecovery)
+        {
+          SendPendingData (m_connected);
+        }
+    }
+  else if (m_inFastRec && m_sackRecovery)
+    { // The SACK blocks of the dupack have shrunk the pipe
+      SendPendingData (m_connected);
     }
   else if (m_inFastRec)
     {// Increase cwnd for every additional DUPACK as in Reno
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-end-point-demux.h"
+
+using namespace ns3;
+
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux lookups")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+  interface->SetDevice (CreateObject<SimpleNetDevice> ());
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+
+  Ipv4EndPoint *listener = demux.Allocate (80);
+  Ipv4EndPoint *connected = demux.Allocate (local, 80, peer, 1234);
+  NS_TEST_ASSERT_MSG_NE (connected, (Ipv4EndPoint *) 0, "Allocation failed");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80, peer, 1234), (Ipv4EndPoint *) 0, "Duplicate four-tuple allocated");
+
+  Ipv4EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of endpoints");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), connected, "Exact match not preferred");
+  found = demux.Lookup (local, 80, peer, 1235, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of endpoints");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), listener, "Wildcard match not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, 81, peer, 1234, interface).size (), 0, "Unbound port matched");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1234), connected, "Exact match not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 81, peer, 1234), (Ipv4EndPoint *) 0, "Unbound port matched");
+
+  // the four-tuple index follows the endpoint when it connects
+  Ipv4EndPoint *client = demux.Allocate (local);
+  uint16_t port = client->GetLocalPort ();
+  client->SetPeer (peer, 80);
+  client->SetLocalAddress (local);
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, port, peer, 80), client, "Connected endpoint not found");
+  found = demux.Lookup (local, port, peer, 80, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of endpoints");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), client, "Connected endpoint not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, port, peer, 81, interface).size (), 0, "Wrong peer matched");
+
+  // an endpoint bound to another device is skipped
+  connected->BindToNetDevice (CreateObject<SimpleNetDevice> ());
+  found = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.front (), listener, "Endpoint bound to another device matched");
+
+  demux.DeAllocate (connected);
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1234), listener, "Deallocated endpoint found");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), true, "Port of the listener not in use");
+  demux.DeAllocate (listener);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Port without endpoints in use");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (local, port), true, "Local address and port not in use");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetAllEndPoints ().size (), 1, "Wrong number of endpoints");
+}
+
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux lookups")
+{
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6EndPointDemux demux;
+  Ptr<Ipv6Interface> interface = CreateObject<Ipv6Interface> ();
+  interface->SetDevice (CreateObject<SimpleNetDevice> ());
+  Ipv6Address local ("2001:1::1");
+  Ipv6Address peer ("2001:1::2");
+
+  Ipv6EndPoint *listener = demux.Allocate (80);
+  Ipv6EndPoint *bound = demux.Allocate (local, 80);
+  Ipv6EndPoint *connected = demux.Allocate (local, 80, peer, 1234);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80), (Ipv6EndPoint *) 0, "Duplicate address and port allocated");
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (local, 80, peer, 1234), (Ipv6EndPoint *) 0, "Duplicate four-tuple allocated");
+
+  Ipv6EndPointDemux::EndPoints found = demux.Lookup (local, 80, peer, 1234, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of endpoints");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), connected, "Exact match not preferred");
+  found = demux.Lookup (local, 80, peer, 1235, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of endpoints");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), bound, "Local address match not preferred");
+  found = demux.Lookup (Ipv6Address ("2001:1::3"), 80, peer, 1235, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of endpoints");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), listener, "Wildcard match not found");
+
+  // the port index follows the endpoint when its local port changes
+  bound->SetLocalPort (8080);
+  found = demux.Lookup (local, 80, peer, 1235, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.front (), listener, "Endpoint found on its old port");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupLocal (local, 8080), true, "New local port not in use");
+  found = demux.Lookup (local, 8080, peer, 1235, interface);
+  NS_TEST_ASSERT_MSG_EQ (found.size (), 1, "Wrong number of endpoints");
+  NS_TEST_ASSERT_MSG_EQ (found.front (), bound, "Endpoint not found on its new port");
+
+  // the four-tuple index follows the endpoint when it connects
+  bound->SetPeer (peer, 1235);
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 8080, peer, 1235), bound, "Connected endpoint not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, 8080, peer, 1236, interface).size (), 0, "Wrong peer matched");
+
+  demux.DeAllocate (connected);
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1234), listener, "Deallocated endpoint found");
+  demux.DeAllocate (listener);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (80), false, "Port without endpoints in use");
+  NS_TEST_ASSERT_MSG_EQ (demux.GetEndPoints ().size (), 1, "Wrong number of endpoints");
+}
+
+static class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ()
+    : TestSuite ("end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+  }
+} g_endPointDemuxTestSuite;
@@ -53,9 +53,13 @@
 #include "ns3/udp-l4-protocol.h"
 
 #include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-extension.h"
+#include "ns3/ipv6-extension-demux.h"
+#include "ns3/ipv6-extension-header.h"
 #include "ns3/icmpv6-l4-protocol.h"
 
 #include <string>
+#include <vector>
 #include <limits>
 #include <netinet/in.h>
 
@@ -410,6 +414,138 @@ Ipv6FragmentationTest::DoRun (void)
     }
 
 
+  Simulator::Destroy ();
+}
+//-----------------------------------------------------------------------------
+/**
+ * Feed the fragments of packets straight to Ipv6ExtensionFragment: out of
+ * order and duplicated fragments are reassembled, an overlapping fragment
+ * discards the packet, and the oldest packets are given up when the
+ * reassembly memory is full.
+ */
+class Ipv6FragmentReassemblyTest : public TestCase
+{
+public:
+  virtual void DoRun (void);
+  Ipv6FragmentReassemblyTest ();
+
+private:
+  /// fragment a packet of the given size
+  std::vector<Ptr<Packet> > Fragment (uint32_t size);
+  /// deliver a fragment, return the reassembled packet if any
+  Ptr<Packet> Deliver (Ptr<Packet> fragment);
+  void DropTrace (Ptr<const Packet> packet);
+
+  Ptr<Ipv6ExtensionFragment> m_extension;
+  uint32_t m_drops;
+};
+
+Ipv6FragmentReassemblyTest::Ipv6FragmentReassemblyTest ()
+  : TestCase ("Reassemble IPv6 fragments out of order, with overlaps and limited memory")
+{
+}
+
+std::vector<Ptr<Packet> >
+Ipv6FragmentReassemblyTest::Fragment (uint32_t size)
+{
+  uint8_t *data = new uint8_t[size];
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = i % 253;
+    }
+  Ptr<Packet> p = Create<Packet> (data, size);
+  delete [] data;
+  Ipv6Header header;
+  header.SetSourceAddress (Ipv6Address ("2001::2"));
+  header.SetDestinationAddress (Ipv6Address ("2001::1"));
+  header.SetNextHeader (UdpL4Protocol::PROT_NUMBER);
+  header.SetPayloadLength (size);
+  p->AddHeader (header);
+  std::list<Ptr<Packet> > fragments;
+  m_extension->GetFragments (p, 1280, fragments);
+  return std::vector<Ptr<Packet> > (fragments.begin (), fragments.end ());
+}
+
+Ptr<Packet>
+Ipv6FragmentReassemblyTest::Deliver (Ptr<Packet> fragment)
+{
+  Ptr<Packet> p = fragment->Copy ();
+  Ipv6Header header;
+  p->RemoveHeader (header);
+  uint8_t nextHeader;
+  bool isDropped = false;
+  m_extension->Process (p, 0, header, header.GetDestinationAddress (), &nextHeader, isDropped);
+  return isDropped ? 0 : p;
+}
+
+void
+Ipv6FragmentReassemblyTest::DropTrace (Ptr<const Packet> packet)
+{
+  m_drops++;
+}
+
+void
+Ipv6FragmentReassemblyTest::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  AddInternetStack (node);
+  m_extension = DynamicCast<Ipv6ExtensionFragment> (node->GetObject<Ipv6ExtensionDemux> ()->GetExtension (Ipv6Header::IPV6_EXT_FRAGMENTATION));
+  m_extension->TraceConnectWithoutContext ("Drop", MakeCallback (&Ipv6FragmentReassemblyTest::DropTrace, this));
+  m_drops = 0;
+
+  // out of order, with a duplicate
+  std::vector<Ptr<Packet> > fragments = Fragment (4000);
+  NS_TEST_ASSERT_MSG_EQ (fragments.size (), 4, "Wrong number of fragments");
+  Ptr<Packet> p;
+  NS_TEST_EXPECT_MSG_EQ (Deliver (fragments[3]), 0, "Reassembled too early");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (fragments[1]), 0, "Reassembled too early");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (fragments[1]), 0, "Reassembled too early");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (fragments[0]), 0, "Reassembled too early");
+  p = Deliver (fragments[2]);
+  NS_TEST_ASSERT_MSG_NE (p, 0, "Not reassembled");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 4000, "Wrong reassembled size");
+  uint8_t *data = new uint8_t[4000];
+  p->CopyData (data, 4000);
+  bool intact = true;
+  for (uint32_t i = 0; i < 4000; i++)
+    {
+      intact = intact && data[i] == i % 253;
+    }
+  delete [] data;
+  NS_TEST_EXPECT_MSG_EQ (intact, true, "Reassembled data corrupted");
+  NS_TEST_EXPECT_MSG_EQ (m_extension->GetReassemblyBytes (), 0, "Reassembly memory not released");
+
+  // a fragment overlapping the first one discards the packet
+  fragments = Fragment (4000);
+  Ipv6Header header;
+  Ipv6ExtensionFragmentHeader fragmentHeader;
+  Ptr<Packet> overlap = fragments[1]->Copy ();
+  overlap->RemoveHeader (header);
+  overlap->RemoveHeader (fragmentHeader);
+  fragmentHeader.SetOffset (fragmentHeader.GetOffset () - 8);
+  overlap->AddHeader (fragmentHeader);
+  overlap->AddHeader (header);
+  Deliver (fragments[0]);
+  Deliver (overlap);
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "Overlapping fragment not dropped");
+  NS_TEST_EXPECT_MSG_EQ (m_extension->GetReassemblyBytes (), 0, "Fragments of the discarded packet kept");
+  Deliver (fragments[1]);
+  Deliver (fragments[2]);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (fragments[3]), 0, "Packet reassembled without its first fragment");
+
+  // the oldest packets are given up to stay below the memory limit
+  m_extension->SetAttribute ("MaxReassemblyBytes", UintegerValue (2000));
+  m_drops = 0;
+  std::vector<Ptr<Packet> > first = Fragment (2000);
+  std::vector<Ptr<Packet> > second = Fragment (2000);
+  NS_TEST_EXPECT_MSG_NE (Deliver (fragments[0]), 0, "Packet not reassembled after the overlap");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (first[0]), 0, "Reassembled too early");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (second[0]), 0, "Reassembled too early");
+  NS_TEST_EXPECT_MSG_GT (m_drops, 0, "Nothing dropped");
+  NS_TEST_EXPECT_MSG_LT (m_extension->GetReassemblyBytes (), 2001, "Memory limit exceeded");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (first[1]), 0, "Packet reassembled after being dropped");
+  NS_TEST_EXPECT_MSG_NE (Deliver (second[1]), 0, "Newest packet not reassembled");
+
   Simulator::Destroy ();
 }
 //-----------------------------------------------------------------------------
@@ -419,5 +555,6 @@ public:
   Ipv6FragmentationTestSuite () : TestSuite ("ipv6-fragmentation", UNIT)
   {
     AddTestCase (new Ipv6FragmentationTest, TestCase::QUICK);
+    AddTestCase (new Ipv6FragmentReassemblyTest, TestCase::QUICK);
   }
 } g_ipv6fragmentationTestSuite;
@@ -0,0 +1,290 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/simulation-singleton.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv6-list-routing-helper.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/ipv6-global-routing-helper.h"
+#include "ns3/ipv6-global-routing.h"
+#include "ns3/ipv6-global-route-manager-impl.h"
+#include "ns3/ipv6-route.h"
+#include "ndisc-net-device.h"
+
+using namespace ns3;
+
+class Ipv6GlobalRoutingTableTestCase : public TestCase
+{
+public:
+  Ipv6GlobalRoutingTableTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6GlobalRoutingTableTestCase::Ipv6GlobalRoutingTableTestCase ()
+  : TestCase ("Ipv6GlobalRouting longest prefix match")
+{
+}
+
+void
+Ipv6GlobalRoutingTableTestCase::DoRun (void)
+{
+  Ptr<Ipv6GlobalRouting> routing = CreateObject<Ipv6GlobalRouting> ();
+  routing->AddNetworkRouteTo ("2001:1::", Ipv6Prefix (32), "fe80::1", 1);
+  routing->AddNetworkRouteTo ("2001:1:2::", Ipv6Prefix (48), "fe80::2", 2);
+  routing->AddHostRouteTo ("2001:1:2::5", "fe80::3", 3);
+  routing->AddNetworkRouteTo ("2001:1:2::", Ipv6Prefix (48), "fe80::4", 2);
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 3, "A route to the same network was not replaced");
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRoute (0).GetGateway (), Ipv6Address ("fe80::3"), "Routes not longest prefix first");
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRoute (1).GetGateway (), Ipv6Address ("fe80::4"), "Routes not longest prefix first");
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRoute (2).GetDestNetworkPrefix (), Ipv6Prefix (32), "Routes not longest prefix first");
+  NS_TEST_ASSERT_MSG_EQ (routing->RemoveRoute ("2001:1:2::", Ipv6Prefix (48)), true, "Route not removed");
+  NS_TEST_ASSERT_MSG_EQ (routing->RemoveRoute ("2001:1:2::", Ipv6Prefix (48)), false, "Route removed twice");
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 2, "Wrong number of routes");
+  routing->Dispose ();
+}
+
+/**
+ * Four routers on a ring, 0-1-2-3-0, the 3-0 link being ten times more
+ * expensive. Checks the routes, then their update when interfaces go
+ * down and up, and the number of SPF computations this takes.
+ */
+class Ipv6GlobalRoutingRingTestCase : public TestCase
+{
+public:
+  Ipv6GlobalRoutingRingTestCase ();
+private:
+  virtual void DoRun (void);
+  void SendTo (Ipv6Address dst);
+  void HandleRecv (Ptr<Socket> socket);
+  /// check the gateway of the route of a router to a destination
+  void CheckGateway (uint32_t router, Ipv6Address dst, Ipv6Address gateway);
+  /// check the number of SPF computations so far
+  void CheckSpfRuns (uint32_t runs);
+  /// check the number of route table updates since the last check
+  void CheckRouteUpdates (uint32_t updates);
+  void SetDown (uint32_t router, uint32_t interface);
+  /// set an interface up, with the addresses it lost when going down
+  void SetUp (uint32_t router, uint32_t interface, Ipv6Address linkLocal, Ipv6Address global);
+  void AddAddress (uint32_t router, uint32_t interface, Ipv6Address address);
+  /// link-local address of an interface of a router
+  Ipv6Address GetLinkLocal (uint32_t router, uint32_t interface);
+
+  NodeContainer m_routers;
+  Ptr<Socket> m_source;
+  uint32_t m_received;
+  uint32_t m_routeUpdates; //!< route table updates at the last check
+};
+
+Ipv6GlobalRoutingRingTestCase::Ipv6GlobalRoutingRingTestCase ()
+  : TestCase ("Ipv6GlobalRouting routes and incremental updates")
+{
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::SendTo (Ipv6Address dst)
+{
+  m_source->SendTo (Create<Packet> (100), 0, Inet6SocketAddress (dst, 1234));
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::HandleRecv (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+Ipv6Address
+Ipv6GlobalRoutingRingTestCase::GetLinkLocal (uint32_t router, uint32_t interface)
+{
+  return m_routers.Get (router)->GetObject<Ipv6> ()->GetAddress (interface, 0).GetAddress ();
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::CheckGateway (uint32_t router, Ipv6Address dst, Ipv6Address gateway)
+{
+  Ptr<Ipv6GlobalRouting> routing = Ipv6RoutingHelper::GetRouting<Ipv6GlobalRouting> (
+    m_routers.Get (router)->GetObject<Ipv6> ()->GetRoutingProtocol ());
+  Ptr<Ipv6Route> route = routing->LookupGlobal (dst);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route from " << router << " to " << dst
+                                                    << " at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), gateway, "Wrong gateway from " << router << " to " << dst
+                                                                              << " at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::CheckSpfRuns (uint32_t runs)
+{
+  NS_TEST_EXPECT_MSG_EQ (SimulationSingleton<Ipv6GlobalRouteManagerImpl>::Get ()->GetNSpfRuns (), runs,
+                         "Wrong number of SPF computations at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::CheckRouteUpdates (uint32_t updates)
+{
+  uint32_t total = SimulationSingleton<Ipv6GlobalRouteManagerImpl>::Get ()->GetNRouteUpdates ();
+  NS_TEST_EXPECT_MSG_EQ (total - m_routeUpdates, updates,
+                         "Wrong number of route table updates at " << Simulator::Now ().GetSeconds ());
+  m_routeUpdates = total;
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::SetDown (uint32_t router, uint32_t interface)
+{
+  m_routers.Get (router)->GetObject<Ipv6> ()->SetDown (interface);
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::SetUp (uint32_t router, uint32_t interface, Ipv6Address linkLocal, Ipv6Address global)
+{
+  Ptr<Ipv6> ipv6 = m_routers.Get (router)->GetObject<Ipv6> ();
+  ipv6->SetUp (interface);
+  ipv6->AddAddress (interface, Ipv6InterfaceAddress (linkLocal, Ipv6Prefix (64)));
+  ipv6->AddAddress (interface, Ipv6InterfaceAddress (global, Ipv6Prefix (64)));
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::AddAddress (uint32_t router, uint32_t interface, Ipv6Address address)
+{
+  m_routers.Get (router)->GetObject<Ipv6> ()->AddAddress (interface, Ipv6InterfaceAddress (address, Ipv6Prefix (64)));
+}
+
+void
+Ipv6GlobalRoutingRingTestCase::DoRun (void)
+{
+  m_routers.Create (4);
+  Ipv6ListRoutingHelper list;
+  list.Add (Ipv6StaticRoutingHelper (), 0);
+  list.Add (Ipv6GlobalRoutingHelper (), -10);
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.SetRoutingHelper (list);
+  internet.Install (m_routers);
+
+  // Link i joins router i (interface 2, or 1 for router 0) to router i+1
+  // (interface 1), on 2001:i+1::/64. The interfaces of link 3 cost 10.
+  Ipv6AddressHelper address;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      m_routers.Get (i)->GetObject<Ipv6> ()->SetAttribute ("IpForward", BooleanValue (true));
+    }
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer devices;
+      uint32_t ends[2] = { i, (i + 1) % 4 };
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<NdiscNetDevice> ();
+          device->SetAddress (Mac48Address::Allocate ());
+          device->SetChannel (channel);
+          m_routers.Get (ends[j])->AddDevice (device);
+          devices.Add (device);
+        }
+      std::ostringstream network;
+      network << "2001:" << i + 1 << "::";
+      address.SetBase (Ipv6Address (network.str ().c_str ()), Ipv6Prefix (64));
+      Ipv6InterfaceContainer interfaces = address.Assign (devices);
+      if (i == 3)
+        {
+          for (uint32_t j = 0; j < 2; j++)
+            {
+              m_routers.Get (ends[j])->GetObject<Ipv6> ()->SetMetric (interfaces.GetInterfaceIndex (j), 10);
+            }
+        }
+    }
+
+  Ipv6GlobalRoutingHelper::PopulateRoutingTables ();
+  CheckSpfRuns (4);
+  m_routeUpdates = 0;
+  CheckRouteUpdates (4);
+  Ptr<Ipv6GlobalRouting> routing = Ipv6RoutingHelper::GetRouting<Ipv6GlobalRouting> (
+    m_routers.Get (0)->GetObject<Ipv6> ()->GetRoutingProtocol ());
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 2, "Router 0 routes: only the links it is not on");
+  // router 0: interface 1 to router 1, interface 2 to router 3
+  CheckGateway (0, "2001:2::1", GetLinkLocal (1, 1));
+  CheckGateway (0, "2001:3::1", GetLinkLocal (1, 1));
+  CheckGateway (1, "2001:4::1", GetLinkLocal (0, 1));
+  CheckGateway (2, "2001:4::1", GetLinkLocal (3, 1));
+
+  m_received = 0;
+  Ptr<Socket> sink = Socket::CreateSocket (m_routers.Get (2), UdpSocketFactory::GetTypeId ());
+  sink->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 1234));
+  sink->SetRecvCallback (MakeCallback (&Ipv6GlobalRoutingRingTestCase::HandleRecv, this));
+  m_source = Socket::CreateSocket (m_routers.Get (0), UdpSocketFactory::GetTypeId ());
+  m_source->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 0));
+  Ipv6Address target = m_routers.Get (2)->GetObject<Ipv6> ()->GetAddress (1, 1).GetAddress ();
+  Simulator::Schedule (Seconds (1), &Ipv6GlobalRoutingRingTestCase::SendTo, this, target);
+
+  // Router 3 leaves link 3: only router 3 and router 2, which reached it
+  // through router 3, recompute their tree. Coming back shortens the way
+  // of the same two routers only. Router 1 refreshes its routes to link 3,
+  // router 0, which is on it, has none.
+  Simulator::Schedule (Seconds (2), &Ipv6GlobalRoutingRingTestCase::SetDown, this, 3, 2);
+  Simulator::Schedule (Seconds (2.5), &Ipv6GlobalRoutingRingTestCase::CheckSpfRuns, this, 6);
+  Simulator::Schedule (Seconds (2.5), &Ipv6GlobalRoutingRingTestCase::CheckRouteUpdates, this, 3);
+  Simulator::Schedule (Seconds (2.5), &Ipv6GlobalRoutingRingTestCase::CheckGateway, this, 1, "2001:4::1", GetLinkLocal (0, 1));
+  Simulator::Schedule (Seconds (2.5), &Ipv6GlobalRoutingRingTestCase::CheckGateway, this, 2, "2001:4::1", GetLinkLocal (1, 2));
+  Simulator::Schedule (Seconds (3), &Ipv6GlobalRoutingRingTestCase::SetUp, this, 3, 2,
+                       GetLinkLocal (3, 2), m_routers.Get (3)->GetObject<Ipv6> ()->GetAddress (2, 1).GetAddress ());
+  Simulator::Schedule (Seconds (3.5), &Ipv6GlobalRoutingRingTestCase::CheckSpfRuns, this, 8);
+  Simulator::Schedule (Seconds (3.5), &Ipv6GlobalRoutingRingTestCase::CheckRouteUpdates, this, 3);
+  Simulator::Schedule (Seconds (3.5), &Ipv6GlobalRoutingRingTestCase::CheckGateway, this, 2, "2001:4::1", GetLinkLocal (3, 1));
+
+  // Router 1 leaves link 1: router 0 goes around the ring
+  Simulator::Schedule (Seconds (4), &Ipv6GlobalRoutingRingTestCase::SetDown, this, 1, 2);
+  Simulator::Schedule (Seconds (4.5), &Ipv6GlobalRoutingRingTestCase::CheckGateway, this, 0, "2001:2::1", GetLinkLocal (3, 2));
+  Simulator::Schedule (Seconds (5), &Ipv6GlobalRoutingRingTestCase::SendTo, this, target);
+
+  // A new prefix needs no SPF computation, and only the routers away
+  // from its link, 0 and 1, refresh their routes
+  Simulator::Schedule (Seconds (6), &Ipv6GlobalRoutingRingTestCase::CheckSpfRuns, this, 12);
+  Simulator::Schedule (Seconds (6), &Ipv6GlobalRoutingRingTestCase::CheckRouteUpdates, this, 4);
+  Simulator::Schedule (Seconds (6), &Ipv6GlobalRoutingRingTestCase::AddAddress, this, 2, 2, "2001:99::1");
+  Simulator::Schedule (Seconds (6.5), &Ipv6GlobalRoutingRingTestCase::CheckSpfRuns, this, 12);
+  Simulator::Schedule (Seconds (6.5), &Ipv6GlobalRoutingRingTestCase::CheckRouteUpdates, this, 2);
+  Simulator::Schedule (Seconds (6.5), &Ipv6GlobalRoutingRingTestCase::CheckGateway, this, 0, "2001:99::1", GetLinkLocal (3, 2));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_received, 2, "Datagrams lost");
+}
+
+static class Ipv6GlobalRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv6GlobalRoutingTestSuite ()
+    : TestSuite ("ipv6-global-routing", UNIT)
+  {
+    AddTestCase (new Ipv6GlobalRoutingTableTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv6GlobalRoutingRingTestCase, TestCase::QUICK);
+  }
+} g_ipv6GlobalRoutingTestSuite;
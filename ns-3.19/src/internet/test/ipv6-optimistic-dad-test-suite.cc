@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/node.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/icmpv6-header.h"
+#include "ns3/icmpv6-l4-protocol.h"
+#include "ndisc-net-device.h"
+
+using namespace ns3;
+
+/**
+ * A host next to a router-less node. The host sends its Router
+ * Solicitation once the DAD of its link-local address is over, or at
+ * once, without Source Link-Layer Address option, with optimistic DAD.
+ * Without DAD, no probe and no Router Solicitation is sent at all.
+ */
+class Ipv6OptimisticDadTestCase : public TestCase
+{
+public:
+  Ipv6OptimisticDadTestCase ();
+private:
+  virtual void DoRun (void);
+  /// run the two nodes with the given DAD attributes
+  void Run (bool dad, bool optimistic);
+  void ReceiveFrame (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                     const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /// check the state of the link-local address of the host
+  void CheckState (Ipv6InterfaceAddress::State_e state);
+
+  Ptr<Ipv6Interface> m_interface;
+  uint32_t m_rs;
+  Time m_firstRs;
+  uint16_t m_rsSize; //!< IPv6 payload length of the first RS
+};
+
+Ipv6OptimisticDadTestCase::Ipv6OptimisticDadTestCase ()
+  : TestCase ("Optimistic and disabled Duplicate Address Detection")
+{
+}
+
+void
+Ipv6OptimisticDadTestCase::ReceiveFrame (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                         const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  Ptr<Packet> p = packet->Copy ();
+  Ipv6Header ipHeader;
+  p->RemoveHeader (ipHeader);
+  if (ipHeader.GetNextHeader () != Icmpv6L4Protocol::PROT_NUMBER)
+    {
+      return;
+    }
+  Icmpv6Header icmpHeader;
+  p->PeekHeader (icmpHeader);
+  if (icmpHeader.GetType () == Icmpv6Header::ICMPV6_ND_ROUTER_SOLICITATION)
+    {
+      if (m_rs == 0)
+        {
+          m_firstRs = Simulator::Now ();
+          m_rsSize = ipHeader.GetPayloadLength ();
+        }
+      m_rs++;
+    }
+}
+
+void
+Ipv6OptimisticDadTestCase::CheckState (Ipv6InterfaceAddress::State_e state)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_interface->GetLinkLocalAddress ().GetState (), state,
+                         "Wrong link-local state at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+Ipv6OptimisticDadTestCase::Run (bool dad, bool optimistic)
+{
+  m_rs = 0;
+  m_rsSize = 0;
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<Icmpv6L4Protocol> icmpv6 = nodes.Get (i)->GetObject<Icmpv6L4Protocol> ();
+      icmpv6->SetAttribute ("DAD", BooleanValue (dad));
+      icmpv6->SetAttribute ("OptimisticDad", BooleanValue (optimistic));
+    }
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<NdiscNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  nodes.Get (1)->RegisterProtocolHandler (MakeCallback (&Ipv6OptimisticDadTestCase::ReceiveFrame, this),
+                                          0, devices.Get (1));
+
+  Ptr<Ipv6L3Protocol> ipv6 = nodes.Get (0)->GetObject<Ipv6L3Protocol> ();
+  uint32_t index = ipv6->AddInterface (devices.Get (0));
+  ipv6->SetUp (index);
+  m_interface = ipv6->GetInterface (index);
+  ipv6 = nodes.Get (1)->GetObject<Ipv6L3Protocol> ();
+  ipv6->SetUp (ipv6->AddInterface (devices.Get (1)));
+
+  if (dad)
+    {
+      Ipv6InterfaceAddress::State_e tentative = optimistic ? Ipv6InterfaceAddress::TENTATIVE_OPTIMISTIC : Ipv6InterfaceAddress::TENTATIVE;
+      Simulator::Schedule (Seconds (0.5), &Ipv6OptimisticDadTestCase::CheckState, this, tentative);
+      Simulator::Schedule (Seconds (1.5), &Ipv6OptimisticDadTestCase::CheckState, this, Ipv6InterfaceAddress::PREFERRED);
+    }
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+Ipv6OptimisticDadTestCase::DoRun (void)
+{
+  // Standard DAD: RS with the SLLAO after the DAD timeout
+  Run (true, false);
+  NS_TEST_ASSERT_MSG_EQ (m_rs, 1, "Wrong number of RS");
+  NS_TEST_ASSERT_MSG_EQ ((m_firstRs >= Seconds (1)), true, "RS sent before the end of the DAD");
+  NS_TEST_ASSERT_MSG_EQ (m_rsSize, 16, "RS without SLLAO");
+
+  // Optimistic DAD: RS at once, without SLLAO (RFC 4429, sec. 3.2)
+  Run (true, true);
+  NS_TEST_ASSERT_MSG_EQ (m_rs, 1, "Wrong number of RS");
+  NS_TEST_ASSERT_MSG_LT (m_firstRs, Seconds (0.1), "RS waited for the DAD");
+  NS_TEST_ASSERT_MSG_EQ (m_rsSize, 8, "RS with a SLLAO from an optimistic address");
+
+  // No DAD
+  Run (false, false);
+  NS_TEST_ASSERT_MSG_EQ (m_rs, 0, "RS sent without DAD");
+}
+
+static class Ipv6OptimisticDadTestSuite : public TestSuite
+{
+public:
+  Ipv6OptimisticDadTestSuite ()
+    : TestSuite ("ipv6-optimistic-dad", UNIT)
+  {
+    AddTestCase (new Ipv6OptimisticDadTestCase, TestCase::QUICK);
+  }
+} g_ipv6OptimisticDadTestSuite;
@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-routing-table-entry.h"
+
+using namespace ns3;
+
+/**
+ * Bringing an interface down must remove every route through it, even
+ * when they are consecutive in the table, and keep the other routes.
+ */
+class Ipv6StaticRoutingInterfaceDownTestCase : public TestCase
+{
+public:
+  Ipv6StaticRoutingInterfaceDownTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6StaticRoutingInterfaceDownTestCase::Ipv6StaticRoutingInterfaceDownTestCase ()
+  : TestCase ("Remove the routes of an interface going down")
+{
+}
+
+void
+Ipv6StaticRoutingInterfaceDownTestCase::DoRun (void)
+{
+  Ptr<Ipv6StaticRouting> routing = CreateObject<Ipv6StaticRouting> ();
+  routing->AddNetworkRouteTo (Ipv6Address ("2001:1::"), Ipv6Prefix (64), 1);
+  routing->AddNetworkRouteTo (Ipv6Address ("2001:2::"), Ipv6Prefix (64), 2);
+  routing->AddNetworkRouteTo (Ipv6Address ("2001:3::"), Ipv6Prefix (64), 1);
+  routing->AddNetworkRouteTo (Ipv6Address ("2001:4::"), Ipv6Prefix (64), 1);
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 4, "Wrong number of routes");
+
+  routing->NotifyInterfaceDown (1);
+  NS_TEST_ASSERT_MSG_EQ (routing->GetNRoutes (), 1, "Routes of the interface left in the table");
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRoute (0).GetInterface (), 2, "Wrong route removed");
+  NS_TEST_ASSERT_MSG_EQ (routing->GetRoute (0).GetDestNetwork (), Ipv6Address ("2001:2::"), "Wrong route removed");
+}
+
+static class Ipv6StaticRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv6StaticRoutingTestSuite ()
+    : TestSuite ("ipv6-static-routing", UNIT)
+  {
+    AddTestCase (new Ipv6StaticRoutingInterfaceDownTestCase, TestCase::QUICK);
+  }
+} g_ipv6StaticRoutingTestSuite;
@@ -178,6 +178,53 @@ Ipv6L3ProtocolTestCase::DoRun ()
   num = interface2->GetNAddresses ();
   NS_TEST_ASSERT_MSG_EQ (num, 1, "Number of addresses should be 1??");
 
+  /* Interface lookups by device, address and prefix */
+  NS_TEST_ASSERT_MSG_EQ (ipv6->GetInterfaceForDevice (device), 1, "Wrong interface for device??");
+  NS_TEST_ASSERT_MSG_EQ (ipv6->GetInterfaceForDevice (device2), 2, "Wrong interface for device2??");
+  NS_TEST_ASSERT_MSG_EQ (ipv6->GetInterfaceForDevice (CreateObject<SimpleNetDevice> ()), -1,
+                         "A device without interface should not be found??");
+
+  index = ipv6->GetInterfaceForPrefix ("2001:1234:5678:9000::0", Ipv6Prefix (64));
+  NS_TEST_ASSERT_MSG_EQ (index, (uint32_t) -1, "Prefix of a removed address should not be found??");
+
+  /* the same prefix on two interfaces is found on the first one, until it is removed */
+  ipv6->AddAddress (2, Ipv6InterfaceAddress ("2001:aaaa::2", Ipv6Prefix (64)));
+  ipv6->AddAddress (1, Ipv6InterfaceAddress ("2001:aaaa::1", Ipv6Prefix (64)));
+  index = ipv6->GetInterfaceForPrefix ("2001:aaaa::", Ipv6Prefix (64));
+  NS_TEST_ASSERT_MSG_EQ (index, 1, "Prefix should be found on interface 1??");
+  ipv6->RemoveAddress (1, Ipv6Address ("2001:aaaa::1"));
+  index = ipv6->GetInterfaceForPrefix ("2001:aaaa::", Ipv6Prefix (64));
+  NS_TEST_ASSERT_MSG_EQ (index, 2, "Prefix should be found on interface 2??");
+  index = ipv6->GetInterfaceForAddress ("2001:aaaa::1");
+  NS_TEST_ASSERT_MSG_EQ (index, (uint32_t) -1, "Removed address should not be found??");
+  index = ipv6->GetInterfaceForAddress ("2001:aaaa::2");
+  NS_TEST_ASSERT_MSG_EQ (index, 2, "Address should be found on interface 2??");
+
+  /* a prefix stays on an interface while another of its addresses holds it */
+  ipv6->AddAddress (1, Ipv6InterfaceAddress ("2001:bbbb::1", Ipv6Prefix (64)));
+  ipv6->AddAddress (1, Ipv6InterfaceAddress ("2001:bbbb::2", Ipv6Prefix (64)));
+  ipv6->RemoveAddress (1, Ipv6Address ("2001:bbbb::1"));
+  index = ipv6->GetInterfaceForPrefix ("2001:bbbb::", Ipv6Prefix (64));
+  NS_TEST_ASSERT_MSG_EQ (index, 1, "Prefix should still be found on interface 1??");
+
+  /* a down interface has no address left */
+  Ipv6Address linkLocal = interface->GetLinkLocalAddress ().GetAddress ();
+  ipv6->SetDown (1);
+  index = ipv6->GetInterfaceForAddress ("2001:bbbb::2");
+  NS_TEST_ASSERT_MSG_EQ (index, (uint32_t) -1, "Address of a down interface should not be found??");
+  /* both devices have the same MAC address, hence the same link-local address */
+  NS_TEST_ASSERT_MSG_EQ (interface2->GetLinkLocalAddress ().GetAddress (), linkLocal, "Different link-local addresses??");
+  index = ipv6->GetInterfaceForAddress (linkLocal);
+  NS_TEST_ASSERT_MSG_EQ (index, 2, "Link-local address should be found on interface 2 only??");
+  index = ipv6->GetInterfaceForPrefix ("2001:bbbb::", Ipv6Prefix (64));
+  NS_TEST_ASSERT_MSG_EQ (index, (uint32_t) -1, "Prefix of a down interface should not be found??");
+  index = ipv6->GetInterfaceForPrefix ("2001:aaaa::", Ipv6Prefix (64));
+  NS_TEST_ASSERT_MSG_EQ (index, 2, "Prefix should still be found on interface 2??");
+  ipv6->SetUp (1);
+  ipv6->AddAddress (1, Ipv6InterfaceAddress ("2001:bbbb::2", Ipv6Prefix (64)));
+  index = ipv6->GetInterfaceForPrefix ("2001:bbbb::", Ipv6Prefix (64));
+  NS_TEST_ASSERT_MSG_EQ (index, 1, "Prefix should be found on interface 1 again??");
+
   Simulator::Destroy ();
 } //end DoRun
 static class IPv6L3ProtocolTestSuite : public TestSuite
@@ -0,0 +1,244 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ndisc-cache.h"
+#include "ndisc-net-device.h"
+
+using namespace ns3;
+
+/**
+ * Two nodes on a link, node 0 sending UDP datagrams to node 1. Checks
+ * the resolution and the Neighbor Unreachability Detection with the
+ * shared timers, the bound on the packets waiting for a resolution, and
+ * the static entries.
+ */
+class NdiscCacheTestCase : public TestCase
+{
+public:
+  NdiscCacheTestCase ();
+private:
+  virtual void DoRun (void);
+  /// build the two nodes
+  void Setup (bool sharedTimers);
+  void SendTo (Ipv6Address dst, uint32_t count);
+  void HandleRecv (Ptr<Socket> socket);
+  void CountFrames (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                    const Address &from, const Address &to, NetDevice::PacketType packetType);
+  void ResetFrames (void);
+  void CountDrops (Ptr<const Packet> packet);
+  /// check the state of the entry of node 0 for dst
+  void CheckEntry (Ipv6Address dst, bool exists, bool reachable, bool stale);
+
+  NodeContainer m_nodes;
+  NetDeviceContainer m_devices;
+  Ipv6InterfaceContainer m_interfaces;
+  Ptr<NdiscCache> m_cache;
+  Ptr<Socket> m_source;
+  uint32_t m_received;
+  uint32_t m_frames;
+  uint32_t m_drops;
+};
+
+NdiscCacheTestCase::NdiscCacheTestCase ()
+  : TestCase ("NdiscCache shared timers, waiting packets and static entries")
+{
+}
+
+void
+NdiscCacheTestCase::SendTo (Ipv6Address dst, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    {
+      m_source->SendTo (Create<Packet> (100), 0, Inet6SocketAddress (dst, 1234));
+    }
+}
+
+void
+NdiscCacheTestCase::HandleRecv (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+NdiscCacheTestCase::CountFrames (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                 const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_frames++;
+}
+
+void
+NdiscCacheTestCase::ResetFrames (void)
+{
+  m_frames = 0;
+}
+
+void
+NdiscCacheTestCase::CountDrops (Ptr<const Packet> packet)
+{
+  m_drops++;
+}
+
+void
+NdiscCacheTestCase::CheckEntry (Ipv6Address dst, bool exists, bool reachable, bool stale)
+{
+  NdiscCache::Entry *entry = m_cache->Lookup (dst);
+  NS_TEST_EXPECT_MSG_EQ ((entry != 0), exists, "Wrong entry for " << dst << " at " << Simulator::Now ().GetSeconds ());
+  if (entry != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (entry->IsReachable (), reachable, "Wrong REACHABLE state at " << Simulator::Now ().GetSeconds ());
+      NS_TEST_EXPECT_MSG_EQ (entry->IsStale (), stale, "Wrong STALE state at " << Simulator::Now ().GetSeconds ());
+    }
+}
+
+void
+NdiscCacheTestCase::Setup (bool sharedTimers)
+{
+  m_nodes = NodeContainer ();
+  m_nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  m_devices = NetDeviceContainer ();
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<NdiscNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      m_nodes.Get (i)->AddDevice (device);
+      m_devices.Add (device);
+    }
+  Ipv6AddressHelper address;
+  address.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  m_interfaces = address.Assign (m_devices);
+
+  Ptr<Ipv6L3Protocol> ipv6 = m_nodes.Get (0)->GetObject<Ipv6L3Protocol> ();
+  m_cache = ipv6->GetInterface (1)->GetNdiscCache ();
+  m_cache->SetAttribute ("SharedTimers", BooleanValue (sharedTimers));
+  m_nodes.Get (1)->GetObject<Ipv6L3Protocol> ()->GetInterface (1)->GetNdiscCache ()
+    ->SetAttribute ("SharedTimers", BooleanValue (sharedTimers));
+
+  m_cache->TraceConnectWithoutContext ("Drop", MakeCallback (&NdiscCacheTestCase::CountDrops, this));
+
+  m_received = 0;
+  m_frames = 0;
+  m_drops = 0;
+  Ptr<Socket> sink = Socket::CreateSocket (m_nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 1234));
+  sink->SetRecvCallback (MakeCallback (&NdiscCacheTestCase::HandleRecv, this));
+  m_source = Socket::CreateSocket (m_nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  m_source->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 0));
+  m_nodes.Get (1)->RegisterProtocolHandler (MakeCallback (&NdiscCacheTestCase::CountFrames, this),
+                                            0, m_devices.Get (1));
+}
+
+void
+NdiscCacheTestCase::DoRun (void)
+{
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      // Resolution, then Neighbor Unreachability Detection: the entry goes
+      // STALE 30 s after the confirmation, and is only probed when used again
+      bool shared = (i == 1);
+      Setup (shared);
+      Ipv6Address remote = m_interfaces.GetAddress (1, 1);
+      Simulator::Schedule (Seconds (5), &NdiscCacheTestCase::SendTo, this, remote, 1);
+      Simulator::Schedule (Seconds (6), &NdiscCacheTestCase::CheckEntry, this, remote, true, true, false);
+      Simulator::Schedule (Seconds (40), &NdiscCacheTestCase::CheckEntry, this, remote, true, false, true);
+      Simulator::Schedule (Seconds (50), &NdiscCacheTestCase::SendTo, this, remote, 1);
+      Simulator::Schedule (Seconds (60), &NdiscCacheTestCase::CheckEntry, this, remote, true, true, false);
+
+      // Unknown neighbor: the packets sent before the resolution fails are
+      // bounded, and the entry is removed after the retransmissions
+      Ipv6Address unknown ("2001:1::1234");
+      Simulator::Schedule (Seconds (5), &NdiscCacheTestCase::SendTo, this, unknown, 10);
+      Simulator::Schedule (Seconds (6), &NdiscCacheTestCase::CheckEntry, this, unknown, true, false, false);
+      Simulator::Schedule (Seconds (10), &NdiscCacheTestCase::CheckEntry, this, unknown, false, false, false);
+
+      Simulator::Stop (Seconds (70));
+      Simulator::Run ();
+      Simulator::Destroy ();
+      NS_TEST_ASSERT_MSG_EQ (m_received, 2, "Datagrams lost, shared timers " << shared);
+    }
+
+  // A static entry is used without any NS/NA exchange, and stays REACHABLE
+  Setup (true);
+  Ipv6Address remote = m_interfaces.GetAddress (1, 1);
+  Address mac = m_devices.Get (1)->GetAddress ();
+  NdiscCache::Entry *entry = m_cache->AddStatic (remote, mac);
+  NS_TEST_ASSERT_MSG_EQ (entry->IsStatic (), true, "Entry not static");
+  Simulator::Schedule (Seconds (4), &NdiscCacheTestCase::CheckEntry, this, remote, true, true, false);
+  Simulator::Schedule (Seconds (4), &NdiscCacheTestCase::ResetFrames, this);
+  Simulator::Schedule (Seconds (5), &NdiscCacheTestCase::SendTo, this, remote, 3);
+  Simulator::Schedule (Seconds (60), &NdiscCacheTestCase::CheckEntry, this, remote, true, true, false);
+  Simulator::Stop (Seconds (70));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_received, 3, "Datagrams lost with a static entry");
+  NS_TEST_ASSERT_MSG_EQ (m_frames, 3, "Neighbor Discovery messages sent for a static entry");
+  NS_TEST_ASSERT_MSG_EQ ((m_cache->Lookup (remote)->GetMacAddress () == mac), true, "Static entry changed");
+  Simulator::Destroy ();
+
+  // The packets waiting for a resolution are sent when the entry becomes static
+  Setup (false);
+  remote = m_interfaces.GetAddress (1, 1);
+  mac = m_devices.Get (1)->GetAddress ();
+  Simulator::Schedule (Seconds (5), &NdiscCacheTestCase::SendTo, this, remote, 5);
+  Simulator::Schedule (Seconds (5), &NdiscCache::AddStatic, m_cache, remote, mac);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_received, NdiscCache::DEFAULT_UNRES_QLEN, "Waiting packets not bounded or not sent");
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 5 - NdiscCache::DEFAULT_UNRES_QLEN, "Packets dropped from the queue not traced");
+
+  // Without a queue, every packet waiting for a resolution is dropped
+  Setup (false);
+  m_cache->SetAttribute ("UnresolvedQueueSize", UintegerValue (0));
+  remote = m_interfaces.GetAddress (1, 1);
+  Simulator::Schedule (Seconds (5), &NdiscCacheTestCase::SendTo, this, remote, 2);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_received, 0, "Packets sent without a queue");
+  NS_TEST_ASSERT_MSG_EQ (m_drops, 2, "Packets dropped without a queue not traced");
+}
+
+static class NdiscCacheTestSuite : public TestSuite
+{
+public:
+  NdiscCacheTestSuite ()
+    : TestSuite ("ndisc-cache", UNIT)
+  {
+    AddTestCase (new NdiscCacheTestCase, TestCase::QUICK);
+  }
+} g_ndiscCacheTestSuite;
@@ -0,0 +1,41 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef NDISC_NET_DEVICE_H
+#define NDISC_NET_DEVICE_H
+
+#include "ns3/simple-net-device.h"
+
+namespace ns3 {
+
+/**
+ * \brief A SimpleNetDevice going through the Neighbor Discovery. Used for testing
+ */
+class NdiscNetDevice : public SimpleNetDevice
+{
+public:
+  virtual bool NeedsArp (void) const
+  {
+    return true;
+  }
+  virtual bool IsMulticast (void) const
+  {
+    return true;
+  }
+};
+
+} // namespace ns3
+
+#endif /* NDISC_NET_DEVICE_H */
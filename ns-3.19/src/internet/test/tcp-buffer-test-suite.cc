@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+
+using namespace ns3;
+
+namespace {
+
+/// A packet holding the stream bytes [start, start + size), byte i being i % 251
+Ptr<Packet>
+MakeData (uint32_t start, uint32_t size)
+{
+  uint8_t *buffer = new uint8_t[size];
+  for (uint32_t i = 0; i < size; i++)
+    {
+      buffer[i] = (start + i) % 251;
+    }
+  Ptr<Packet> p = Create<Packet> (buffer, size);
+  delete [] buffer;
+  return p;
+}
+
+/// Check that a packet holds the stream bytes [start, start + size)
+bool
+CheckData (Ptr<Packet> p, uint32_t start, uint32_t size)
+{
+  if (p == 0 || p->GetSize () != size)
+    {
+      return false;
+    }
+  uint8_t *buffer = new uint8_t[size];
+  p->CopyData (buffer, size);
+  bool ok = true;
+  for (uint32_t i = 0; i < size && ok; i++)
+    {
+      ok = buffer[i] == (start + i) % 251;
+    }
+  delete [] buffer;
+  return ok;
+}
+
+} // anonymous namespace
+
+class TcpTxBufferTestCase : public TestCase
+{
+public:
+  TcpTxBufferTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferTestCase::TcpTxBufferTestCase ()
+  : TestCase ("TcpTxBuffer segments")
+{
+}
+
+void
+TcpTxBufferTestCase::DoRun (void)
+{
+  TcpTxBuffer buffer;
+  buffer.SetMaxBufferSize (10000);
+  // data written before the connection is established
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (MakeData (0, 100)), true, "Add failed");
+  buffer.SetHeadSequence (SequenceNumber32 (1000));
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (MakeData (100, 300)), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (MakeData (400, 50)), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (MakeData (450, 9551)), false, "Buffer overflow accepted");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Size (), 450, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (buffer.TailSequence (), SequenceNumber32 (1450), "Wrong tail");
+
+  SequenceNumber32 head (1000);
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.CopyFromSequence (100, head), 0, 100), true, "Whole packet");
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.CopyFromSequence (50, head + 120), 120, 50), true, "Packet slice");
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.CopyFromSequence (400, head + 20), 20, 400), true, "Three packets");
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.CopyFromSequence (1000, head + 399), 399, 51), true, "Tail of the buffer");
+
+  // partial acknowledgement in the middle of a packet
+  buffer.DiscardUpTo (head + 150);
+  NS_TEST_ASSERT_MSG_EQ (buffer.HeadSequence (), head + 150, "Wrong head");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Size (), 300, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.CopyFromSequence (200, head + 150), 150, 200), true, "After discard");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Add (MakeData (450, 60)), true, "Add failed");
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.CopyFromSequence (100, head + 420), 420, 90), true, "New data");
+
+  // acknowledgement of a FIN, one byte after the data
+  buffer.DiscardUpTo (head + 511);
+  NS_TEST_ASSERT_MSG_EQ (buffer.Size (), 0, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (buffer.HeadSequence (), head + 511, "Wrong head");
+  NS_TEST_ASSERT_MSG_EQ (buffer.CopyFromSequence (100, head + 511)->GetSize (), 0, "Data after FIN");
+}
+
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+public:
+  TcpTxBufferScoreboardTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase ()
+  : TestCase ("TcpTxBuffer SACK scoreboard")
+{
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun (void)
+{
+  TcpTxBuffer buffer;
+  buffer.SetMaxBufferSize (100000);
+  SequenceNumber32 head (1000);
+  buffer.SetHeadSequence (head);
+  buffer.Add (MakeData (0, 10000));
+  SequenceNumber32 highTx = head + 10000;
+  SequenceNumber32 seq;
+  uint32_t length;
+
+  NS_TEST_ASSERT_MSG_EQ (buffer.Pipe (highTx, head, 3, 100), 10000, "Pipe without SACK");
+  NS_TEST_ASSERT_MSG_EQ (buffer.IsLost (head, 3, 100), false, "Lost without SACK");
+
+  // segments [1100, 1200) and [1300, 1400) lost, then [1500, 1600)
+  TcpHeader::SackList blocks;
+  blocks.push_back (TcpHeader::SackBlock (head + 200, head + 300));
+  NS_TEST_ASSERT_MSG_EQ (buffer.Sack (blocks), true, "New block not recorded");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Sack (blocks), false, "Duplicate block recorded");
+  blocks.front () = TcpHeader::SackBlock (head + 400, head + 500);
+  blocks.push_back (TcpHeader::SackBlock (head + 600, head + 700));
+  blocks.push_back (TcpHeader::SackBlock (head + 100, head + 150)); // below the head once acknowledged
+  buffer.Sack (blocks);
+  NS_TEST_ASSERT_MSG_EQ (buffer.SackedBytes (), 350, "Wrong SACKed bytes");
+  NS_TEST_ASSERT_MSG_EQ (buffer.IsLost (head, 3, 100), true, "Head not lost");
+  NS_TEST_ASSERT_MSG_EQ (buffer.IsLost (head + 200, 3, 100), false, "SACKed byte lost");
+  NS_TEST_ASSERT_MSG_EQ (buffer.IsLost (head + 550, 3, 100), false, "Byte under the threshold lost");
+
+  NS_TEST_ASSERT_MSG_EQ (buffer.NextLostSegment (head, 3, 100, seq, length), true, "No lost segment");
+  NS_TEST_ASSERT_MSG_EQ (seq, head, "Wrong lost segment");
+  NS_TEST_ASSERT_MSG_EQ (length, 100, "Wrong lost segment length");
+  NS_TEST_ASSERT_MSG_EQ (buffer.NextLostSegment (head + 100, 3, 100, seq, length), true, "No lost segment");
+  NS_TEST_ASSERT_MSG_EQ (seq, head + 150, "Lost segment overlapping SACKed data");
+  NS_TEST_ASSERT_MSG_EQ (length, 50, "Wrong lost segment length");
+  NS_TEST_ASSERT_MSG_EQ (buffer.NextLostSegment (head + 200, 3, 100, seq, length), false, "Data above the threshold lost");
+
+  // 9500 bytes neither SACKed nor lost, plus the lost bytes retransmitted
+  NS_TEST_ASSERT_MSG_EQ (buffer.Pipe (highTx, head, 3, 100), 9500, "Wrong pipe");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Pipe (highTx, head + 50, 3, 100), 9550, "Wrong pipe with retransmissions");
+  NS_TEST_ASSERT_MSG_EQ (buffer.NextUnsacked (head + 250, length), head + 300, "SACKed data not skipped");
+  NS_TEST_ASSERT_MSG_EQ (length, 100, "Wrong hole length");
+
+  // a block bridging two others merges them
+  blocks.clear ();
+  blocks.push_back (TcpHeader::SackBlock (head + 250, head + 450));
+  buffer.Sack (blocks);
+  NS_TEST_ASSERT_MSG_EQ (buffer.SackedBytes (), 450, "Wrong SACKed bytes after merge");
+  NS_TEST_ASSERT_MSG_EQ (buffer.NextUnsacked (head + 200, length), head + 500, "Blocks not merged");
+
+  // the acknowledged blocks are forgotten
+  buffer.DiscardUpTo (head + 300);
+  NS_TEST_ASSERT_MSG_EQ (buffer.SackedBytes (), 300, "Wrong SACKed bytes after ACK");
+  buffer.ResetScoreboard ();
+  NS_TEST_ASSERT_MSG_EQ (buffer.SackedBytes (), 0, "Scoreboard not reset");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Pipe (highTx, head, 3, 100), 9700, "Wrong pipe after reset");
+}
+
+class TcpRxBufferTestCase : public TestCase
+{
+public:
+  TcpRxBufferTestCase ();
+private:
+  virtual void DoRun (void);
+  /// add the stream bytes [start, start + size) to the buffer
+  bool Add (TcpRxBuffer &buffer, uint32_t start, uint32_t size);
+};
+
+TcpRxBufferTestCase::TcpRxBufferTestCase ()
+  : TestCase ("TcpRxBuffer reassembly")
+{
+}
+
+bool
+TcpRxBufferTestCase::Add (TcpRxBuffer &buffer, uint32_t start, uint32_t size)
+{
+  TcpHeader header;
+  header.SetSequenceNumber (SequenceNumber32 (start));
+  return buffer.Add (MakeData (start, size), header);
+}
+
+void
+TcpRxBufferTestCase::DoRun (void)
+{
+  TcpRxBuffer buffer;
+  buffer.SetMaxBufferSize (1000);
+
+  NS_TEST_ASSERT_MSG_EQ (Add (buffer, 0, 100), true, "In-order segment");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Available (), 100, "Wrong available data");
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.Extract (1000), 0, 100), true, "Whole segment");
+
+  // out of order and overlapping segments
+  NS_TEST_ASSERT_MSG_EQ (Add (buffer, 300, 100), true, "Out of order segment");
+  NS_TEST_ASSERT_MSG_EQ (Add (buffer, 200, 50), true, "Out of order segment");
+  NS_TEST_ASSERT_MSG_EQ (Add (buffer, 220, 60), true, "Overlapping segment");
+  NS_TEST_ASSERT_MSG_EQ (Add (buffer, 310, 20), false, "Duplicate segment");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Available (), 0, "Data available after a gap");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Size (), 180, "Wrong occupancy");
+  NS_TEST_ASSERT_MSG_EQ (Add (buffer, 50, 260), true, "Segment filling the gaps");
+  NS_TEST_ASSERT_MSG_EQ (buffer.NextRxSequence (), SequenceNumber32 (400), "Wrong next sequence");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Available (), 300, "Wrong available data");
+
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.Extract (30), 100, 30), true, "Partial segment");
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.Extract (200), 130, 200), true, "Several segments");
+  NS_TEST_ASSERT_MSG_EQ (CheckData (buffer.Extract (1000), 330, 70), true, "Remaining data");
+  NS_TEST_ASSERT_MSG_EQ (buffer.Size (), 0, "Wrong occupancy");
+  NS_TEST_ASSERT_MSG_EQ ((buffer.Extract (1000) == 0), true, "Data extracted from an empty buffer");
+
+  // SACK blocks of the out-of-order data, the most recent first
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSackBlocks ().size (), 0, "SACK blocks without out-of-order data");
+  Add (buffer, 500, 50);
+  Add (buffer, 550, 50);
+  Add (buffer, 700, 50);
+  Add (buffer, 800, 50);
+  TcpHeader::SackList blocks = buffer.GetSackBlocks ();
+  NS_TEST_ASSERT_MSG_EQ (blocks.size (), 3, "Wrong number of SACK blocks");
+  NS_TEST_ASSERT_MSG_EQ (blocks.front ().first, SequenceNumber32 (800), "Most recent block not first");
+  blocks.pop_front ();
+  NS_TEST_ASSERT_MSG_EQ (blocks.front ().first, SequenceNumber32 (500), "Wrong left edge");
+  NS_TEST_ASSERT_MSG_EQ (blocks.front ().second, SequenceNumber32 (600), "Contiguous segments not merged");
+  Add (buffer, 400, 100);
+  blocks = buffer.GetSackBlocks ();
+  NS_TEST_ASSERT_MSG_EQ (blocks.size (), 2, "Acknowledged data reported");
+  NS_TEST_ASSERT_MSG_EQ (blocks.front ().first, SequenceNumber32 (700), "Wrong first block");
+}
+
+static class TcpBufferTestSuite : public TestSuite
+{
+public:
+  TcpBufferTestSuite ()
+    : TestSuite ("tcp-buffer", UNIT)
+  {
+    AddTestCase (new TcpTxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpTxBufferScoreboardTestCase, TestCase::QUICK);
+    AddTestCase (new TcpRxBufferTestCase, TestCase::QUICK);
+  }
+} g_tcpBufferTestSuite;
@@ -0,0 +1,318 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <cmath>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/error-model.h"
+#include "ns3/socket.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-newreno.h"
+#include "ns3/tcp-reno.h"
+#include "tcp-transfer-test.h"
+
+using namespace ns3;
+
+class TcpNewRenoOpsTestCase : public TestCase
+{
+public:
+  TcpNewRenoOpsTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpNewRenoOpsTestCase::TcpNewRenoOpsTestCase ()
+  : TestCase ("TcpNewRenoOps window updates")
+{
+}
+
+void
+TcpNewRenoOpsTestCase::DoRun (void)
+{
+  Ptr<TcpCongestionOps> ops = CreateObject<TcpNewRenoOps> ();
+  NS_TEST_ASSERT_MSG_EQ (ops->IncreaseWindow (1000, 4000, 1000, 1000), 2000, "Wrong slow start increase");
+  NS_TEST_ASSERT_MSG_EQ (ops->IncreaseWindow (4000, 4000, 1000, 1000), 4250, "Wrong congestion avoidance increase");
+  NS_TEST_ASSERT_MSG_EQ (ops->IncreaseWindow (2000000, 4000, 1000, 1000), 2000001, "Increase below one byte");
+  NS_TEST_ASSERT_MSG_EQ (ops->GetSsThresh (10000, 8000, 1000), 4000, "Wrong ssthresh");
+  NS_TEST_ASSERT_MSG_EQ (ops->GetSsThresh (10000, 3000, 1000), 2000, "Ssthresh below two segments");
+  NS_TEST_ASSERT_MSG_EQ (ops->Copy ()->GetName (), "TcpNewReno", "Wrong copy");
+}
+
+/**
+ * Drive TcpCubic through the congestion avoidance after a loss, one RTT
+ * at a time: the window must come back to Wmax in about K seconds, stay
+ * close to it for a while, then probe beyond it.
+ */
+class TcpCubicTestCase : public TestCase
+{
+public:
+  TcpCubicTestCase ();
+private:
+  virtual void DoRun (void);
+  /// acknowledge a window of segments
+  void Round (void);
+
+  Ptr<TcpCubic> m_cubic;
+  uint32_t m_cWnd;
+  uint32_t m_ssThresh;
+  std::vector<uint32_t> m_history; //!< window at the start of every RTT
+};
+
+static const uint32_t SEGMENT = 1000;
+static const Time RTT = MilliSeconds (100);
+
+TcpCubicTestCase::TcpCubicTestCase ()
+  : TestCase ("TcpCubic window growth")
+{
+}
+
+void
+TcpCubicTestCase::Round (void)
+{
+  m_history.push_back (m_cWnd);
+  uint32_t acks = m_cWnd / SEGMENT;
+  for (uint32_t i = 0; i < acks; i++)
+    {
+      m_cubic->PktsAcked (SEGMENT, RTT);
+      m_cWnd = m_cubic->IncreaseWindow (m_cWnd, m_ssThresh, SEGMENT, SEGMENT);
+    }
+  Simulator::Schedule (RTT, &TcpCubicTestCase::Round, this);
+}
+
+void
+TcpCubicTestCase::DoRun (void)
+{
+  m_cubic = CreateObject<TcpCubic> ();
+  m_ssThresh = m_cubic->GetSsThresh (100 * SEGMENT, 100 * SEGMENT, SEGMENT);
+  NS_TEST_ASSERT_MSG_EQ (m_ssThresh, 70 * SEGMENT, "Wrong multiplicative decrease");
+  m_cWnd = m_ssThresh;
+
+  Simulator::Schedule (Seconds (0), &TcpCubicTestCase::Round, this);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // K = (30 / 0.4)^(1/3) = 4.2 s
+  NS_TEST_ASSERT_MSG_GT (m_history[10], 85 * SEGMENT, "Too slow a growth towards Wmax");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_history[42], 100 * SEGMENT, 2 * SEGMENT, "Wmax not reached in K seconds");
+  NS_TEST_ASSERT_MSG_LT (m_history[52] - m_history[32], m_history[20] - m_history[0], "No plateau around Wmax");
+  NS_TEST_ASSERT_MSG_GT (m_history[99], 115 * SEGMENT, "No probing beyond Wmax");
+  for (uint32_t i = 1; i < m_history.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((m_history[i] >= m_history[i - 1]), true, "Window shrank without loss");
+    }
+
+  // A loss below the last Wmax lowers Wmax further. The window would
+  // follow the NewReno estimate, which is faster with this small gap.
+  m_cubic->SetAttribute ("TcpFriendliness", BooleanValue (false));
+  m_ssThresh = m_cubic->GetSsThresh (80 * SEGMENT, 80 * SEGMENT, SEGMENT);
+  NS_TEST_ASSERT_MSG_EQ (m_ssThresh, 56 * SEGMENT, "Wrong multiplicative decrease");
+  m_cWnd = m_ssThresh;
+  m_history.clear ();
+  Simulator::Schedule (Seconds (0), &TcpCubicTestCase::Round, this);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  // Wmax = 80 * 0.85 = 68, K = (12 / 0.4)^(1/3) = 3.1 s
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_history[31], 68 * SEGMENT, 2 * SEGMENT, "Fast convergence not applied");
+
+  // Slow start is left as is
+  m_cubic->Timeout ();
+  NS_TEST_ASSERT_MSG_EQ (m_cubic->IncreaseWindow (SEGMENT, 10 * SEGMENT, SEGMENT, SEGMENT), 2 * SEGMENT,
+                         "Wrong slow start increase");
+}
+
+/**
+ * Bulk transfer from the accepting side of a connection, with CUBIC as
+ * the congestion control: the accepted socket must get its own copy of
+ * the algorithm. With pacing, the segments are spread over the RTT
+ * estimate instead of being sent back-to-back.
+ */
+class TcpCongestionOpsTransferTestCase : public TcpTransferTestCase
+{
+public:
+  TcpCongestionOpsTransferTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void SetupStack (Ptr<TcpL4Protocol> tcp);
+  virtual void SetupSocket (Ptr<Socket> socket);
+
+  bool m_pacing;
+};
+
+TcpCongestionOpsTransferTestCase::TcpCongestionOpsTransferTestCase ()
+  : TcpTransferTestCase ("TCP transfer with CUBIC, with and without pacing", 50000),
+    m_pacing (false)
+{
+}
+
+void
+TcpCongestionOpsTransferTestCase::SetupStack (Ptr<TcpL4Protocol> tcp)
+{
+  tcp->SetAttribute ("CongestionOpsType", TypeIdValue (TcpCubic::GetTypeId ()));
+}
+
+void
+TcpCongestionOpsTransferTestCase::SetupSocket (Ptr<Socket> socket)
+{
+  socket->SetAttribute ("Pacing", BooleanValue (m_pacing));
+}
+
+void
+TcpCongestionOpsTransferTestCase::DoRun (void)
+{
+  m_pacing = false;
+  Time backToBack = Transfer (Seconds (0), 0);
+  m_pacing = true;
+  Time paced = Transfer (Seconds (0), 0);
+  NS_TEST_ASSERT_MSG_LT (backToBack, paced, "Segments not paced");
+}
+
+/**
+ * Bulk CUBIC transfer over a link with a 100 ms RTT, dropping a single
+ * segment during the slow start. The trace of the window of the sender
+ * must follow the cubic function of the RFC8312: cut by beta = 0.7 on
+ * the loss, back to Wmax in about K seconds, slower around Wmax than
+ * right after the loss. TcpNewReno and TcpReno sockets both delegate
+ * their window to the algorithm.
+ */
+class TcpCubicTransferTestCase : public TcpTransferTestCase
+{
+public:
+  TcpCubicTransferTestCase (TypeId socketType);
+private:
+  virtual void DoRun (void);
+  virtual void SetupStack (Ptr<TcpL4Protocol> tcp);
+  virtual void SetupSocket (Ptr<Socket> socket);
+  virtual void SetupSender (Ptr<Socket> socket);
+  void CwndChange (uint32_t oldValue, uint32_t newValue);
+  /// window at the given time, from the trace
+  uint32_t WindowAt (Time t) const;
+
+  TypeId m_socketType; //!< type of the sockets
+  std::vector<std::pair<Time, uint32_t> > m_cWnd; //!< trace of the window
+};
+
+TcpCubicTransferTestCase::TcpCubicTransferTestCase (TypeId socketType)
+  : TcpTransferTestCase ("TCP transfer with CUBIC over a lossy link, window trace of "
+                         + socketType.GetName (), 5000000),
+    m_socketType (socketType)
+{
+}
+
+void
+TcpCubicTransferTestCase::SetupStack (Ptr<TcpL4Protocol> tcp)
+{
+  tcp->SetAttribute ("SocketType", TypeIdValue (m_socketType));
+  tcp->SetAttribute ("CongestionOpsType", TypeIdValue (TcpCubic::GetTypeId ()));
+}
+
+void
+TcpCubicTransferTestCase::SetupSocket (Ptr<Socket> socket)
+{
+  // Let the congestion window alone limit the sender
+  socket->SetAttribute ("SegmentSize", UintegerValue (SEGMENT));
+  socket->SetAttribute ("SndBufSize", UintegerValue (1 << 20));
+  socket->SetAttribute ("RcvBufSize", UintegerValue (1 << 20));
+}
+
+void
+TcpCubicTransferTestCase::SetupSender (Ptr<Socket> socket)
+{
+  socket->TraceConnectWithoutContext ("CongestionWindow",
+                                      MakeCallback (&TcpCubicTransferTestCase::CwndChange, this));
+}
+
+void
+TcpCubicTransferTestCase::CwndChange (uint32_t oldValue, uint32_t newValue)
+{
+  m_cWnd.push_back (std::make_pair (Simulator::Now (), newValue));
+}
+
+uint32_t
+TcpCubicTransferTestCase::WindowAt (Time t) const
+{
+  uint32_t cWnd = 0;
+  for (uint32_t i = 0; i < m_cWnd.size () && m_cWnd[i].first <= t; i++)
+    {
+      cWnd = m_cWnd[i].second;
+    }
+  return cWnd;
+}
+
+void
+TcpCubicTransferTestCase::DoRun (void)
+{
+  std::list<uint32_t> drops;
+  drops.push_back (150);
+  Ptr<ReceiveListErrorModel> errors = CreateObject<ReceiveListErrorModel> ();
+  errors->SetList (drops);
+  Transfer (MilliSeconds (50), errors);
+  NS_TEST_ASSERT_MSG_GT (m_cWnd.size (), 0, "No window trace");
+
+  // The loss ends the slow start: Wmax is the largest window before the
+  // first decrease, and the epoch starts at the lowest window after it
+  uint32_t peak = 0;
+  while (peak + 1 < m_cWnd.size () && m_cWnd[peak + 1].second >= m_cWnd[peak].second)
+    {
+      peak++;
+    }
+  double wMax = static_cast<double> (m_cWnd[peak].second) / SEGMENT;
+  uint32_t trough = peak;
+  for (uint32_t i = peak; i < m_cWnd.size () && m_cWnd[i].first < m_cWnd[peak].first + Seconds (1); i++)
+    {
+      if (m_cWnd[i].second <= m_cWnd[trough].second)
+        {
+          trough = i;
+        }
+    }
+  double wMin = static_cast<double> (m_cWnd[trough].second) / SEGMENT;
+  Time epoch = m_cWnd[trough].first;
+  NS_TEST_ASSERT_MSG_EQ_TOL (wMin, 0.7 * wMax, 2, "Window not cut by beta, Wmax " << wMax);
+
+  // The window is back to Wmax after K seconds, grows more slowly around
+  // Wmax than right after the loss, then probes beyond Wmax
+  Time k = Seconds (std::pow (wMax * 0.3 / 0.4, 1.0 / 3.0));
+  NS_TEST_ASSERT_MSG_LT (epoch + k + Seconds (2), m_finished, "Transfer too short to reach Wmax");
+  double atK = static_cast<double> (WindowAt (epoch + k)) / SEGMENT;
+  NS_TEST_ASSERT_MSG_EQ_TOL (atK, wMax, 0.05 * wMax, "Wmax not reached in K seconds");
+  uint32_t afterLoss = WindowAt (epoch + Seconds (0.5)) - WindowAt (epoch);
+  uint32_t aroundK = WindowAt (epoch + k + Seconds (0.25)) - WindowAt (epoch + k - Seconds (0.25));
+  NS_TEST_ASSERT_MSG_LT (aroundK, afterLoss, "No plateau around Wmax");
+  NS_TEST_ASSERT_MSG_GT (WindowAt (epoch + k + Seconds (2)), 1.1 * wMax * SEGMENT, "No probing beyond Wmax");
+  for (uint32_t i = trough + 1; i < m_cWnd.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((m_cWnd[i].second >= m_cWnd[i - 1].second), true, "Window shrank after the recovery");
+    }
+}
+
+static class TcpCongestionOpsTestSuite : public TestSuite
+{
+public:
+  TcpCongestionOpsTestSuite ()
+    : TestSuite ("tcp-congestion-ops", UNIT)
+  {
+    AddTestCase (new TcpNewRenoOpsTestCase, TestCase::QUICK);
+    AddTestCase (new TcpCubicTestCase, TestCase::QUICK);
+    AddTestCase (new TcpCongestionOpsTransferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpCubicTransferTestCase (TcpNewReno::GetTypeId ()), TestCase::QUICK);
+    AddTestCase (new TcpCubicTransferTestCase (TcpReno::GetTypeId ()), TestCase::QUICK);
+  }
+} g_tcpCongestionOpsTestSuite;
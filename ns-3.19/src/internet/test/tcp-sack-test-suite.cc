@@ -0,0 +1,157 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/error-model.h"
+#include "ns3/socket.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/tcp-reno.h"
+#include "tcp-transfer-test.h"
+
+using namespace ns3;
+
+class TcpSackHeaderTestCase : public TestCase
+{
+public:
+  TcpSackHeaderTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TcpSackHeaderTestCase::TcpSackHeaderTestCase ()
+  : TestCase ("TcpHeader SACK options")
+{
+}
+
+void
+TcpSackHeaderTestCase::DoRun (void)
+{
+  TcpHeader syn;
+  syn.SetFlags (TcpHeader::SYN);
+  syn.SetSackPermitted (true);
+  NS_TEST_ASSERT_MSG_EQ (syn.GetSerializedSize (), 24, "Wrong size with SACK-permitted");
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddHeader (syn);
+  TcpHeader received;
+  p->RemoveHeader (received);
+  NS_TEST_ASSERT_MSG_EQ (received.IsSackPermitted (), true, "SACK-permitted lost");
+  NS_TEST_ASSERT_MSG_EQ (received.GetSackBlocks ().size (), 0, "Spurious SACK blocks");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 10, "Wrong payload size");
+
+  TcpHeader ack;
+  ack.SetFlags (TcpHeader::ACK);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      SequenceNumber32 left (1000 * i + 0xfffff000); // across the wrap around
+      bool added = ack.AddSackBlock (TcpHeader::SackBlock (left, left + 500));
+      NS_TEST_ASSERT_MSG_EQ (added, (i < TcpHeader::MAX_SACK_BLOCKS), "Wrong SACK block limit");
+    }
+  NS_TEST_ASSERT_MSG_EQ (ack.GetSerializedSize (), 56, "Wrong size with SACK blocks");
+  p = Create<Packet> ();
+  p->AddHeader (ack);
+  p->RemoveHeader (received);
+  NS_TEST_ASSERT_MSG_EQ (received.IsSackPermitted (), false, "Spurious SACK-permitted");
+  NS_TEST_ASSERT_MSG_EQ ((received.GetSackBlocks () == ack.GetSackBlocks ()), true, "SACK blocks changed");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 0, "Options left in the payload");
+
+  // a header length set by hand is padded, and the padding skipped
+  ack.ClearSackBlocks ();
+  NS_TEST_ASSERT_MSG_EQ (ack.GetSerializedSize (), 20, "Wrong size without options");
+  ack.SetLength (7);
+  p->AddHeader (ack);
+  p->RemoveHeader (received);
+  NS_TEST_ASSERT_MSG_EQ (received.GetSackBlocks ().size (), 0, "Padding read as SACK blocks");
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 0, "Padding left in the payload");
+}
+
+/**
+ * Bulk Reno transfer over a link dropping several segments of the same
+ * window: the data must arrive intact, and SACK must retransmit all the
+ * holes during the fast recovery, where Reno alone waits for the
+ * retransmission timeout.
+ */
+class TcpSackTransferTestCase : public TcpTransferTestCase
+{
+public:
+  TcpSackTransferTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void SetupStack (Ptr<TcpL4Protocol> tcp);
+  virtual void SetupSocket (Ptr<Socket> socket);
+
+  bool m_sack;
+  uint32_t m_retxThresh;
+};
+
+TcpSackTransferTestCase::TcpSackTransferTestCase ()
+  : TcpTransferTestCase ("TCP transfer with losses, with and without SACK", 200000),
+    m_sack (false),
+    m_retxThresh (3)
+{
+}
+
+void
+TcpSackTransferTestCase::SetupStack (Ptr<TcpL4Protocol> tcp)
+{
+  tcp->SetAttribute ("SocketType", TypeIdValue (TcpReno::GetTypeId ()));
+}
+
+void
+TcpSackTransferTestCase::SetupSocket (Ptr<Socket> socket)
+{
+  socket->SetAttribute ("Sack", BooleanValue (m_sack));
+  socket->SetAttribute ("ReTxThreshold", UintegerValue (m_retxThresh));
+}
+
+void
+TcpSackTransferTestCase::DoRun (void)
+{
+  // Drop three segments of the same window at the receiver
+  std::list<uint32_t> drops;
+  drops.push_back (40);
+  drops.push_back (43);
+  drops.push_back (46);
+  Time finished[3];
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<ReceiveListErrorModel> errors = CreateObject<ReceiveListErrorModel> ();
+      errors->SetList (drops);
+      m_sack = (i >= 1);
+      // the scoreboard uses the same threshold as the duplicate ACKs
+      m_retxThresh = (i == 2) ? 1000 : 3;
+      finished[i] = Transfer (Seconds (0), errors);
+    }
+  Time withoutSack = finished[0];
+  Time withSack = finished[1];
+  Time withoutFastRetransmit = finished[2];
+  NS_TEST_ASSERT_MSG_LT (withSack, withoutSack, "SACK did not speed up the recovery");
+  NS_TEST_ASSERT_MSG_LT (withSack, withoutFastRetransmit, "SACK ignored the ReTxThreshold attribute");
+}
+
+static class TcpSackTestSuite : public TestSuite
+{
+public:
+  TcpSackTestSuite ()
+    : TestSuite ("tcp-sack", UNIT)
+  {
+    AddTestCase (new TcpSackHeaderTestCase, TestCase::QUICK);
+    AddTestCase (new TcpSackTransferTestCase, TestCase::QUICK);
+  }
+} g_tcpSackTestSuite;
@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "tcp-transfer-test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/error-model.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+
+namespace ns3 {
+
+TcpTransferTestCase::TcpTransferTestCase (std::string name, uint32_t totalBytes)
+  : TestCase (name),
+    m_totalBytes (totalBytes),
+    m_sent (0),
+    m_received (0),
+    m_intact (true)
+{
+}
+
+TcpTransferTestCase::~TcpTransferTestCase ()
+{
+}
+
+void
+TcpTransferTestCase::SetupStack (Ptr<TcpL4Protocol> tcp)
+{
+}
+
+void
+TcpTransferTestCase::SetupSocket (Ptr<Socket> socket)
+{
+}
+
+void
+TcpTransferTestCase::SetupSender (Ptr<Socket> socket)
+{
+}
+
+void
+TcpTransferTestCase::HandleAccept (Ptr<Socket> socket, const Address &from)
+{
+  SetupSender (socket);
+  socket->SetSendCallback (MakeCallback (&TcpTransferTestCase::HandleSend, this));
+  HandleSend (socket, socket->GetTxAvailable ());
+}
+
+void
+TcpTransferTestCase::HandleRecv (Ptr<Socket> socket)
+{
+  Ptr<Packet> p;
+  while ((p = socket->Recv ()) != 0 && p->GetSize () > 0)
+    {
+      uint8_t *buffer = new uint8_t[p->GetSize ()];
+      p->CopyData (buffer, p->GetSize ());
+      for (uint32_t i = 0; i < p->GetSize (); i++)
+        {
+          m_intact = m_intact && buffer[i] == (m_received + i) % 251;
+        }
+      delete [] buffer;
+      m_received += p->GetSize ();
+    }
+  if (m_received == m_totalBytes)
+    {
+      m_finished = Simulator::Now ();
+    }
+}
+
+void
+TcpTransferTestCase::HandleSend (Ptr<Socket> socket, uint32_t available)
+{
+  while (m_sent < m_totalBytes && socket->GetTxAvailable () > 0)
+    {
+      uint32_t size = std::min (std::min (m_totalBytes - m_sent, socket->GetTxAvailable ()), 1000u);
+      uint8_t *buffer = new uint8_t[size];
+      for (uint32_t i = 0; i < size; i++)
+        {
+          buffer[i] = (m_sent + i) % 251;
+        }
+      int sent = socket->Send (Create<Packet> (buffer, size));
+      delete [] buffer;
+      if (sent <= 0)
+        {
+          break;
+        }
+      m_sent += sent;
+    }
+}
+
+Time
+TcpTransferTestCase::Transfer (Time delay, Ptr<ErrorModel> errors)
+{
+  m_sent = 0;
+  m_received = 0;
+  m_intact = true;
+  m_finished = Seconds (0);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (delay));
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+      SetupStack (nodes.Get (i)->GetObject<TcpL4Protocol> ());
+    }
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  if (errors != 0)
+    {
+      DynamicCast<SimpleNetDevice> (devices.Get (0))->SetReceiveErrorModel (errors);
+    }
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  SetupSocket (server);
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpTransferTestCase::HandleAccept, this));
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  SetupSocket (sink);
+  sink->SetRecvCallback (MakeCallback (&TcpTransferTestCase::HandleRecv, this));
+  sink->Connect (InetSocketAddress (interfaces.GetAddress (1), 5000));
+
+  Simulator::Stop (Seconds (100));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_totalBytes, "Transfer incomplete");
+  NS_TEST_EXPECT_MSG_EQ (m_intact, true, "Data corrupted");
+  return m_finished;
+}
+
+} // namespace ns3
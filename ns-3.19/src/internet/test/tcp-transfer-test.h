@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TCP_TRANSFER_TEST_H
+#define TCP_TRANSFER_TEST_H
+
+#include <string>
+#include "ns3/test.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+
+namespace ns3 {
+
+class Socket;
+class TcpL4Protocol;
+class ErrorModel;
+
+/**
+ * \brief A bulk TCP transfer between two nodes, used for testing
+ *
+ * Node 1 listens, node 0 connects, and the socket accepted by node 1
+ * sends a byte pattern to node 0, which checks it.  The nodes are on a
+ * SimpleChannel with the given delay, and the receive error model of
+ * node 0 drops the data segments.  Subclasses configure the stacks and
+ * the sockets through the Setup methods.
+ */
+class TcpTransferTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the name of the test case
+   * \param totalBytes the number of bytes of a transfer
+   */
+  TcpTransferTestCase (std::string name, uint32_t totalBytes);
+  virtual ~TcpTransferTestCase ();
+
+protected:
+  /**
+   * \brief Run a transfer.
+   * \param delay the one-way delay of the channel
+   * \param errors the receive error model of node 0, or 0
+   * \returns the time the last byte was received
+   */
+  Time Transfer (Time delay, Ptr<ErrorModel> errors);
+
+  /**
+   * \brief Configure the TCP stack of a node, once installed.
+   * \param tcp the stack
+   */
+  virtual void SetupStack (Ptr<TcpL4Protocol> tcp);
+
+  /**
+   * \brief Configure the listening socket of node 1, or the socket of
+   * node 0, before they connect.
+   * \param socket the socket
+   */
+  virtual void SetupSocket (Ptr<Socket> socket);
+
+  /**
+   * \brief Notify the socket which sends the data, once accepted.
+   * \param socket the socket
+   */
+  virtual void SetupSender (Ptr<Socket> socket);
+
+  uint32_t m_totalBytes; //!< bytes to transfer
+  uint32_t m_sent;       //!< bytes sent so far
+  uint32_t m_received;   //!< bytes received so far
+  bool m_intact;         //!< the bytes received so far are the ones sent
+  Time m_finished;       //!< time the last byte was received
+
+private:
+  void HandleAccept (Ptr<Socket> socket, const Address &from);
+  void HandleRecv (Ptr<Socket> socket);
+  void HandleSend (Ptr<Socket> socket, uint32_t available);
+};
+
+} // namespace ns3
+
+#endif /* TCP_TRANSFER_TEST_H */
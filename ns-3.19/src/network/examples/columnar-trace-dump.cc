@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Print the records of a columnar trace file, written by
+// ColumnarTraceHelper, as comma-separated values:
+//
+//   ./waf --run "columnar-trace-dump --file=trace.nsc"
+
+#include <iostream>
+#include <cstring>
+#include "ns3/command-line.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/columnar-trace-file.h"
+
+using namespace ns3;
+
+static void
+PrintAddress (std::ostream &os, const uint8_t address[16])
+{
+  static const uint8_t mapped[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+  if (std::memcmp (address, mapped, sizeof (mapped)) == 0)
+    {
+      os << Ipv4Address::Deserialize (address + 12);
+    }
+  else
+    {
+      os << Ipv6Address::Deserialize (address);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  std::string filename;
+  CommandLine cmd;
+  cmd.AddValue ("file", "The columnar trace file to print", filename);
+  cmd.Parse (argc, argv);
+
+  ColumnarTraceFile file;
+  file.Open (filename, std::ios::in);
+  if (file.Fail ())
+    {
+      std::cerr << "Unable to read " << filename << std::endl;
+      return 1;
+    }
+
+  static const char *events[] = { "enqueue", "dequeue", "drop", "tx", "rx" };
+  std::cout << "time,node,device,event,size,uid,protocol,source,destination,"
+            << "sourcePort,destinationPort,hopLimit,tcpFlags,tcpSequence,tcpAck" << std::endl;
+  ColumnarTraceFile::Record record;
+  while (file.Read (record))
+    {
+      std::cout << record.time << ","
+                << record.node << ","
+                << record.device << ",";
+      if (record.event < sizeof (events) / sizeof (events[0]))
+        {
+          std::cout << events[record.event] << ",";
+        }
+      else
+        {
+          std::cout << (uint32_t)record.event << ",";
+        }
+      std::cout << record.size << ","
+                << record.uid << ","
+                << (uint32_t)record.protocol << ",";
+      PrintAddress (std::cout, record.source);
+      std::cout << ",";
+      PrintAddress (std::cout, record.destination);
+      std::cout << "," << record.sourcePort << ","
+                << record.destinationPort << ","
+                << (uint32_t)record.hopLimit << ","
+                << (uint32_t)record.tcpFlags << ","
+                << record.tcpSequence << ","
+                << record.tcpAck << std::endl;
+    }
+  if (!file.Eof ())
+    {
+      std::cerr << "Error reading " << filename << " after "
+                << file.GetNRecords () << " records" << std::endl;
+      return 1;
+    }
+  return 0;
+}
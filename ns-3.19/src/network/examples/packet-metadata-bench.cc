@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the cost of the packet metadata on the packet operations
+// of a forwarding path:
+//
+//   ./waf --run "packet-metadata-bench --printing=0"
+//   ./waf --run "packet-metadata-bench --printing=1"
+//   ./waf --run "packet-metadata-bench --printing=1 --print=1"
+//
+// Each packet is created by an application, gets three headers and a
+// trailer on the sender, is copied by the queue and by a trace source,
+// and is forwarded by two routers which remove and add the outer
+// headers.  With --print, each copy is printed as an ascii trace would.
+
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/trailer.h"
+#include "ns3/command-line.h"
+#include <ctime>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+namespace {
+
+template <int N>
+class BenchHeader : public Header
+{
+public:
+  static std::string GetName (void)
+  {
+    std::ostringstream oss;
+    oss << "ns3::BenchHeader<" << N << ">";
+    return oss.str ();
+  }
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId (GetName ().c_str ())
+      .SetParent<Header> ()
+      .AddConstructor<BenchHeader<N> > ()
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+    os << "length=" << N;
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return N;
+  }
+  virtual void Serialize (Buffer::Iterator start) const
+  {
+    start.WriteU8 (0, N);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator start)
+  {
+    start.Next (N);
+    return N;
+  }
+};
+
+class BenchTrailer : public Trailer
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchTrailer")
+      .SetParent<Trailer> ()
+      .AddConstructor<BenchTrailer> ()
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+    os << "fcs";
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 4;
+  }
+  virtual void Serialize (Buffer::Iterator start) const
+  {
+    start.Prev (4);
+    start.WriteU32 (0);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator start)
+  {
+    start.Prev (4);
+    start.ReadU32 ();
+    return 4;
+  }
+};
+
+typedef BenchHeader<8> TransportHeader;
+typedef BenchHeader<20> NetworkHeader;
+typedef BenchHeader<14> LinkHeader;
+
+void
+Trace (Ptr<const Packet> p, bool print, std::ostringstream &os)
+{
+  Ptr<Packet> copy = p->Copy ();
+  if (print)
+    {
+      os.str ("");
+      copy->Print (os);
+    }
+}
+
+void
+Hop (Ptr<Packet> p, bool print, std::ostringstream &os)
+{
+  LinkHeader link;
+  BenchTrailer fcs;
+  NetworkHeader network;
+  p->RemoveHeader (link);
+  p->RemoveTrailer (fcs);
+  p->RemoveHeader (network);
+  p->AddHeader (network);
+  p->AddHeader (link);
+  p->AddTrailer (fcs);
+  Trace (p, print, os);
+}
+
+} // anonymous namespace
+
+int main (int argc, char *argv[])
+{
+  uint32_t packets = 1000000;
+  uint32_t size = 1000;
+  bool printing = false;
+  bool checking = false;
+  bool print = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("packets", "Number of packets to send", packets);
+  cmd.AddValue ("size", "Payload size", size);
+  cmd.AddValue ("printing", "Enable the packet metadata", printing);
+  cmd.AddValue ("checking", "Enable the packet metadata and its checks", checking);
+  cmd.AddValue ("print", "Print each traced packet", print);
+  cmd.Parse (argc, argv);
+
+  if (checking)
+    {
+      Packet::EnableChecking ();
+    }
+  else if (printing)
+    {
+      Packet::EnablePrinting ();
+    }
+
+  std::ostringstream os;
+  clock_t start = clock ();
+  for (uint32_t i = 0; i < packets; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (size);
+      p->AddHeader (TransportHeader ());
+      p->AddHeader (NetworkHeader ());
+      p->AddHeader (LinkHeader ());
+      p->AddTrailer (BenchTrailer ());
+      Ptr<Packet> queued = p->Copy ();
+      Trace (queued, print, os);
+      Hop (queued, print, os);
+      Hop (queued, print, os);
+    }
+  clock_t end = clock ();
+
+  double seconds = (end - start) / (double)CLOCKS_PER_SEC;
+  std::cout << "printing=" << (printing || checking)
+            << " checking=" << checking
+            << " print=" << print
+            << " packets=" << packets
+            << " time=" << seconds << "s"
+            << " per-packet=" << seconds * 1e9 / packets << "ns"
+            << std::endl;
+  return 0;
+}
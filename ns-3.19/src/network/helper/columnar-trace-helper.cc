@@ -0,0 +1,272 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/queue.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "columnar-trace-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceHelper");
+
+namespace ns3 {
+
+namespace {
+
+/// The number of bytes of a packet parsed to fill a record.
+const uint32_t MAX_PARSED = 128;
+
+/// What a trace sink needs to know about the traced device.
+class DeviceTrace : public SimpleRefCount<DeviceTrace>
+{
+public:
+  Ptr<ColumnarTraceFile> file;
+  uint32_t node;
+  uint32_t device;
+  uint8_t event;
+};
+
+void
+Sink (Ptr<DeviceTrace> trace, Ptr<const Packet> p)
+{
+  ColumnarTraceFile::Record record;
+  record.time = Simulator::Now ().GetNanoSeconds ();
+  record.node = trace->node;
+  record.device = trace->device;
+  record.event = trace->event;
+  ColumnarTraceHelper::FillRecord (p, record);
+  trace->file->Write (record);
+}
+
+void
+Connect (Ptr<Object> object, std::string name, Ptr<DeviceTrace> trace)
+{
+  if (object->TraceConnectWithoutContext (name, MakeBoundCallback (&Sink, trace)))
+    {
+      NS_LOG_LOGIC ("node " << trace->node << " device " << trace->device << ": traced " << name);
+    }
+}
+
+uint16_t
+ReadU16 (const uint8_t *b)
+{
+  return (b[0] << 8) | b[1];
+}
+
+uint32_t
+ReadU32 (const uint8_t *b)
+{
+  return (b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+}
+
+} // anonymous namespace
+
+ColumnarTraceHelper::ColumnarTraceHelper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<ColumnarTraceFile>
+ColumnarTraceHelper::CreateFile (std::string filename, uint32_t blockSize)
+{
+  NS_LOG_FUNCTION (this << filename << blockSize);
+  Ptr<ColumnarTraceFile> file = Create<ColumnarTraceFile> ();
+  file->SetBlockSize (blockSize);
+  file->Open (filename, std::ios::out);
+  NS_ABORT_MSG_IF (file->Fail (), "ColumnarTraceHelper::CreateFile(): Unable to Open " << filename << " for write");
+  return file;
+}
+
+void
+ColumnarTraceHelper::Enable (Ptr<ColumnarTraceFile> file, Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << file << device);
+  uint32_t node = device->GetNode ()->GetId ();
+  uint32_t index = device->GetIfIndex ();
+  uint8_t events[] = { ColumnarTraceFile::ENQUEUE, ColumnarTraceFile::DEQUEUE,
+                       ColumnarTraceFile::DROP, ColumnarTraceFile::TX,
+                       ColumnarTraceFile::RX };
+  Ptr<DeviceTrace> traces[sizeof (events)];
+  for (uint32_t i = 0; i < sizeof (events); ++i)
+    {
+      traces[i] = Create<DeviceTrace> ();
+      traces[i]->file = file;
+      traces[i]->node = node;
+      traces[i]->device = index;
+      traces[i]->event = events[i];
+    }
+
+  PointerValue pointer;
+  Ptr<Queue> queue;
+  if (device->GetAttributeFailSafe ("TxQueue", pointer))
+    {
+      queue = pointer.Get<Queue> ();
+    }
+  if (queue != 0)
+    {
+      Connect (queue, "Enqueue", traces[ColumnarTraceFile::ENQUEUE]);
+      Connect (queue, "Dequeue", traces[ColumnarTraceFile::DEQUEUE]);
+      Connect (queue, "Drop", traces[ColumnarTraceFile::DROP]);
+    }
+  else
+    {
+      Connect (device, "MacTx", traces[ColumnarTraceFile::TX]);
+    }
+  Connect (device, "MacRx", traces[ColumnarTraceFile::RX]);
+  Connect (device, "MacTxDrop", traces[ColumnarTraceFile::DROP]);
+  Connect (device, "PhyTxDrop", traces[ColumnarTraceFile::DROP]);
+  Connect (device, "PhyRxDrop", traces[ColumnarTraceFile::DROP]);
+}
+
+void
+ColumnarTraceHelper::Enable (Ptr<ColumnarTraceFile> file, NetDeviceContainer devices)
+{
+  NS_LOG_FUNCTION (this << file);
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Enable (file, *i);
+    }
+}
+
+void
+ColumnarTraceHelper::Enable (Ptr<ColumnarTraceFile> file, NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this << file);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Enable (file, node->GetDevice (j));
+        }
+    }
+}
+
+void
+ColumnarTraceHelper::EnableAll (Ptr<ColumnarTraceFile> file)
+{
+  NS_LOG_FUNCTION (this << file);
+  Enable (file, NodeContainer::GetGlobal ());
+}
+
+void
+ColumnarTraceHelper::FillRecord (Ptr<const Packet> p, ColumnarTraceFile::Record &record)
+{
+  NS_LOG_FUNCTION (p);
+  record.size = p->GetSize ();
+  record.uid = p->GetUid ();
+  record.protocol = 0;
+  record.hopLimit = 0;
+  record.tcpFlags = 0;
+  record.tcpSequence = 0;
+  record.tcpAck = 0;
+  record.sourcePort = 0;
+  record.destinationPort = 0;
+  std::memset (record.source, 0, sizeof (record.source));
+  std::memset (record.destination, 0, sizeof (record.destination));
+
+  uint8_t b[MAX_PARSED];
+  uint32_t size = p->CopyData (b, sizeof (b));
+  uint32_t ip = 0;
+  if (size >= 8 && b[0] == 0xaa && b[1] == 0xaa && b[2] == 0x03)
+    {
+      // LLC/SNAP header
+      ip = 8;
+    }
+  else if (size >= 2 && b[0] == 0x00 && (b[1] == 0x21 || b[1] == 0x57))
+    {
+      // PPP header of an IPv4 or IPv6 packet
+      ip = 2;
+    }
+  else if (size >= 14 && (ReadU16 (b + 12) == 0x0800 || ReadU16 (b + 12) == 0x86dd))
+    {
+      // Ethernet II header, as left by CsmaNetDevice in its traces
+      ip = 14;
+    }
+  else if (size >= 22 && ReadU16 (b + 12) <= 1500 && b[14] == 0xaa && b[15] == 0xaa && b[16] == 0x03)
+    {
+      // IEEE 802.3 header followed by an LLC/SNAP header
+      ip = 22;
+    }
+
+  uint8_t protocol;
+  uint32_t l4;
+  bool first = true;
+  if (size >= ip + 20 && (b[ip] >> 4) == 4)
+    {
+      protocol = b[ip + 9];
+      record.hopLimit = b[ip + 8];
+      record.source[10] = record.source[11] = 0xff;
+      record.destination[10] = record.destination[11] = 0xff;
+      std::memcpy (record.source + 12, b + ip + 12, 4);
+      std::memcpy (record.destination + 12, b + ip + 16, 4);
+      first = (ReadU16 (b + ip + 6) & 0x1fff) == 0;
+      l4 = ip + (b[ip] & 0x0f) * 4;
+    }
+  else if (size >= ip + 40 && (b[ip] >> 4) == 6)
+    {
+      protocol = b[ip + 6];
+      record.hopLimit = b[ip + 7];
+      std::memcpy (record.source, b + ip + 8, 16);
+      std::memcpy (record.destination, b + ip + 24, 16);
+      l4 = ip + 40;
+      // hop-by-hop, routing, fragment and destination options headers
+      while (first && (protocol == 0 || protocol == 43 || protocol == 44 || protocol == 60)
+             && size >= l4 + 8)
+        {
+          uint8_t next = b[l4];
+          if (protocol == 44)
+            {
+              first = (ReadU16 (b + l4 + 2) >> 3) == 0;
+              l4 += 8;
+            }
+          else
+            {
+              l4 += (b[l4 + 1] + 1) * 8;
+            }
+          protocol = next;
+        }
+    }
+  else
+    {
+      return;
+    }
+
+  record.protocol = protocol;
+  if (!first)
+    {
+      return;
+    }
+  if (protocol == 6 && size >= l4 + 14)
+    {
+      record.sourcePort = ReadU16 (b + l4);
+      record.destinationPort = ReadU16 (b + l4 + 2);
+      record.tcpSequence = ReadU32 (b + l4 + 4);
+      record.tcpAck = ReadU32 (b + l4 + 8);
+      record.tcpFlags = b[l4 + 13];
+    }
+  else if (protocol == 17 && size >= l4 + 4)
+    {
+      record.sourcePort = ReadU16 (b + l4);
+      record.destinationPort = ReadU16 (b + l4 + 2);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLUMNAR_TRACE_HELPER_H
+#define COLUMNAR_TRACE_HELPER_H
+
+#include <string>
+#include "ns3/net-device-container.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/columnar-trace-file.h"
+
+namespace ns3 {
+
+/**
+ * \brief Trace the packet events of devices into a ColumnarTraceFile
+ *
+ * This helper records the same events as the ascii traces of the
+ * device helpers, one fixed-size record per event instead of a line
+ * of text:
+ *
+ * \code
+ * ColumnarTraceHelper columnar;
+ * Ptr<ColumnarTraceFile> file = columnar.CreateFile ("trace.nsc");
+ * columnar.EnableAll (file);
+ * \endcode
+ *
+ * For a device with a transmit queue (a "TxQueue" attribute), the
+ * Enqueue, Dequeue and Drop traces of the queue are recorded; for
+ * other devices, the MacTx trace is recorded as TX events.  The
+ * MacRx traces are recorded as RX events, and the MacTxDrop,
+ * PhyTxDrop and PhyRxDrop traces as DROP events, for the devices
+ * which have them.
+ *
+ * The addresses, ports and header fields of a record are read from
+ * the IPv4 or IPv6 header found at the start of the packet, possibly
+ * after an LLC/SNAP, PPP or Ethernet header (Ethernet II, or IEEE 802.3
+ * with LLC/SNAP), without deserializing any header.
+ */
+class ColumnarTraceHelper
+{
+public:
+  ColumnarTraceHelper ();
+
+  /**
+   * \param filename the name of the file to create
+   * \param blockSize the number of records of each block of the file
+   * \returns the file, open for writing.
+   */
+  Ptr<ColumnarTraceFile> CreateFile (std::string filename,
+                                     uint32_t blockSize = ColumnarTraceFile::BLOCK_SIZE_DEFAULT);
+
+  /**
+   * \param file the file to write the events to
+   * \param device the device to trace
+   */
+  void Enable (Ptr<ColumnarTraceFile> file, Ptr<NetDevice> device);
+  /**
+   * \param file the file to write the events to
+   * \param devices the devices to trace
+   */
+  void Enable (Ptr<ColumnarTraceFile> file, NetDeviceContainer devices);
+  /**
+   * \param file the file to write the events to
+   * \param nodes the nodes whose devices are traced
+   */
+  void Enable (Ptr<ColumnarTraceFile> file, NodeContainer nodes);
+  /**
+   * \param file the file to write the events to
+   *
+   * Trace all the devices of all the nodes.
+   */
+  void EnableAll (Ptr<ColumnarTraceFile> file);
+
+  /**
+   * Fill the packet fields of a record: its size, uid, addresses, ports
+   * and header fields.
+   *
+   * \param p the packet
+   * \param record [out] the record to fill
+   */
+  static void FillRecord (Ptr<const Packet> p, ColumnarTraceFile::Record &record);
+};
+
+} // namespace ns3
+
+#endif /* COLUMNAR_TRACE_HELPER_H */
@@ -46,6 +46,11 @@ static struct Zeroes
 namespace ns3 {
 
 
+/* New and reallocated buffers reserve g_recommendedStart bytes of
+ * headroom: cap it so that one packet with an unusually deep stack
+ * of headers does not enlarge every buffer allocated after it.
+ */
+#define BUFFER_MAX_RECOMMENDED_START 512
 uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
@@ -240,7 +245,8 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
+  // room for the headers usually added in front of the zero area
+  m_data = Buffer::Create (g_recommendedStart);
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -266,7 +272,8 @@ Buffer::operator = (Buffer const&o)
       m_data = o.m_data;
       m_data->m_count++;
     }
-  g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
+  g_recommendedStart = std::min (std::max (g_recommendedStart, m_maxZeroAreaStart),
+                                 (uint32_t)BUFFER_MAX_RECOMMENDED_START);
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
   m_zeroAreaStart = o.m_zeroAreaStart;
   m_zeroAreaEnd = o.m_zeroAreaEnd;
@@ -280,7 +287,8 @@ Buffer::~Buffer ()
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
-  g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
+  g_recommendedStart = std::min (std::max (g_recommendedStart, m_maxZeroAreaStart),
+                                 (uint32_t)BUFFER_MAX_RECOMMENDED_START);
   m_data->m_count--;
   if (m_data->m_count == 0) 
     {
@@ -288,6 +296,17 @@ Buffer::~Buffer ()
     }
 }
 
+uint32_t
+Buffer::GetHeadroom (uint32_t front)
+{
+  NS_LOG_FUNCTION (front);
+  /* Leave room in a reallocated buffer for the headers which are
+   * usually added in front of the zero area, so that encapsulating
+   * a packet does not reallocate and copy it once per layer.
+   */
+  return front < g_recommendedStart ? g_recommendedStart - front : 0;
+}
+
 uint32_t
 Buffer::GetInternalSize (void) const
 {
@@ -323,9 +342,10 @@ Buffer::AddAtStart (uint32_t start)
     } 
   else
     {
-      uint32_t newSize = GetInternalSize () + start;
+      uint32_t headroom = GetHeadroom (m_zeroAreaStart - m_start + start);
+      uint32_t newSize = headroom + GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
-      memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
+      memcpy (newData->m_data + headroom + start, m_data->m_data + m_start, GetInternalSize ());
       m_data->m_count--;
       if (m_data->m_count == 0)
         {
@@ -333,7 +353,7 @@ Buffer::AddAtStart (uint32_t start)
         }
       m_data = newData;
 
-      int32_t delta = start - m_start;
+      int32_t delta = headroom + start - m_start;
       m_start += delta;
       m_zeroAreaStart += delta;
       m_zeroAreaEnd += delta;
@@ -376,9 +396,10 @@ Buffer::AddAtEnd (uint32_t end)
     } 
   else
     {
-      uint32_t newSize = GetInternalSize () + end;
+      uint32_t headroom = GetHeadroom (m_zeroAreaStart - m_start);
+      uint32_t newSize = headroom + GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
-      memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
+      memcpy (newData->m_data + headroom, m_data->m_data + m_start, GetInternalSize ());
       m_data->m_count--;
       if (m_data->m_count == 0) 
         {
@@ -386,7 +407,7 @@ Buffer::AddAtEnd (uint32_t end)
         }
       m_data = newData;
 
-      int32_t delta = -m_start;
+      int32_t delta = headroom - m_start;
       m_zeroAreaStart += delta;
       m_zeroAreaEnd += delta;
       m_end += delta;
@@ -437,14 +458,53 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
-  Buffer dst = CreateFullCopy ();
-  Buffer src = o.CreateFullCopy ();
+  if (o.m_data == m_data)
+    {
+      /* Iterators cannot copy between buffers which share their data:
+       * copy o first, keeping its zero area virtual.
+       */
+      Buffer src (o.m_zeroAreaEnd - o.m_zeroAreaStart);
+      uint32_t dataStart = o.m_zeroAreaStart - o.m_start;
+      src.AddAtStart (dataStart);
+      src.Begin ().Write (o.m_data->m_data + o.m_start, dataStart);
+      uint32_t dataEnd = o.m_end - o.m_zeroAreaEnd;
+      src.AddAtEnd (dataEnd);
+      Buffer::Iterator i = src.End ();
+      i.Prev (dataEnd);
+      i.Write (o.m_data->m_data + o.m_zeroAreaStart, dataEnd);
+      AddAtEnd (src);
+      return;
+    }
 
-  dst.AddAtEnd (src.GetSize ());
-  Buffer::Iterator destStart = dst.End ();
-  destStart.Prev (src.GetSize ());
-  destStart.Write (src.Begin (), src.End ());
-  *this = dst;
+  /**
+   * The result can have only one zero area: keep the larger of the
+   * two virtual and write the other one as real zero bytes, so that
+   * the payload of reassembled fragments is not allocated.
+   */
+  if (m_zeroAreaEnd - m_zeroAreaStart >= o.m_zeroAreaEnd - o.m_zeroAreaStart)
+    {
+      /* Append o after the data which follows our zero area:
+       * Before: |xx000..| + |yy00..|
+       * After:  |xx000..yy00..|
+       */
+      uint32_t size = o.GetSize ();
+      AddAtEnd (size);
+      Buffer::Iterator destStart = End ();
+      destStart.Prev (size);
+      destStart.Write (o.Begin (), o.End ());
+    }
+  else
+    {
+      /* Prepend our content before the data which precedes the zero area of o:
+       * Before: |xx0..| + |yy0000..|
+       * After:  |xx0..yy0000..|
+       */
+      Buffer dst = o;
+      uint32_t size = GetSize ();
+      dst.AddAtStart (size);
+      dst.Begin ().Write (Begin (), End ());
+      *this = dst;
+    }
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -868,27 +928,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the destination is entirely before or after our zero area
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
-  m_current += toCopy;
 }
 
 void 
@@ -65,8 +65,8 @@ namespace ns3 {
  * contains real data bytes in its BufferData instance but it also
  * contains "virtual zero data" which typically is used to represent
  * application-level payload. No memory is allocated to store the
- * zero bytes of application-level payload unless the user fragments
- * a Buffer: this application-level payload is kept track of with
+ * zero bytes of application-level payload unless the user reads
+ * them with PeekData: this application-level payload is kept track of with
  * a pair of integers which describe where in the buffer content
  * the "virtual zero area" starts and ends.
  *
@@ -439,7 +439,9 @@ private:
   /**
    * \param o the buffer to append to the end of this buffer.
    *
-   * Add bytes at the end of the Buffer.
+   * Add bytes at the end of the Buffer.  If both buffers
+   * contain virtual zero bytes, the smaller zero area is
+   * turned into real bytes.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
    */
@@ -571,6 +573,13 @@ private:
   bool CheckInternalState (void) const;
   void Initialize (uint32_t zeroSize);
   uint32_t GetInternalSize (void) const;
+  /**
+   * \param front the number of bytes in front of the zero area
+   * \returns the number of free bytes to keep before them in a new data area
+   */
+  static uint32_t GetHeadroom (uint32_t front);
+  /* for unit-tests */
+  friend class BufferHeadroomTest;
   uint32_t GetInternalEnd (void) const;
   static void Recycle (struct Buffer::Data *data);
   static struct Buffer::Data *Create (uint32_t size);
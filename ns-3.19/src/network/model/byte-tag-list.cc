@@ -20,6 +20,7 @@
 #include "byte-tag-list.h"
 #include "ns3/log.h"
 #include <vector>
+#include <algorithm>
 #include <cstring>
 
 NS_LOG_COMPONENT_DEFINE ("ByteTagList");
@@ -177,7 +178,13 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
   else if (m_data->size < spaceNeeded ||
            (m_data->count != 1 && m_data->dirty != m_used))
     {
-      struct ByteTagListData *newData = Allocate (spaceNeeded);
+      uint32_t size = spaceNeeded;
+      if (m_data->size < spaceNeeded)
+        {
+          // leave room for the next tags
+          size = std::max (spaceNeeded, 2 * m_data->size);
+        }
+      struct ByteTagListData *newData = Allocate (size);
       std::memcpy (&newData->data, &m_data->data, m_used);
       Deallocate (m_data);
       m_data = newData;
@@ -278,6 +285,15 @@ ByteTagList::AddAtEnd (int32_t adjustment, int32_t appendOffset)
     {
       return;
     }
+  if (m_data == 0)
+    {
+      return;
+    }
+  if (m_data->count == 1)
+    {
+      Adjust (adjustment, -OFFSET_MAX - 1, appendOffset);
+      return;
+    }
   ByteTagList list;
   ByteTagList::Iterator i = BeginAll ();
   while (i.HasNext ())
@@ -312,6 +328,15 @@ ByteTagList::AddAtStart (int32_t adjustment, int32_t prependOffset)
     {
       return;
     }
+  if (m_data == 0)
+    {
+      return;
+    }
+  if (m_data->count == 1)
+    {
+      Adjust (adjustment, prependOffset, OFFSET_MAX);
+      return;
+    }
   ByteTagList list;
   ByteTagList::Iterator i = BeginAll ();
   while (i.HasNext ())
@@ -338,6 +363,39 @@ ByteTagList::AddAtStart (int32_t adjustment, int32_t prependOffset)
   *this = list;
 }
 
+void
+ByteTagList::Adjust (int32_t adjustment, int32_t minStart, int32_t maxEnd)
+{
+  NS_LOG_FUNCTION (this << adjustment << minStart << maxEnd);
+  NS_ASSERT (m_data != 0 && m_data->count == 1);
+  uint8_t *end = &m_data->data[m_used];
+  uint8_t *cur = m_data->data;
+  uint8_t *to = m_data->data;
+  while (cur < end)
+    {
+      TagBuffer buf = TagBuffer (cur, end);
+      buf.ReadU32 ();
+      uint32_t size = buf.ReadU32 ();
+      int32_t start = buf.ReadU32 () + adjustment;
+      int32_t stop = buf.ReadU32 () + adjustment;
+      uint32_t itemSize = 4 + 4 + 4 + 4 + size;
+      if (start < maxEnd && stop > minStart)
+        {
+          if (to != cur)
+            {
+              std::memmove (to, cur, itemSize);
+            }
+          buf = TagBuffer (to + 4 + 4, to + 4 + 4 + 4 + 4);
+          buf.WriteU32 (std::max (start, minStart));
+          buf.WriteU32 (std::min (stop, maxEnd));
+          to += itemSize;
+        }
+      cur += itemSize;
+    }
+  m_used = to - m_data->data;
+  m_data->dirty = m_used;
+}
+
 #ifdef USE_FREE_LIST
 
 struct ByteTagListData *
@@ -358,7 +416,8 @@ ByteTagList::Allocate (uint32_t size)
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
     }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
+  size = std::max (size, g_maxSize);
+  uint8_t *buffer = new uint8_t [size + sizeof (struct ByteTagListData) - 4];
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
   data->size = size;
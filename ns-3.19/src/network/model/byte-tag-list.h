@@ -46,7 +46,9 @@ struct ByteTagListData;
  *
  *   - The struct ByteTagListData structure which contains the tag byte buffer
  *     is shared and, thus, reference-counted. This data structure is unshared
- *     as-needed to emulate COW semantics.
+ *     as-needed to emulate COW semantics.  The byte buffer grows
+ *     geometrically, so that adding tags one at a time does not
+ *     reallocate it each time.
  *
  *   - Each tag tags a unique set of bytes identified by the pair of offsets
  *     (start,end). These offsets are provided by Buffer::GetCurrentStartOffset
@@ -57,7 +59,8 @@ struct ByteTagListData;
  *     reports this to its container Packet class as a bool return value
  *     in Buffer::AddAtStart and Buffer::AddAtEnd. In both cases, when this happens
  *     the Packet class calls ByteTagList::AddAtEnd and ByteTagList::AddAtStart to update
- *     the byte offsets of each tag in the ByteTagList.
+ *     the byte offsets of each tag in the ByteTagList.  When the
+ *     ByteTagListData is not shared, the offsets are updated in place.
  *
  *   - Whenever bytes are removed from the packet byte buffer, the ByteTagList offsets
  *     are never updated because we rely on the fact that they will be updated in
@@ -216,6 +219,14 @@ private:
 private:
   bool IsDirtyAtEnd (int32_t appendOffset);
   bool IsDirtyAtStart (int32_t prependOffset);
+  /**
+   * Adjust the offsets in place by the adjustment delta, then remove
+   * the tags which end before minStart or start after maxEnd, and
+   * clamp the offsets of the others to [minStart, maxEnd].
+   *
+   * The data must not be shared.
+   */
+  void Adjust (int32_t adjustment, int32_t minStart, int32_t maxEnd);
   ByteTagList::Iterator BeginAll (void) const;
 
   struct ByteTagListData *Allocate (uint32_t size);
@@ -175,6 +175,7 @@ Node::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_deviceAdditionListeners.clear ();
   m_handlers.clear ();
+  m_dispatch.clear ();
   for (std::vector<Ptr<NetDevice> >::iterator i = m_devices.begin ();
        i != m_devices.end (); i++)
     {
@@ -245,6 +246,7 @@ Node::RegisterProtocolHandler (ProtocolHandler handler,
     }
 
   m_handlers.push_back (entry);
+  m_dispatch.clear ();
 }
 
 void
@@ -257,6 +259,7 @@ Node::UnregisterProtocolHandler (ProtocolHandler handler)
       if (i->handler.IsEqual (handler))
         {
           m_handlers.erase (i);
+          m_dispatch.clear ();
           break;
         }
     }
@@ -298,8 +301,36 @@ Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16
   NS_LOG_DEBUG ("Node " << GetId () << " ReceiveFromDevice:  dev "
                         << device->GetIfIndex () << " (type=" << device->GetInstanceTypeId ().GetName ()
                         << ") Packet UID " << packet->GetUid ());
-  bool found = false;
+  Ptr<Dispatch> dispatch = GetDispatch (device, protocol, promiscuous);
+  for (std::vector<ProtocolHandler>::const_iterator i = dispatch->handlers.begin ();
+       i != dispatch->handlers.end (); i++)
+    {
+      (*i) (device, packet, protocol, from, to, packetType);
+    }
+  return !dispatch->handlers.empty ();
+}
 
+Ptr<Node::Dispatch>
+Node::GetDispatch (Ptr<NetDevice> device, uint16_t protocol, bool promiscuous)
+{
+  NS_LOG_FUNCTION (this << device << protocol << promiscuous);
+  uint32_t index = device->GetIfIndex ();
+  bool cached = index < m_devices.size () && m_devices[index] == device;
+  uint32_t key = (protocol << 1) | (promiscuous ? 1 : 0);
+  if (cached)
+    {
+      if (index >= m_dispatch.size ())
+        {
+          m_dispatch.resize (m_devices.size ());
+        }
+      DispatchMap::const_iterator it = m_dispatch[index].find (key);
+      if (it != m_dispatch[index].end ())
+        {
+          return it->second;
+        }
+    }
+
+  Ptr<Dispatch> dispatch = Create<Dispatch> ();
   for (ProtocolHandlerList::iterator i = m_handlers.begin ();
        i != m_handlers.end (); i++)
     {
@@ -311,13 +342,18 @@ Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16
             {
               if (promiscuous == i->promiscuous)
                 {
-                  i->handler (device, packet, protocol, from, to, packetType);
-                  found = true;
+                  dispatch->handlers.push_back (i->handler);
                 }
             }
         }
     }
-  return found;
+  NS_LOG_LOGIC ("Node " << GetId () << " device " << index << " protocol " << protocol
+                        << ": " << dispatch->handlers.size () << " handlers");
+  if (cached)
+    {
+      m_dispatch[index][key] = dispatch;
+    }
+  return dispatch;
 }
 void 
 Node::RegisterDeviceAdditionListener (DeviceAdditionListener listener)
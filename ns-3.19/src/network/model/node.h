@@ -22,6 +22,7 @@
 #define NODE_H
 
 #include <vector>
+#include <map>
 
 #include "ns3/object.h"
 #include "ns3/callback.h"
@@ -222,11 +223,33 @@ private:
   typedef std::vector<struct Node::ProtocolHandlerEntry> ProtocolHandlerList;
   typedef std::vector<DeviceAdditionListener> DeviceAdditionListenerList;
 
+  /**
+   * The handlers which receive the packets of a protocol from a device,
+   * in promiscuous mode or not, in the order they were registered.
+   * Reference counted so that the handlers can be registered or
+   * unregistered while a packet is being delivered.
+   */
+  class Dispatch : public SimpleRefCount<Dispatch>
+  {
+public:
+    std::vector<ProtocolHandler> handlers;
+  };
+  /// Dispatch entries of a device, keyed by (protocol << 1) | promiscuous.
+  typedef std::map<uint32_t, Ptr<Dispatch> > DispatchMap;
+
+  /**
+   * \returns the handlers matching a received packet, computed from
+   * m_handlers the first time a device, protocol and mode are seen
+   * after the handlers change.
+   */
+  Ptr<Dispatch> GetDispatch (Ptr<NetDevice> device, uint16_t protocol, bool promiscuous);
+
   uint32_t    m_id;         // Node id for this node
   uint32_t    m_sid;        // System id for this node
   std::vector<Ptr<NetDevice> > m_devices;
   std::vector<Ptr<Application> > m_applications;
   ProtocolHandlerList m_handlers;
+  std::vector<DispatchMap> m_dispatch;  // Indexed by device ifIndex
   DeviceAdditionListenerList m_deviceAdditionListeners;
 };
 
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include <utility>
+#include <algorithm>
 #include <list>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
@@ -31,21 +32,30 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 namespace ns3 {
 
+const uint32_t PacketMetadata::SIZE_CLASSES;
+const uint32_t PacketMetadata::MIN_SIZE;
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+bool PacketMetadata::m_freeListDestroyed = false;
+std::vector<uint8_t> PacketMetadata::m_itemTypes;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
   NS_LOG_FUNCTION (this);
-  for (iterator i = begin (); i != end (); i++)
+  for (uint32_t i = 0; i < SIZE_CLASSES; i++)
     {
-      PacketMetadata::Deallocate (*i);
+      for (std::vector<struct Data *>::iterator j = m_lists[i].begin ();
+           j != m_lists[i].end (); j++)
+        {
+          PacketMetadata::Deallocate (*j);
+        }
     }
   PacketMetadata::m_enable = false;
+  PacketMetadata::m_freeListDestroyed = true;
 }
 
 void 
@@ -578,6 +588,18 @@ PacketMetadata::ReadItems (uint16_t current,
   return buffer - &m_data->m_data[current];
 }
 
+uint32_t
+PacketMetadata::GetSizeClass (uint32_t size)
+{
+  uint32_t sizeClass = 0;
+  while (sizeClass < SIZE_CLASSES &&
+         (MIN_SIZE << sizeClass) < size)
+    {
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
 struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
@@ -587,43 +609,46 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  // Allocate enough room for the largest packets seen so far, so that
+  // the buffer does not need to grow later, unless they are so large
+  // that this would waste memory for all the others.
+  size = std::max (size, std::min (m_maxSize, MIN_SIZE << 4));
+  uint32_t sizeClass = GetSizeClass (size);
+  if (sizeClass == SIZE_CLASSES)
     {
-      struct PacketMetadata::Data *data = m_freeList.back ();
-      m_freeList.pop_back ();
-      if (data->m_size >= size) 
-        {
-          NS_LOG_LOGIC ("create found size="<<data->m_size);
-          data->m_count = 1;
-          return data;
-        }
-      PacketMetadata::Deallocate (data);
-      NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
+      NS_LOG_LOGIC ("create alloc size="<<size);
+      return PacketMetadata::Allocate (size);
+    }
+  std::vector<struct Data *> &list = m_freeList.m_lists[sizeClass];
+  if (!list.empty ())
+    {
+      struct PacketMetadata::Data *data = list.back ();
+      list.pop_back ();
+      NS_LOG_LOGIC ("create found size="<<data->m_size);
+      data->m_count = 1;
+      data->m_dirtyEnd = 0;
+      return data;
     }
-  NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
-  return PacketMetadata::Allocate (m_maxSize);
+  NS_LOG_LOGIC ("create alloc size="<<(MIN_SIZE << sizeClass));
+  return PacketMetadata::Allocate (MIN_SIZE << sizeClass);
 }
 
 void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
-    {
-      PacketMetadata::Deallocate (data);
-      return;
-    } 
-  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.size ());
   NS_ASSERT (data->m_count == 0);
-  if (m_freeList.size () > 1000 ||
-      data->m_size < m_maxSize) 
+  uint32_t sizeClass = GetSizeClass (data->m_size);
+  if (m_freeListDestroyed ||
+      sizeClass == SIZE_CLASSES ||
+      data->m_size != (MIN_SIZE << sizeClass) ||
+      m_freeList.m_lists[sizeClass].size () > 1000)
     {
       PacketMetadata::Deallocate (data);
-    } 
-  else 
-    {
-      m_freeList.push_back (data);
+      return;
     }
+  NS_LOG_LOGIC ("recycle size="<<data->m_size<<", list="<<m_freeList.m_lists[sizeClass].size ());
+  m_freeList.m_lists[sizeClass].push_back (data);
 }
 
 struct PacketMetadata::Data *
@@ -1054,6 +1079,31 @@ PacketMetadata::GetUid (void) const
   NS_LOG_FUNCTION (this);
   return m_packetUid;
 }
+uint8_t
+PacketMetadata::GetItemType (uint32_t uid)
+{
+  // The parent of a TypeId never changes, so the result of the
+  // IsChildOf lookups is cached for the next items of this type.
+  if (uid >= m_itemTypes.size ())
+    {
+      m_itemTypes.resize (uid + 1, PacketMetadata::Item::PAYLOAD);
+    }
+  if (m_itemTypes[uid] == PacketMetadata::Item::PAYLOAD && uid != 0)
+    {
+      TypeId tid;
+      tid.SetUid (uid);
+      if (tid.IsChildOf (Header::GetTypeId ()))
+        {
+          m_itemTypes[uid] = PacketMetadata::Item::HEADER;
+        }
+      else if (tid.IsChildOf (Trailer::GetTypeId ()))
+        {
+          m_itemTypes[uid] = PacketMetadata::Item::TRAILER;
+        }
+    }
+  return m_itemTypes[uid];
+}
+
 PacketMetadata::ItemIterator 
 PacketMetadata::BeginItem (Buffer buffer) const
 {
@@ -1109,13 +1159,12 @@ PacketMetadata::ItemIterator::Next (void)
     {
       item.isFragment = false;
     }
-  TypeId tid;
-  tid.SetUid (uid);
+  uint8_t type = PacketMetadata::GetItemType (uid);
   if (uid == 0)
     {
       item.type = PacketMetadata::Item::PAYLOAD;
     }
-  else if (tid.IsChildOf (Header::GetTypeId ()))
+  else if (type == PacketMetadata::Item::HEADER)
     {
       item.type = PacketMetadata::Item::HEADER;
       if (!item.isFragment)
@@ -1126,7 +1175,7 @@ PacketMetadata::ItemIterator::Next (void)
           item.current = tmp.Begin ();
         }
     }
-  else if (tid.IsChildOf (Trailer::GetTypeId ()))
+  else if (type == PacketMetadata::Item::TRAILER)
     {
       item.type = PacketMetadata::Item::TRAILER;
       if (!item.isFragment)
@@ -75,6 +75,12 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * The data buffers are recycled in a pool of free lists, one per
+ * power-of-two size class, when the last packet which references
+ * them is destroyed, so that creating, copying and modifying packets
+ * does not normally allocate memory.  Packets use the pool even when
+ * the metadata is disabled: each of them still holds an empty buffer.
  */
 class PacketMetadata 
 {
@@ -292,10 +298,22 @@ private:
     uint64_t packetUid;
   };
 
-  class DataFreeList : public std::vector<struct Data *>
+  /**
+   * The number of size classes of the free lists.  Size class i
+   * holds buffers of MIN_SIZE << i bytes; larger buffers are not
+   * recycled.
+   */
+  static const uint32_t SIZE_CLASSES = 11;
+  /**
+   * The size of the buffers of the smallest size class.
+   */
+  static const uint32_t MIN_SIZE = 32;
+
+  class DataFreeList
   {
 public:
     ~DataFreeList ();
+    std::vector<struct Data *> m_lists[SIZE_CLASSES];
   };
 
   friend DataFreeList::~DataFreeList ();
@@ -330,12 +348,18 @@ public:
   bool IsSharedPointerOk (uint16_t pointer) const;
 
 
+  static uint32_t GetSizeClass (uint32_t size);
+  static uint8_t GetItemType (uint32_t uid);
   static struct PacketMetadata::Data *Create (uint32_t size);
   static void Recycle (struct PacketMetadata::Data *data);
   static struct PacketMetadata::Data *Allocate (uint32_t n);
   static void Deallocate (struct PacketMetadata::Data *data);
 
   static DataFreeList m_freeList;
+  // set when m_freeList is destroyed, at the end of the program.
+  static bool m_freeListDestroyed;
+  // cache of the type of item (header or trailer) of each TypeId uid.
+  static std::vector<uint8_t> m_itemTypes;
   static bool m_enable;
   static bool m_enableChecking;
 
@@ -20,7 +20,7 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a flat list of Packet tags, including copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
@@ -28,6 +28,7 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <algorithm>
 #include <cstring>
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList")
@@ -35,255 +36,152 @@ NS_LOG_COMPONENT_DEFINE ("PacketTagList")
 
 namespace ns3 {
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
+uint32_t
+PacketTagList::GetMaskBit (TypeId tid)
 {
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
+  return 1U << (tid.GetUid () & 31);
+}
 
-  // trivial case when list is empty
-  if (m_next == 0)
+uint32_t
+PacketTagList::Find (TypeId tid) const
+{
+  if ((m_mask & GetMaskBit (tid)) == 0)
     {
-      return false;
+      return m_size;
     }
-
-  bool found = false;
-
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
-
-  // Search from the head of the list until we find tid or a merge
-  while (cur != 0)
+  const struct TagData *tags = Head ();
+  uint32_t i = 0;
+  while (i < m_size && tags[i].tid != tid)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
-        {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
-          break;
-        }
-      else
-        {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
-        }
-    }  // while !found && !cow
+      i++;
+    }
+  return i;
+}
 
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
+struct PacketTagList::TagData *
+PacketTagList::GetWritable (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  if (m_block == 0 && size <= INLINE_SIZE)
     {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
+      return m_tags;
     }
-
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
-
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
+  if (m_block != 0 && m_block->count == 1 && m_block->capacity >= size)
     {
-      if (it->tid == tid)
-        {
-          break;
-        }
+      return m_block->tags;
     }
-  if (it == 0)
+  // move the tags to a new block, either because they do not fit
+  // anymore or because the current block is shared.
+  uint32_t capacity = std::max (size, 2U * INLINE_SIZE);
+  if (m_block != 0)
     {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
+      capacity = std::max (capacity, m_block->count == 1 ? 2 * m_block->capacity : m_block->capacity);
     }
-
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
+  NS_LOG_LOGIC ("allocating a block of " << capacity << " tags");
+  uint8_t *buffer = new uint8_t [sizeof (struct TagBlock) + (capacity - 1) * sizeof (struct TagData)];
+  struct TagBlock *block = reinterpret_cast<struct TagBlock *> (buffer);
+  block->count = 1;
+  block->capacity = capacity;
+  std::memcpy (block->tags, Head (), m_size * sizeof (struct TagData));
+  if (m_block != 0)
     {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = new struct TagData ();
-      copy->tid = cur->tid;
-      copy->count = 1;
-      memcpy (copy->data, cur->data, TagData::MAX_SIZE);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
+      Deallocate (m_block);
     }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
-
+  m_block = block;
+  return m_block->tags;
 }
 
-bool
-PacketTagList::Remove (Tag & tag)
+void
+PacketTagList::UpdateMask (void)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  const struct TagData *tags = Head ();
+  m_mask = 0;
+  for (uint32_t i = 0; i < m_size; ++i)
+    {
+      m_mask |= GetMaskBit (tags[i].tid);
+    }
 }
 
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
+void
+PacketTagList::Deallocate (struct TagBlock *block)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  tag.Deserialize (TagBuffer (cur->data,
-                              cur->data + TagData::MAX_SIZE));
-  *prevNext = cur->next;            // link around cur
-
-  if (preMerge)
+  block->count--;
+  if (block->count == 0)
     {
-      // found tid before first merge, so delete cur
-      delete cur;
+      uint8_t *buffer = reinterpret_cast<uint8_t *> (block);
+      delete [] buffer;
     }
-  else
-    {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
-        {
-          // there's a next, so make it a merge
-          cur->next->count++;
-        }
-    }
-  return found;
 }
 
 bool
-PacketTagList::Replace (Tag & tag)
+PacketTagList::Remove (Tag & tag)
 {
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t i = Find (tid);
+  if (i == m_size)
     {
-      Add (tag);
+      return false;
     }
-  return found;
+  const struct TagData *cur = &Head ()[i];
+  tag.Deserialize (TagBuffer (const_cast<uint8_t *> (cur->data),
+                              const_cast<uint8_t *> (cur->data) + TagData::MAX_SIZE));
+  struct TagData *tags = GetWritable (m_size);
+  std::memmove (&tags[i], &tags[i + 1], (m_size - i - 1) * sizeof (struct TagData));
+  m_size--;
+  UpdateMask ();
+  return true;
 }
 
-// COWWriter implementing Replace
 bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
+PacketTagList::Replace (Tag & tag)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  if (preMerge)
-    {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data,
-                                cur->data + tag.GetSerializedSize ()));
-    }
-  else
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t i = Find (tid);
+  if (i == m_size)
     {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = new struct TagData ();
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data,
-                                copy->data + tag.GetSerializedSize ()));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
-        {
-          copy->next->count++;          // mark new merge
-        }
-      *prevNext = copy;                 // point prior list at copy
+      Add (tag);
+      return false;
     }
-  return found;
+  NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
+  struct TagData *cur = &GetWritable (m_size)[i];
+  tag.Serialize (TagBuffer (cur->data, cur->data + tag.GetSerializedSize ()));
+  return true;
 }
 
 void 
 PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
-    {
-      NS_ASSERT (cur->tid != tag.GetInstanceTypeId ());
-    }
-  struct TagData * head = new struct TagData ();
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
+  NS_ASSERT (Find (tid) == m_size);
   NS_ASSERT (tag.GetSerializedSize () <= TagData::MAX_SIZE);
-  tag.Serialize (TagBuffer (head->data, head->data + tag.GetSerializedSize ()));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  struct TagData *cur = &self->GetWritable (m_size + 1)[m_size];
+  cur->tid = tid;
+  tag.Serialize (TagBuffer (cur->data, cur->data + tag.GetSerializedSize ()));
+  self->m_size++;
+  self->m_mask |= GetMaskBit (tid);
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t i = Find (tid);
+  if (i == m_size)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + TagData::MAX_SIZE));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
-}
-
-const struct PacketTagList::TagData *
-PacketTagList::Head (void) const
-{
-  return m_next;
+  /* found tag */
+  const struct TagData *cur = &Head ()[i];
+  tag.Deserialize (TagBuffer (const_cast<uint8_t *> (cur->data),
+                              const_cast<uint8_t *> (cur->data) + TagData::MAX_SIZE));
+  return true;
 }
 
 } /* namespace ns3 */
-
@@ -22,7 +22,7 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a flat list of Packet tags, including copy-on-write semantics.
 */
 
 #include <stdint.h>
@@ -43,94 +43,39 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ * Tags are stored in serialized form in a contiguous array of TagData,
+ * in the order they were added:
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      };
- * \enddot
+ *   - The first #INLINE_SIZE tags are stored in the PacketTagList
+ *     itself, that is, in the Packet object.  Adding, replacing and
+ *     removing them never allocates memory, and copying the list
+ *     copies only the tags in use.  Most packets carry no more than
+ *     a couple of tags, so this is the common case.
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
+ *   - When a tag is added to a full inline array, all the tags are
+ *     moved to a heap-allocated TagBlock, which is large enough to
+ *     receive several more.  From then on, the list uses only the
+ *     block, even if tags are removed later.
  *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
+ *   - A TagBlock is shared, with a reference \c count, by all the
+ *     copies of the list: #Add, #Remove and #Replace first copy the
+ *     block if it is shared (copy-on-write), so that they never affect
+ *     any other PacketTagList.
  *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
- *
- * \par <b> Copy-on-write </b> is implemented as follows:
- *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
- *   - Copy constructor (PacketTagList(const PacketTagList & o))
- *     and assignment (#operator=(const PacketTagList & o)
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
- *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ *   - Each list keeps a bitmask of the TypeId uids of the tags it
+ *     holds (one bit per uid modulo 32).  #Peek, #Remove and #Replace
+ *     of a tag type which is not in the list are answered from the
+ *     mask alone; otherwise, the short array is scanned.
  *
  * \par <b> Memory Management: </b>
  * \n
  * Packet tags must serialize to a finite maximum size, see TagData
- *
- * This documentation entitles the original author to a free beer.
  */
 class PacketTagList 
 {
 public:
   /**
-   * Tree node for sharing serialized tags.
+   * Serialized tag.
    *
    * See PacketTagList for a discussion of the data structure.
    *
@@ -146,15 +91,10 @@ public:
      * in this constant.
      *
      * \internal
-     * Ideally, TagData would be 32 bytes in size, so they require
-     * no padding on 64-bit architectures.  (The architecture
-     * affects the size because of the \c #next pointer.)
-     * This would leave 18 bytes for \c #data.  However,
-     * ns3:Ipv6PacketInfoTag needs 19 bytes!  The current
+     * ns3:Ipv6PacketInfoTag needs 19 bytes.  The current
      * implementation allows 20 bytes, which gives TagData
-     * a size of 30 bytes on 32-byte machines (which gets
-     * padded with 2 bytes), and 34 bytes on 64-bit machines, which
-     * gets padded to 40 bytes.
+     * a size of 22 bytes.  Since TagData are stored in the
+     * Packet object, this limit should not grow lightly.
      */
     enum TagData_e
     {
@@ -162,11 +102,17 @@ public:
   };
 
     uint8_t data[MAX_SIZE];   /**< Serialization buffer */
-    struct TagData * next;   /**< Pointer to next in list */
     TypeId tid;               /**< Type of the tag serialized into #data */
-    uint32_t count;           /**< Number of incoming links */
   };  /* struct TagData */
 
+  /**
+   * Number of tags stored in the PacketTagList itself.
+   */
+  enum
+  {
+    INLINE_SIZE = 4
+  };
+
   /**
    * Create a new PacketTagList.
    */
@@ -176,8 +122,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This copies the inline tags of \pname{o}, or shares
+   * its \ref TagBlock.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -185,19 +131,19 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy by #RemoveAll, then copying
+   * the inline tags of \pname{o}, or sharing its \ref TagBlock.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
    *
-   * #RemoveAll's the tags up to the first merge.
+   * #RemoveAll's the tags.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag at the end of the list.
    *
    * \param [in] tag The tag to add
    */
@@ -229,67 +175,65 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to the first tag of the list.  The tags
+   *          are contiguous, see GetSize.
+   */
+  inline const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns the number of tags in the list.
    */
-  const struct PacketTagList::TagData *Head (void) const;
+  inline uint32_t GetSize (void) const;
 
 private:
   /**
-   * Typedef of method function pointer for copy-on-write operations
-   *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * Heap storage of the tags, when they do not fit in the
+   * PacketTagList.  Allocated with room for \c capacity tags.
+   */
+  struct TagBlock
+  {
+    uint32_t count;           /**< Number of PacketTagList sharing this block */
+    uint32_t capacity;        /**< Number of TagData in #tags */
+    struct TagData tags[1];   /**< The tags */
+  };
+
+  /**
+   * \param [in] tid The tag type to find.
+   * \returns the index of the tag of type \pname{tid}, or #GetSize
+   *          if there is none.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  uint32_t Find (TypeId tid) const;
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
+   * Make sure the tags can be modified without affecting other
+   * lists, and that there is room for \pname{size} tags.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] size The number of tags needed.
+   * \returns pointer to the first tag.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  struct TagData *GetWritable (uint32_t size);
   /**
-   * Copy-on-write implementing Remove.
-   *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * Recompute #m_mask from the tags in the list.
    */
-  bool RemoveWriter  (Tag       & tag, bool         preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  void UpdateMask (void);
   /**
-   * Copy-on-write implementing Replace
+   * Release a reference to a TagBlock, and delete it if unused.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \param [in] block The block to release.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge, struct TagData * cur, struct TagData ** prevNext);
-
+  static void Deallocate (struct TagBlock *block);
   /**
-   * Pointer to first \ref TagData on the list
+   * \param [in] tid A tag type.
+   * \returns the bit of #m_mask for \pname{tid}.
    */
-  struct TagData *m_next;
+  static uint32_t GetMaskBit (TypeId tid);
+
+  uint32_t m_size;                    //!< Number of tags in the list
+  uint32_t m_mask;                    //!< Bitmask of the tag types in the list
+  struct TagBlock *m_block;           //!< Heap storage, or zero to use #m_tags
+  struct TagData m_tags[INLINE_SIZE]; //!< Inline storage of the first tags
 };
 
 } // namespace ns3
@@ -298,19 +242,29 @@ private:
  *  Implementation of inline methods for performance
  ****************************************************/
 
+#include <cstring>
+
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_size (0),
+    m_mask (0),
+    m_block (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_size (o.m_size),
+    m_mask (o.m_mask),
+    m_block (o.m_block)
 {
-  if (m_next != 0)
+  if (m_block != 0)
+    {
+      m_block->count++;
+    }
+  else
     {
-      m_next->count++;
+      std::memcpy (m_tags, o.m_tags, m_size * sizeof (struct TagData));
     }
 }
 
@@ -318,15 +272,21 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o)
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  m_size = o.m_size;
+  m_mask = o.m_mask;
+  m_block = o.m_block;
+  if (m_block != 0)
+    {
+      m_block->count++;
+    }
+  else
     {
-      m_next->count++;
+      std::memcpy (m_tags, o.m_tags, m_size * sizeof (struct TagData));
     }
   return *this;
 }
@@ -339,25 +299,25 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
-    {
-      cur->count--;
-      if (cur->count > 0) 
-        {
-          break;
-        }
-      if (prev != 0) 
-        {
-	  delete prev;
-        }
-      prev = cur;
-    }
-  if (prev != 0) 
+  if (m_block != 0)
     {
-      delete prev;
+      Deallocate (m_block);
+      m_block = 0;
     }
-  m_next = 0;
+  m_size = 0;
+  m_mask = 0;
+}
+
+const struct PacketTagList::TagData *
+PacketTagList::Head (void) const
+{
+  return m_block != 0 ? m_block->tags : m_tags;
+}
+
+uint32_t
+PacketTagList::GetSize (void) const
+{
+  return m_size;
 }
 
 } // namespace ns3
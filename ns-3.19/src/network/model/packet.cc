@@ -21,6 +21,10 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
 #include <string>
 #include <cstdarg>
 
@@ -30,6 +34,108 @@ namespace ns3 {
 
 uint32_t Packet::m_globalUid = 0;
 
+#ifdef PACKET_FREE_LIST
+namespace {
+
+/// The memory of a deleted Packet, in the free list.
+struct FreePacket
+{
+  struct FreePacket *next;
+};
+
+/// The maximum number of packets kept in the free list.
+const uint32_t MAX_FREE_PACKETS = 1024;
+
+/**
+ * The memory of the deleted packets, released at the end of the
+ * program.  Only the thread which first creates a packet, the one
+ * which runs the simulation, uses it, so that no lock is needed: the
+ * packets created or deleted by the other threads, such as the reader
+ * threads of the emulated devices, bypass it.
+ */
+struct PacketFreeList
+{
+  ~PacketFreeList ();
+  /// \returns true if the calling thread may use the list.
+  bool IsOwner (void);
+
+  struct FreePacket *head;
+  uint32_t size;
+  bool destroyed;
+#ifdef HAVE_PTHREAD_H
+  bool hasOwner;
+  SystemThread::ThreadId owner;
+#endif /* HAVE_PTHREAD_H */
+};
+
+/**
+ * Zero-initialized before any packet is created; the packets deleted
+ * after its destruction go back to the system.
+ */
+struct PacketFreeList g_freePackets;
+
+PacketFreeList::~PacketFreeList ()
+{
+  while (head != 0)
+    {
+      struct FreePacket *next = head->next;
+      ::operator delete (head);
+      head = next;
+    }
+  size = 0;
+  destroyed = true;
+}
+
+bool
+PacketFreeList::IsOwner (void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (!hasOwner)
+    {
+      owner = SystemThread::Self ();
+      hasOwner = true;
+    }
+  return SystemThread::Equals (owner);
+#else
+  return true;
+#endif /* HAVE_PTHREAD_H */
+}
+
+} // anonymous namespace
+
+void *
+Packet::operator new (std::size_t size)
+{
+  struct FreePacket *p = g_freePackets.head;
+  if (p == 0 || size != sizeof (Packet) || !g_freePackets.IsOwner ())
+    {
+      return ::operator new (size);
+    }
+  g_freePackets.head = p->next;
+  g_freePackets.size--;
+  return p;
+}
+
+void
+Packet::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  if (g_freePackets.destroyed || g_freePackets.size >= MAX_FREE_PACKETS
+      || size != sizeof (Packet) || !g_freePackets.IsOwner ())
+    {
+      ::operator delete (p);
+      return;
+    }
+  struct FreePacket *item = static_cast<struct FreePacket *> (p);
+  item->next = g_freePackets.head;
+  g_freePackets.head = item;
+  g_freePackets.size++;
+}
+#endif /* PACKET_FREE_LIST */
+
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
 {
@@ -81,21 +187,22 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head, uint32_t size)
+  : m_current (head),
+    m_end (head + size)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current != m_end;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
   const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
+  m_current++;
   return PacketTagIterator::Item (prev);
 }
 
@@ -898,7 +1005,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList.Head (), m_packetTagList.GetSize ());
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
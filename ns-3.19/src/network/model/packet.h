@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -34,6 +35,8 @@
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
 
+#define PACKET_FREE_LIST 1
+
 namespace ns3 {
 
 /**
@@ -147,8 +150,9 @@ private:
   Item Next (void);
 private:
   friend class Packet;
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const struct PacketTagList::TagData *head, uint32_t size);
   const struct PacketTagList::TagData *m_current;
+  const struct PacketTagList::TagData *m_end;
 };
 
 /**
@@ -214,9 +218,11 @@ public:
   /**
    * Create a packet with a zero-filled payload.
    * The memory necessary for the payload is not allocated:
-   * it will be allocated at any later point if you attempt
-   * to fragment this packet or to access the zero-filled
-   * bytes. The packet is allocated with a new uid (as 
+   * headers, trailers, fragmentation and reassembly, serialization
+   * and pcap output all keep it virtual.  It is allocated only if
+   * you access the zero-filled bytes with PeekData, or when two
+   * packets with a payload are concatenated, for the smaller of
+   * the two. The packet is allocated with a new uid (as 
    * returned by getUid).
    * 
    * \param size the size of the zero-filled payload
@@ -578,6 +584,28 @@ public:
    */
   Ptr<NixVector> GetNixVector (void) const; 
 
+#ifdef PACKET_FREE_LIST
+  /**
+   * Allocate the memory of a Packet.  The memory of the deleted packets
+   * is reused first, so that creating and deleting packets does not
+   * allocate memory in steady state.  Only the thread which runs the
+   * simulation reuses memory; the other threads get it from the system.
+   *
+   * \param size the size of the object to allocate
+   * \returns the memory allocated
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * Release the memory of a Packet into the free list, or to the system
+   * if the free list is full, if it was destroyed at the end of the
+   * program, or if the calling thread does not run the simulation.
+   *
+   * \param p the memory to release
+   * \param size the size of the object released
+   */
+  static void operator delete (void *p, std::size_t size);
+#endif /* PACKET_FREE_LIST */
+
 private:
   Packet (const Buffer &buffer, const ByteTagList &byteTagList, 
           const PacketTagList &packetTagList, const PacketMetadata &metadata);
@@ -321,7 +321,104 @@ BufferTest::DoRun (void)
       NS_TEST_ASSERT_MSG_EQ ( evilBuffer [i], cBuf [i] , "Bad buffer peeked");
     }
   free (cBuf);
+
+  // Concatenated buffers keep the larger zero area virtual.
+  buffer = Buffer (500);
+  buffer.AddAtStart (2);
+  i = buffer.Begin ();
+  i.WriteU8 (0x1);
+  i.WriteU8 (0x2);
+  frag0 = buffer.CreateFragment (0, 252);
+  frag1 = buffer.CreateFragment (252, 250);
+  frag1.AddAtStart (1);
+  frag1.Begin ().WriteU8 (0x3);
+  frag0.AddAtEnd (frag1);
+  NS_TEST_ASSERT_MSG_EQ (frag0.GetSize (), 503, "Bad size of concatenated fragments");
+  NS_TEST_EXPECT_MSG_LT (frag0.GetSerializedSize (), 300, "Zero area not kept virtual");
+  i = frag0.Begin ();
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x1, "Bad concatenated content");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x2, "Bad concatenated content");
+  i.Next (250);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x3, "Bad concatenated content");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0, "Bad concatenated content");
+
+  buffer = Buffer (10);
+  other = Buffer (1000);
+  other.AddAtStart (1);
+  other.Begin ().WriteU8 (0x4);
+  buffer.AddAtEnd (other);
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 1011, "Bad size of concatenated buffers");
+  NS_TEST_EXPECT_MSG_LT (buffer.GetSerializedSize (), 100, "Larger zero area not kept virtual");
+  i = buffer.Begin ();
+  i.Next (10);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x4, "Bad concatenated content");
+
+  // Concatenation of buffers which share their data.
+  buffer = Buffer (100);
+  buffer.AddAtStart (1);
+  buffer.Begin ().WriteU8 (0x5);
+  other = buffer;
+  buffer.AddAtEnd (other);
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 202, "Bad size of concatenated buffers");
+  NS_TEST_EXPECT_MSG_LT (buffer.GetSerializedSize (), 150, "Zero area not kept virtual");
+  i = buffer.Begin ();
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x5, "Bad concatenated content");
+  i.Next (100);
+  NS_TEST_EXPECT_MSG_EQ (i.ReadU8 (), 0x5, "Bad concatenated content");
+  NS_TEST_EXPECT_MSG_EQ (other.GetSize (), 101, "Shared buffer modified");
 }
+
+namespace ns3 {
+
+/**
+ * Once a stack of headers has been seen, new and reallocated buffers
+ * keep room for it in front of their zero area, up to a cap.  The
+ * global heuristic is restored afterwards.
+ */
+class BufferHeadroomTest : public TestCase
+{
+public:
+  BufferHeadroomTest ();
+private:
+  virtual void DoRun (void);
+};
+
+BufferHeadroomTest::BufferHeadroomTest ()
+  : TestCase ("Buffer headroom")
+{
+}
+
+void
+BufferHeadroomTest::DoRun (void)
+{
+  uint32_t recommendedStart = Buffer::g_recommendedStart;
+  Buffer::g_recommendedStart = 0;
+  {
+    Buffer headers (1000);
+    headers.AddAtStart (300);
+  }
+  NS_TEST_EXPECT_MSG_EQ (Buffer::g_recommendedStart, 300, "Stack of headers not recorded");
+  {
+    Buffer buffer = Buffer (1000);
+    NS_TEST_EXPECT_MSG_EQ (buffer.AddAtStart (100), false, "Buffer reallocated for the first header");
+    NS_TEST_EXPECT_MSG_EQ (buffer.AddAtStart (100), false, "Buffer reallocated for the second header");
+    Buffer other = buffer;
+    other.AddAtStart (1);
+    NS_TEST_EXPECT_MSG_EQ (buffer.AddAtStart (10), true, "Shared buffer not reallocated");
+    NS_TEST_EXPECT_MSG_EQ (buffer.AddAtStart (10), false, "No headroom after reallocation");
+    NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 1220, "Bad size after reallocation");
+  }
+
+  {
+    Buffer headers (1000);
+    headers.AddAtStart (5000);
+  }
+  NS_TEST_EXPECT_MSG_EQ (Buffer::g_recommendedStart, 512, "Headroom of new buffers not capped");
+  Buffer::g_recommendedStart = recommendedStart;
+}
+
+} // namespace ns3
+
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
 {
@@ -333,6 +430,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferHeadroomTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite;
@@ -0,0 +1,290 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/columnar-trace-file.h"
+#include "ns3/columnar-trace-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceTestSuite");
+
+using namespace ns3;
+
+// ===========================================================================
+// Write records spanning several blocks, and read them back.
+// ===========================================================================
+class ColumnarTraceFileTestCase : public TestCase
+{
+public:
+  ColumnarTraceFileTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_testFilename;
+};
+
+ColumnarTraceFileTestCase::ColumnarTraceFileTestCase ()
+  : TestCase ("Check that ColumnarTraceFile reads back the records it writes")
+{
+}
+
+void
+ColumnarTraceFileTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".nsc");
+}
+
+void
+ColumnarTraceFileTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+ColumnarTraceFileTestCase::DoRun (void)
+{
+  const uint32_t N_RECORDS = 25;
+  ColumnarTraceFile::Record record;
+
+  ColumnarTraceFile f;
+  f.SetBlockSize (8);
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", \"w\") returns error");
+  for (uint32_t i = 0; i < N_RECORDS; ++i)
+    {
+      std::memset (&record, 0, sizeof (record));
+      record.time = 1000000 * (int64_t)i;
+      record.uid = i + 100;
+      record.node = i % 3;
+      record.device = i % 2;
+      record.size = 40 + i;
+      record.tcpSequence = 0x01020304 + i;
+      record.tcpAck = 0xfffffff0 + i;
+      record.sourcePort = 49153 + i;
+      record.destinationPort = 80;
+      record.source[0] = i;
+      record.destination[15] = i;
+      record.event = i % 5;
+      record.protocol = 6;
+      record.hopLimit = 64;
+      record.tcpFlags = 0x10;
+      f.Write (record);
+    }
+  f.Close ();
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Close () returns error");
+  NS_TEST_EXPECT_MSG_EQ (f.GetNRecords (), N_RECORDS, "Wrong number of records written");
+
+  ColumnarTraceFile g;
+  g.Open (m_testFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (g.Fail (), false, "Open (" << m_testFilename << ", \"r\") returns error");
+  uint32_t i = 0;
+  while (g.Read (record))
+    {
+      NS_TEST_ASSERT_MSG_LT (i, N_RECORDS, "Too many records read");
+      NS_TEST_EXPECT_MSG_EQ (record.time, 1000000 * (int64_t)i, "Wrong time");
+      NS_TEST_EXPECT_MSG_EQ (record.uid, i + 100, "Wrong uid");
+      NS_TEST_EXPECT_MSG_EQ (record.node, i % 3, "Wrong node");
+      NS_TEST_EXPECT_MSG_EQ (record.device, i % 2, "Wrong device");
+      NS_TEST_EXPECT_MSG_EQ (record.size, 40 + i, "Wrong size");
+      NS_TEST_EXPECT_MSG_EQ (record.tcpSequence, 0x01020304 + i, "Wrong sequence number");
+      NS_TEST_EXPECT_MSG_EQ (record.tcpAck, 0xfffffff0 + i, "Wrong acknowledgment number");
+      NS_TEST_EXPECT_MSG_EQ (record.sourcePort, 49153 + i, "Wrong source port");
+      NS_TEST_EXPECT_MSG_EQ (record.destinationPort, 80, "Wrong destination port");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.source[0], i, "Wrong source address");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.destination[15], i, "Wrong destination address");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.event, i % 5, "Wrong event");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.protocol, 6, "Wrong protocol");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.hopLimit, 64, "Wrong hop limit");
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.tcpFlags, 0x10, "Wrong TCP flags");
+      ++i;
+    }
+  NS_TEST_EXPECT_MSG_EQ (i, N_RECORDS, "Wrong number of records read");
+  NS_TEST_EXPECT_MSG_EQ (g.Eof (), true, "Read should stop at the end of the file");
+  g.Close ();
+}
+
+// ===========================================================================
+// Fill records from the bytes of IPv4 and IPv6 packets.
+// ===========================================================================
+class ColumnarTraceFillTestCase : public TestCase
+{
+public:
+  ColumnarTraceFillTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ColumnarTraceFillTestCase::ColumnarTraceFillTestCase ()
+  : TestCase ("Check that ColumnarTraceHelper::FillRecord parses the IP and transport headers")
+{
+}
+
+void
+ColumnarTraceFillTestCase::DoRun (void)
+{
+  ColumnarTraceFile::Record record;
+
+  //
+  // PPP, IPv4 and UDP headers.
+  //
+  uint8_t ipv4[] = {
+    0x00, 0x21,
+    0x45, 0x00, 0x00, 0x20, 0x00, 0x01, 0x00, 0x00, 0x3f, 0x11, 0x00, 0x00,
+    0x0a, 0x01, 0x01, 0x01, 0x0a, 0x01, 0x02, 0x02,
+    0x04, 0xd2, 0x00, 0x09, 0x00, 0x0c, 0x00, 0x00,
+    0x01, 0x02, 0x03, 0x04
+  };
+  Ptr<Packet> p = Create<Packet> (ipv4, sizeof (ipv4));
+  ColumnarTraceHelper::FillRecord (p, record);
+  NS_TEST_EXPECT_MSG_EQ (record.size, sizeof (ipv4), "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ (record.uid, p->GetUid (), "Wrong uid");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.protocol, 17, "Wrong protocol");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.hopLimit, 63, "Wrong TTL");
+  uint8_t source[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 10, 1, 1, 1 };
+  uint8_t destination[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 10, 1, 2, 2 };
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (record.source, source, 16), 0, "Wrong source address");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (record.destination, destination, 16), 0, "Wrong destination address");
+  NS_TEST_EXPECT_MSG_EQ (record.sourcePort, 1234, "Wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (record.destinationPort, 9, "Wrong destination port");
+  NS_TEST_EXPECT_MSG_EQ (record.tcpSequence, 0, "UDP has no sequence number");
+
+  //
+  // A later fragment has no transport header.
+  //
+  ipv4[8] = 0x00;
+  ipv4[9] = 0x10;
+  p = Create<Packet> (ipv4, sizeof (ipv4));
+  ColumnarTraceHelper::FillRecord (p, record);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.protocol, 17, "Wrong protocol");
+  NS_TEST_EXPECT_MSG_EQ (record.sourcePort, 0, "A later fragment has no ports");
+
+  //
+  // LLC/SNAP, IPv6, destination options and TCP headers.
+  //
+  uint8_t ipv6[8 + 40 + 8 + 20];
+  std::memset (ipv6, 0, sizeof (ipv6));
+  uint8_t llc[] = { 0xaa, 0xaa, 0x03, 0x00, 0x00, 0x00, 0x86, 0xdd };
+  std::memcpy (ipv6, llc, sizeof (llc));
+  uint8_t *ip = ipv6 + 8;
+  ip[0] = 0x60;
+  ip[5] = 28;
+  ip[6] = 60;
+  ip[7] = 255;
+  ip[8] = 0x20;
+  ip[9] = 0x01;
+  ip[23] = 1;
+  ip[24] = 0x20;
+  ip[25] = 0x01;
+  ip[39] = 2;
+  uint8_t *options = ip + 40;
+  options[0] = 6;
+  options[1] = 0;
+  options[2] = 1;
+  options[3] = 4;
+  uint8_t *tcp = options + 8;
+  uint8_t tcpHeader[] = {
+    0xc0, 0x01, 0x00, 0x50, 0x12, 0x34, 0x56, 0x78,
+    0x9a, 0xbc, 0xde, 0xf0, 0x50, 0x12, 0xff, 0xff
+  };
+  std::memcpy (tcp, tcpHeader, sizeof (tcpHeader));
+  p = Create<Packet> (ipv6, sizeof (ipv6));
+  ColumnarTraceHelper::FillRecord (p, record);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.protocol, 6, "Wrong protocol");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.hopLimit, 255, "Wrong hop limit");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.source[0], 0x20, "Wrong source address");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.source[15], 1, "Wrong source address");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.destination[15], 2, "Wrong destination address");
+  NS_TEST_EXPECT_MSG_EQ (record.sourcePort, 49153, "Wrong source port");
+  NS_TEST_EXPECT_MSG_EQ (record.destinationPort, 80, "Wrong destination port");
+  NS_TEST_EXPECT_MSG_EQ (record.tcpSequence, 0x12345678, "Wrong sequence number");
+  NS_TEST_EXPECT_MSG_EQ (record.tcpAck, 0x9abcdef0, "Wrong acknowledgment number");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.tcpFlags, 0x12, "Wrong TCP flags");
+
+  //
+  // Ethernet II header, as in the traces of CsmaNetDevice, on the IPv4
+  // packet above. The first byte of the destination MAC address looks
+  // like the version of an IPv4 header.
+  //
+  ipv4[8] = 0x00;
+  ipv4[9] = 0x00;
+  p = Create<Packet> (ipv4 + 2, sizeof (ipv4) - 2);
+  EthernetHeader ethernet (false);
+  ethernet.SetSource (Mac48Address ("00:00:00:00:00:01"));
+  ethernet.SetDestination (Mac48Address ("45:00:00:00:00:02"));
+  ethernet.SetLengthType (0x0800);
+  p->AddHeader (ethernet);
+  ColumnarTraceHelper::FillRecord (p, record);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.protocol, 17, "Wrong protocol behind Ethernet II");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.hopLimit, 63, "Wrong TTL behind Ethernet II");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (record.source, source, 16), 0, "Wrong source address behind Ethernet II");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (record.destination, destination, 16), 0, "Wrong destination address behind Ethernet II");
+  NS_TEST_EXPECT_MSG_EQ (record.sourcePort, 1234, "Wrong source port behind Ethernet II");
+  NS_TEST_EXPECT_MSG_EQ (record.destinationPort, 9, "Wrong destination port behind Ethernet II");
+
+  //
+  // IEEE 802.3 and LLC/SNAP headers, the other encapsulation of
+  // CsmaNetDevice.
+  //
+  p = Create<Packet> (ipv4 + 2, sizeof (ipv4) - 2);
+  LlcSnapHeader llcSnap;
+  llcSnap.SetType (0x0800);
+  p->AddHeader (llcSnap);
+  ethernet.SetLengthType (p->GetSize ());
+  p->AddHeader (ethernet);
+  ColumnarTraceHelper::FillRecord (p, record);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.protocol, 17, "Wrong protocol behind LLC/SNAP");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (record.source, source, 16), 0, "Wrong source address behind LLC/SNAP");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (record.destination, destination, 16), 0, "Wrong destination address behind LLC/SNAP");
+  NS_TEST_EXPECT_MSG_EQ (record.sourcePort, 1234, "Wrong source port behind LLC/SNAP");
+  NS_TEST_EXPECT_MSG_EQ (record.destinationPort, 9, "Wrong destination port behind LLC/SNAP");
+
+  //
+  // A packet which is not IP only has its size and uid.
+  //
+  p = Create<Packet> (100);
+  ColumnarTraceHelper::FillRecord (p, record);
+  NS_TEST_EXPECT_MSG_EQ (record.size, 100, "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)record.protocol, 0, "Not an IP packet");
+  NS_TEST_EXPECT_MSG_EQ (record.sourcePort, 0, "Not an IP packet");
+}
+
+static class ColumnarTraceTestSuite : public TestSuite
+{
+public:
+  ColumnarTraceTestSuite ()
+    : TestSuite ("columnar-trace", UNIT)
+  {
+    AddTestCase (new ColumnarTraceFileTestCase, TestCase::QUICK);
+    AddTestCase (new ColumnarTraceFillTestCase, TestCase::QUICK);
+  }
+} g_columnarTraceTestSuite;
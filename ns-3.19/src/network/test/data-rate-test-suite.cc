@@ -0,0 +1,76 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Pins the transmission times the devices schedule with
+ * DataRate::CalculateBytesTxTime, in the default nanosecond resolution.
+ */
+class DataRateTxTimeTestCase : public TestCase
+{
+public:
+  DataRateTxTimeTestCase ();
+private:
+  virtual void DoRun (void);
+  void Check (std::string rate, uint32_t bytes, int64_t ns);
+};
+
+DataRateTxTimeTestCase::DataRateTxTimeTestCase ()
+  : TestCase ("Check the transmission time of a number of bytes")
+{
+}
+
+void
+DataRateTxTimeTestCase::Check (std::string rate, uint32_t bytes, int64_t ns)
+{
+  NS_TEST_EXPECT_MSG_EQ (DataRate (rate).CalculateBytesTxTime (bytes).GetNanoSeconds (), ns,
+                         bytes << " bytes at " << rate);
+}
+
+void
+DataRateTxTimeTestCase::DoRun (void)
+{
+  // exact times: Seconds (CalculateTxTime ()) gives one step less for these
+  Check ("5Mbps", 1500, 2400000);
+  Check ("100Mbps", 1500, 120000);
+  Check ("1Gbps", 1000, 8000);
+  NS_TEST_EXPECT_MSG_EQ (Seconds (DataRate ("5Mbps").CalculateTxTime (1500)).GetNanoSeconds (), 2399999,
+                         "The double conversion used to round 2.4 ms down");
+
+  // inexact times are rounded down
+  Check ("7Mbps", 1500, 1714285);
+  Check ("3bps", 1, 2666666666LL);
+  Check ("10Gbps", 1, 0);
+
+  // too many bits for the integer product: back to the double conversion
+  NS_TEST_EXPECT_MSG_EQ_TOL (DataRate ("1Gbps").CalculateBytesTxTime (0xffffffff).GetNanoSeconds (),
+                             34359738360LL, 1, "Transmission time of the largest packet");
+}
+
+static class DataRateTestSuite : public TestSuite
+{
+public:
+  DataRateTestSuite ()
+    : TestSuite ("data-rate", UNIT)
+  {
+    AddTestCase (new DataRateTxTimeTestCase (), TestCase::QUICK);
+  }
+} g_dataRateTestSuite;
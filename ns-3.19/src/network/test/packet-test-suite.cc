@@ -21,6 +21,10 @@
 #include "ns3/packet-tag-list.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif /* HAVE_PTHREAD_H */
 #include <limits>     // std:numeric_limits
 #include <string>
 #include <cstdarg>
@@ -225,11 +229,21 @@ public:
   virtual void DoRun (void);
 private:
   void DoCheck (Ptr<const Packet> p, const char *file, int line, uint32_t n, ...);
+  void CreateInThread (void);
+  const Packet *m_threadPacket;
 };
 
 
 PacketTest::PacketTest ()
-  : TestCase ("Packet") {
+  : TestCase ("Packet"),
+    m_threadPacket (0) {
+}
+
+void
+PacketTest::CreateInThread (void)
+{
+  Ptr<Packet> p = Create<Packet> (10);
+  m_threadPacket = PeekPointer (p);
 }
 
 void
@@ -405,6 +419,21 @@ PacketTest::DoRun (void)
     CHECK (tmp, 1, E (10, 0, 10));
   }
 
+  {
+    // offsets updated in place, and in a shared list
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddByteTag (ATestTag<20> ());
+    tmp->AddByteTag (ATestTag<21> ());
+    Ptr<Packet> copy = tmp->Copy ();
+    tmp->AddHeader (ATestHeader<10> ());
+    CHECK (tmp, 2, E (20, 10, 110), E (21, 10, 110));
+    CHECK (copy, 2, E (20, 0, 100), E (21, 0, 100));
+    tmp->AddHeader (ATestHeader<10> ());
+    CHECK (tmp, 2, E (20, 20, 120), E (21, 20, 120));
+    copy->AddTrailer (ATestTrailer<10> ());
+    CHECK (copy, 2, E (20, 0, 100), E (21, 0, 100));
+  }
+
   {
     Packet p;
     ATestTag<10> a;
@@ -451,6 +480,35 @@ PacketTest::DoRun (void)
     CHECK (tmp, 1, E (20, 1, 1001));
 #endif
   }
+
+#ifdef PACKET_FREE_LIST
+  {
+    // the memory of a deleted packet is reused by the next one.
+    Ptr<Packet> tmp = Create<Packet> (100);
+    const Packet *address = PeekPointer (tmp);
+    tmp = 0;
+    tmp = Create<Packet> (200);
+    NS_TEST_EXPECT_MSG_EQ (PeekPointer (tmp), address, "The packet memory is not recycled");
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 200, "Wrong size of a recycled packet");
+    Ptr<Packet> copy = tmp->Copy ();
+    NS_TEST_EXPECT_MSG_NE (PeekPointer (copy), address, "A live packet is reused");
+    NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 200, "Wrong size of a packet copy");
+  }
+#ifdef HAVE_PTHREAD_H
+  {
+    // the other threads do not take the memory of the free list.
+    Ptr<Packet> tmp = Create<Packet> (100);
+    const Packet *address = PeekPointer (tmp);
+    tmp = 0;
+    Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&PacketTest::CreateInThread, this));
+    thread->Start ();
+    thread->Join ();
+    NS_TEST_EXPECT_MSG_NE (m_threadPacket, address, "Another thread reused the free list");
+    tmp = Create<Packet> (100);
+    NS_TEST_EXPECT_MSG_EQ (PeekPointer (tmp), address, "The packet memory is not recycled");
+  }
+#endif /* HAVE_PTHREAD_H */
+#endif /* PACKET_FREE_LIST */
 }
 //--------------------------------------
 class PacketTagListTest : public TestCase
@@ -675,6 +733,42 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (7);
   }
   
+  { // Inline storage
+    std::cout << GetName () << "check copies across the inline limit"
+              << std::endl;
+    PacketTagList ptl;
+    ptl.Add (t1);
+    ptl.Add (t2);
+    ptl.Add (t3);
+    ptl.Add (t4);
+    NS_TEST_EXPECT_MSG_EQ (ptl.GetSize (), (uint32_t)PacketTagList::INLINE_SIZE,
+                           "inline list full");
+    PacketTagList big = ptl;
+    big.Add (t5);             // moves big to the heap
+    PacketTagList shared = big;
+    shared.Remove (t1);       // unshares the heap block
+    CheckRefList (ref, "inline limit, orig");
+    const char * msg = "inline limit, inline";
+    CheckRef (ptl, t1, msg, false);
+    CheckRef (ptl, t4, msg, false);
+    CheckRef (ptl, t5, msg, true);
+    msg = "inline limit, heap";
+    CheckRef (big, t1, msg, false);
+    CheckRef (big, t5, msg, false);
+    msg = "inline limit, heap copy";
+    CheckRef (shared, t1, msg, true);
+    CheckRef (shared, t5, msg, false);
+    NS_TEST_EXPECT_MSG_EQ (big.GetSize (), 5, "heap list size");
+    NS_TEST_EXPECT_MSG_EQ (shared.GetSize (), 4, "heap copy size");
+
+    // the tags are kept in the order they were added
+    for (uint32_t i = 0; i < shared.GetSize (); ++i)
+      {
+        NS_TEST_EXPECT_MSG_EQ (shared.Head ()[i].tid, big.Head ()[i + 1].tid,
+                               "tag order, index " << i);
+      }
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
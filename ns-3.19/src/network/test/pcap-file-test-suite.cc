@@ -21,10 +21,12 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <algorithm>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -1120,6 +1122,121 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+// ===========================================================================
+// Test case to make sure that the records batched in memory reach the file
+// in order, with and without the background writer thread.
+// ===========================================================================
+class BatchTestCase : public TestCase
+{
+public:
+  BatchTestCase (bool async);
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  bool m_async;
+  std::string m_testFilename;
+};
+
+BatchTestCase::BatchTestCase (bool async)
+  : TestCase (async ? "Check that the pcap records are written by the background thread"
+              : "Check that the pcap records are written in batches"),
+    m_async (async)
+{
+}
+
+void
+BatchTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_testFilename = CreateTempDirFilename (filename.str () + ".pcap");
+}
+
+void
+BatchTestCase::DoTeardown (void)
+{
+  if (remove (m_testFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_testFilename);
+    }
+}
+
+void
+BatchTestCase::DoRun (void)
+{
+  const uint32_t nPackets = 100;
+  PcapFile f;
+  f.SetBufferSize (4096);
+  f.SetAsynchronous (m_async);
+  f.Open (m_testFilename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", \"std::ios::out\") returns error");
+  f.Init (1, 100);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Init (1, 100) returns error");
+  f.Flush ();
+  NS_TEST_ASSERT_MSG_EQ (CheckFileLength (m_testFilename, 24), true, "Flush () does not write the file header");
+
+  //
+  // The first records fit in the batch and are not in the file yet.
+  //
+  uint8_t data[10];
+  std::memset (data, 0xab, sizeof (data));
+  f.Write (0, 1, data, sizeof (data));
+  f.Write (0, 2, data, sizeof (data));
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Write () returns error");
+  NS_TEST_ASSERT_MSG_EQ (CheckFileLength (m_testFilename, 24), true, "The records are not batched");
+  f.Flush ();
+  NS_TEST_ASSERT_MSG_EQ (CheckFileLength (m_testFilename, 24 + 2 * (16 + 10)), true,
+                         "Flush () does not write the batched records");
+
+  //
+  // Fill many batches, with packets of all sizes: the larger ones are
+  // truncated to the snap length.
+  //
+  uint64_t expectedLength = 24 + 2 * (16 + 10);
+  for (uint32_t i = 0; i < nPackets; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (i * 3);
+      f.Write (1, i, p);
+      expectedLength += 16 + std::min<uint32_t> (i * 3, 100);
+    }
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Write () returns error");
+  f.Close ();
+  NS_TEST_ASSERT_MSG_EQ (CheckFileLength (m_testFilename, expectedLength), true,
+                         "Close () does not write the batched records");
+
+  //
+  // Read the records back.
+  //
+  f.Open (m_testFilename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << m_testFilename << ", \"std::ios::in\") returns error");
+  uint8_t buffer[100];
+  uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+  for (uint32_t i = 1; i <= 2; ++i)
+    {
+      f.Read (buffer, sizeof (buffer), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read () returns error");
+      NS_TEST_ASSERT_MSG_EQ (tsUsec, i, "Records out of order");
+      NS_TEST_ASSERT_MSG_EQ (readLen, sizeof (data), "Wrong record length");
+      NS_TEST_ASSERT_MSG_EQ (std::memcmp (buffer, data, sizeof (data)), 0, "Wrong record data");
+    }
+  for (uint32_t i = 0; i < nPackets; ++i)
+    {
+      f.Read (buffer, sizeof (buffer), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read () returns error");
+      NS_TEST_ASSERT_MSG_EQ (tsSec, 1, "Wrong timestamp");
+      NS_TEST_ASSERT_MSG_EQ (tsUsec, i, "Records out of order");
+      NS_TEST_ASSERT_MSG_EQ (origLen, i * 3, "Wrong original length");
+      NS_TEST_ASSERT_MSG_EQ (inclLen, std::min<uint32_t> (i * 3, 100), "Wrong included length");
+    }
+  f.Read (buffer, 1, tsSec, tsUsec, inclLen, origLen, readLen);
+  NS_TEST_ASSERT_MSG_EQ (f.Eof (), true, "Too many records in the file");
+  f.Close ();
+}
+
 class PcapFileTestSuite : public TestSuite
 {
 public:
@@ -1137,6 +1254,8 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new BatchTestCase (false), TestCase::QUICK);
+  AddTestCase (new BatchTestCase (true), TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite;
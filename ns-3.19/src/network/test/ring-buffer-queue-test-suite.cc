@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ring-buffer-queue.h"
+#include "ns3/drop-tail-queue.h"
+#include "ns3/uinteger.h"
+#include "ns3/enum.h"
+
+using namespace ns3;
+
+class RingBufferQueueTestCase : public TestCase
+{
+public:
+  RingBufferQueueTestCase ();
+  virtual void DoRun (void);
+private:
+  void Dequeued (Ptr<const Packet> p);
+  uint32_t m_dequeued;
+};
+
+RingBufferQueueTestCase::RingBufferQueueTestCase ()
+  : TestCase ("Sanity check on the ring buffer queue implementation"),
+    m_dequeued (0)
+{
+}
+
+void
+RingBufferQueueTestCase::Dequeued (Ptr<const Packet> p)
+{
+  m_dequeued++;
+}
+void
+RingBufferQueueTestCase::DoRun (void)
+{
+  Ptr<RingBufferQueue> queue = CreateObject<RingBufferQueue> ();
+  NS_TEST_EXPECT_MSG_EQ (queue->SetAttributeFailSafe ("MaxPackets", UintegerValue (40)), true,
+                         "Verify that we can actually set the attribute");
+
+  //
+  // Wrap around the ring several times while it grows up to its limit.
+  //
+  std::vector<Ptr<Packet> > packets;
+  uint32_t next = 0;
+  for (uint32_t round = 0; round < 5; ++round)
+    {
+      for (uint32_t i = 0; i < 30; ++i)
+        {
+          Ptr<Packet> p = Create<Packet> (i);
+          packets.push_back (p);
+          queue->Enqueue (p);
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 30, "Wrong number of packets");
+      for (uint32_t i = 0; i < 20; ++i)
+        {
+          Ptr<Packet> p = queue->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ ((p != 0), true, "The queue should not be empty");
+          NS_TEST_EXPECT_MSG_EQ (p->GetUid (), packets[next++]->GetUid (), "Packets out of order");
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetUid (), packets[next]->GetUid (), "Wrong packet at the front");
+      for (uint32_t i = 0; i < 10; ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (queue->Dequeue ()->GetUid (), packets[next++]->GetUid (), "Packets out of order");
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+      NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "There should be no bytes left");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), 32, "The ring should not grow past the backlog");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetPeakPackets (), 30, "Wrong peak number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetPeakBytes (), 435, "Wrong peak number of bytes");
+
+  //
+  // Dequeue in batches, across the end of the ring.
+  //
+  queue->TraceConnectWithoutContext ("Dequeue", MakeCallback (&RingBufferQueueTestCase::Dequeued, this));
+  for (uint32_t i = 0; i < 30; ++i)
+    {
+      Ptr<Packet> p = Create<Packet> (i);
+      packets.push_back (p);
+      queue->Enqueue (p);
+    }
+  std::vector<Ptr<Packet> > batch;
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (batch, 4), 4, "Wrong batch size");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (batch, 10), 10, "Wrong batch size");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 16, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->Peek ()->GetUid (), packets[next + 14]->GetUid (), "Wrong packet at the front");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (batch, 100), 16, "Wrong batch size");
+  NS_TEST_EXPECT_MSG_EQ (queue->DequeueBatch (batch, 100), 0, "The queue should be empty");
+  NS_TEST_ASSERT_MSG_EQ (batch.size (), 30, "Wrong number of packets dequeued");
+  for (uint32_t i = 0; i < batch.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (batch[i]->GetUid (), packets[next++]->GetUid (), "Packets out of order");
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "There should be no bytes left");
+  NS_TEST_EXPECT_MSG_EQ (m_dequeued, 30, "Each packet of a batch should be traced");
+  queue->ResetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (queue->GetPeakPackets (), 0, "The peak should be reset to the backlog");
+
+  //
+  // The packets beyond MaxPackets are dropped, and the ring stops at MaxPackets.
+  //
+  for (uint32_t i = 0; i < 50; ++i)
+    {
+      queue->Enqueue (Create<Packet> (10));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 40, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPackets (), 10, "Wrong number of dropped packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetCapacity (), 40, "The ring should stop at MaxPackets");
+  queue->DequeueAll ();
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+
+  //
+  // In bytes mode, as in a DropTailQueue, a packet which would fill
+  // the queue up to MaxBytes is dropped.
+  //
+  queue = CreateObject<RingBufferQueue> ();
+  queue->SetAttribute ("Mode", EnumValue (Queue::QUEUE_MODE_BYTES));
+  queue->SetAttribute ("MaxBytes", UintegerValue (1000));
+  for (uint32_t i = 0; i < 11; ++i)
+    {
+      queue->Enqueue (Create<Packet> (100));
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 9, "Wrong number of packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 900, "Wrong number of bytes");
+
+  //
+  // The other queues dequeue a batch one packet at a time.
+  //
+  Ptr<DropTailQueue> dropTail = CreateObject<DropTailQueue> ();
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      dropTail->Enqueue (Create<Packet> (100));
+    }
+  batch.clear ();
+  NS_TEST_EXPECT_MSG_EQ (dropTail->DequeueBatch (batch, 3), 3, "Wrong batch size");
+  NS_TEST_EXPECT_MSG_EQ (dropTail->DequeueBatch (batch, 3), 2, "Wrong batch size");
+  NS_TEST_EXPECT_MSG_EQ (batch.size (), 5, "Wrong number of packets dequeued");
+  NS_TEST_EXPECT_MSG_EQ (dropTail->IsEmpty (), true, "The queue should be empty");
+  NS_TEST_EXPECT_MSG_EQ (dropTail->GetNBytes (), 0, "There should be no bytes left");
+  NS_TEST_EXPECT_MSG_EQ (dropTail->GetPeakBytes (), 500, "Wrong peak number of bytes");
+}
+
+static class RingBufferQueueTestSuite : public TestSuite
+{
+public:
+  RingBufferQueueTestSuite ()
+    : TestSuite ("ring-buffer-queue", UNIT)
+  {
+    AddTestCase (new RingBufferQueueTestCase (), TestCase::QUICK);
+  }
+} g_ringBufferQueueTestSuite;
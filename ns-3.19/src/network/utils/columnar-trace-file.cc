@@ -0,0 +1,345 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstddef>
+#include <cstring>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/fatal-impl.h"
+#include "columnar-trace-file.h"
+
+NS_LOG_COMPONENT_DEFINE ("ColumnarTraceFile");
+
+namespace ns3 {
+
+namespace {
+
+const uint32_t MAGIC = 0x4e334354;   /**< Magic number identifying a columnar trace file */
+const uint16_t VERSION = 1;          /**< Version of the file format */
+
+} // anonymous namespace
+
+#define COLUMN(field) \
+  { # field, sizeof (((ColumnarTraceFile::Record *)0)->field), offsetof (ColumnarTraceFile::Record, field) }
+
+const ColumnarTraceFile::Column *
+ColumnarTraceFile::GetColumns (uint32_t &n)
+{
+  static const Column columns[] = {
+    COLUMN (time),
+    COLUMN (node),
+    COLUMN (device),
+    COLUMN (event),
+    COLUMN (size),
+    COLUMN (uid),
+    COLUMN (protocol),
+    COLUMN (source),
+    COLUMN (destination),
+    COLUMN (sourcePort),
+    COLUMN (destinationPort),
+    COLUMN (hopLimit),
+    COLUMN (tcpFlags),
+    COLUMN (tcpSequence),
+    COLUMN (tcpAck)
+  };
+  n = sizeof (columns) / sizeof (columns[0]);
+  return columns;
+}
+
+#undef COLUMN
+
+ColumnarTraceFile::ColumnarTraceFile ()
+  : m_writing (false),
+    m_blockSize (BLOCK_SIZE_DEFAULT),
+    m_rows (0),
+    m_next (0),
+    m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_file);
+}
+
+ColumnarTraceFile::~ColumnarTraceFile ()
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_file);
+  Close ();
+}
+
+void
+ColumnarTraceFile::SetBlockSize (uint32_t rows)
+{
+  NS_LOG_FUNCTION (this << rows);
+  NS_ASSERT (rows > 0);
+  m_blockSize = rows;
+}
+
+uint32_t
+ColumnarTraceFile::GetBlockSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_blockSize;
+}
+
+void
+ColumnarTraceFile::Open (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+  NS_ASSERT (!m_file.is_open ());
+  m_writing = (mode & std::ios::out) != 0;
+  NS_ASSERT_MSG (!m_writing || (mode & std::ios::in) == 0,
+                 "ColumnarTraceFile::Open (): a file cannot be both read and written");
+  m_rows = 0;
+  m_next = 0;
+  m_nRecords = 0;
+  m_columns.clear ();
+  m_fileColumns.clear ();
+  m_file.clear ();
+  m_file.open (filename.c_str (), mode | std::ios::binary);
+  if (m_file.fail ())
+    {
+      return;
+    }
+  if (m_writing)
+    {
+      WriteHeader ();
+    }
+  else
+    {
+      ReadHeader ();
+    }
+}
+
+void
+ColumnarTraceFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  if (m_writing)
+    {
+      WriteBlock ();
+    }
+  m_file.close ();
+}
+
+void
+ColumnarTraceFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writing)
+    {
+      WriteBlock ();
+      m_file.flush ();
+    }
+}
+
+bool
+ColumnarTraceFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.fail ();
+}
+
+bool
+ColumnarTraceFile::Eof (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.eof ();
+}
+
+uint64_t
+ColumnarTraceFile::GetNRecords (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nRecords;
+}
+
+void
+ColumnarTraceFile::WriteHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t n;
+  const Column *columns = GetColumns (n);
+  uint16_t nColumns = n;
+  m_file.write ((const char *)&MAGIC, sizeof (MAGIC));
+  m_file.write ((const char *)&VERSION, sizeof (VERSION));
+  m_file.write ((const char *)&nColumns, sizeof (nColumns));
+  m_columns.resize (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint8_t length = std::strlen (columns[i].name);
+      m_file.write ((const char *)&columns[i].width, 1);
+      m_file.write ((const char *)&length, 1);
+      m_file.write (columns[i].name, length);
+      m_columns[i].resize (m_blockSize * columns[i].width);
+    }
+}
+
+void
+ColumnarTraceFile::ReadHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t magic = 0;
+  uint16_t version = 0;
+  uint16_t nColumns = 0;
+  m_file.read ((char *)&magic, sizeof (magic));
+  m_file.read ((char *)&version, sizeof (version));
+  m_file.read ((char *)&nColumns, sizeof (nColumns));
+  if (m_file.fail () || magic != MAGIC || version != VERSION)
+    {
+      NS_LOG_WARN ("Not a columnar trace file, or of another byte order or version");
+      m_file.setstate (std::ios::failbit);
+      return;
+    }
+  uint32_t n;
+  const Column *columns = GetColumns (n);
+  for (uint16_t i = 0; i < nColumns; ++i)
+    {
+      uint8_t width = 0;
+      uint8_t length = 0;
+      char name[256];
+      m_file.read ((char *)&width, 1);
+      m_file.read ((char *)&length, 1);
+      m_file.read (name, length);
+      if (m_file.fail ())
+        {
+          return;
+        }
+      struct FileColumn column;
+      column.width = width;
+      column.column = -1;
+      for (uint32_t j = 0; j < n; ++j)
+        {
+          if (width == columns[j].width
+              && length == std::strlen (columns[j].name)
+              && std::memcmp (name, columns[j].name, length) == 0)
+            {
+              column.column = j;
+              break;
+            }
+        }
+      NS_LOG_LOGIC ("column " << std::string (name, length) << " width " << (uint32_t)width
+                              << (column.column < 0 ? " ignored" : ""));
+      m_fileColumns.push_back (column);
+    }
+  m_columns.resize (nColumns);
+}
+
+void
+ColumnarTraceFile::WriteBlock (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_rows == 0)
+    {
+      return;
+    }
+  uint32_t n;
+  const Column *columns = GetColumns (n);
+  m_file.write ((const char *)&m_rows, sizeof (m_rows));
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_file.write ((const char *)&m_columns[i][0], m_rows * columns[i].width);
+    }
+  NS_LOG_LOGIC ("wrote a block of " << m_rows << " records");
+  m_rows = 0;
+}
+
+bool
+ColumnarTraceFile::ReadBlock (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t rows = 0;
+  m_file.read ((char *)&rows, sizeof (rows));
+  if (m_file.fail ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < m_fileColumns.size (); ++i)
+    {
+      uint32_t bytes = rows * m_fileColumns[i].width;
+      if (m_fileColumns[i].column < 0)
+        {
+          m_file.seekg (bytes, std::ios::cur);
+          continue;
+        }
+      m_columns[i].resize (bytes);
+      m_file.read ((char *)&m_columns[i][0], bytes);
+    }
+  if (m_file.fail ())
+    {
+      return false;
+    }
+  m_rows = rows;
+  m_next = 0;
+  return true;
+}
+
+void
+ColumnarTraceFile::Write (const Record &record)
+{
+  NS_LOG_FUNCTION (this << record.uid);
+  NS_ASSERT_MSG (m_writing && !m_columns.empty (), "ColumnarTraceFile::Write (): file not open for writing");
+  uint32_t n;
+  const Column *columns = GetColumns (n);
+  const uint8_t *fields = reinterpret_cast<const uint8_t *> (&record);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      std::memcpy (&m_columns[i][m_rows * columns[i].width],
+                   fields + columns[i].offset, columns[i].width);
+    }
+  m_rows++;
+  m_nRecords++;
+  if (m_rows == m_blockSize)
+    {
+      WriteBlock ();
+    }
+}
+
+bool
+ColumnarTraceFile::Read (Record &record)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_writing);
+  while (m_next == m_rows)
+    {
+      if (m_file.fail () || !ReadBlock ())
+        {
+          return false;
+        }
+    }
+  uint32_t n;
+  const Column *columns = GetColumns (n);
+  std::memset (&record, 0, sizeof (record));
+  uint8_t *fields = reinterpret_cast<uint8_t *> (&record);
+  for (uint32_t i = 0; i < m_fileColumns.size (); ++i)
+    {
+      int32_t column = m_fileColumns[i].column;
+      if (column >= 0)
+        {
+          std::memcpy (fields + columns[column].offset,
+                       &m_columns[i][m_next * columns[column].width],
+                       columns[column].width);
+        }
+    }
+  m_next++;
+  m_nRecords++;
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef COLUMNAR_TRACE_FILE_H
+#define COLUMNAR_TRACE_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \brief A binary file of packet events stored by columns
+ *
+ * Each record of the file describes one packet event: when and where
+ * it happened, the size and uid of the packet, and the addresses,
+ * ports and a few header fields of its IP and transport headers.
+ *
+ * The records are written in blocks.  A block holds up to
+ * GetBlockSize records, stored column by column: all the timestamps,
+ * then all the node ids, and so on.  Every column has a fixed width,
+ * so that a reader can load or skip a whole column of a block at
+ * once.  A block is written when it is full, on Flush and on Close.
+ *
+ * The file starts with a header which lists the name and the width of
+ * the columns, followed by the blocks:
+ *
+ * \verbatim
+   header: magic (4) version (2) number of columns (2)
+           for each column: width (1) name length (1) name
+   block:  number of records n (4)
+           for each column: n values of the column width
+   \endverbatim
+ *
+ * The integers are stored in the byte order of the writer, which the
+ * reader detects with the magic number; a file from a writer of the
+ * other byte order cannot be read.  The addresses are stored in
+ * network byte order, IPv4 addresses as IPv4-mapped IPv6 addresses.
+ */
+class ColumnarTraceFile : public SimpleRefCount<ColumnarTraceFile>
+{
+public:
+  /// The default number of records of a block.
+  static const uint32_t BLOCK_SIZE_DEFAULT = 4096;
+
+  /// The kinds of packet events.
+  enum EventType {
+    ENQUEUE = 0,   /**< Enqueued in the transmit queue of a device */
+    DEQUEUE = 1,   /**< Dequeued from the transmit queue of a device */
+    DROP = 2,      /**< Dropped by a device or its queue */
+    TX = 3,        /**< Sent by a device without a transmit queue */
+    RX = 4         /**< Received by a device */
+  };
+
+  /**
+   * One packet event.  The fields which do not apply to the packet,
+   * such as the ports of an ICMP packet, are zero.
+   */
+  struct Record
+  {
+    int64_t time;               /**< Simulation time of the event, in nanoseconds */
+    uint64_t uid;               /**< Uid of the packet */
+    uint32_t node;              /**< Id of the node */
+    uint32_t device;            /**< Index of the device in its node */
+    uint32_t size;              /**< Size of the packet, in bytes */
+    uint32_t tcpSequence;       /**< Sequence number of the TCP header */
+    uint32_t tcpAck;            /**< Acknowledgment number of the TCP header */
+    uint16_t sourcePort;        /**< Source port of the TCP or UDP header */
+    uint16_t destinationPort;   /**< Destination port of the TCP or UDP header */
+    uint8_t source[16];         /**< Source address of the IP header */
+    uint8_t destination[16];    /**< Destination address of the IP header */
+    uint8_t event;              /**< The EventType */
+    uint8_t protocol;           /**< Transport protocol number, zero if not IP */
+    uint8_t hopLimit;           /**< TTL or hop limit of the IP header */
+    uint8_t tcpFlags;           /**< Flags of the TCP header */
+  };
+
+  ColumnarTraceFile ();
+  ~ColumnarTraceFile ();
+
+  /**
+   * \param rows the number of records of a block.  It must be set
+   *        before Open to take effect.
+   */
+  void SetBlockSize (uint32_t rows);
+  /**
+   * \returns the number of records of a block.
+   */
+  uint32_t GetBlockSize (void) const;
+
+  /**
+   * Open a file to write or to read records.
+   *
+   * \param filename the name of the file
+   * \param mode std::ios::out to write a new file, std::ios::in to
+   *        read an existing file
+   */
+  void Open (std::string const &filename, std::ios::openmode mode);
+  /**
+   * Write the current block and close the file.
+   */
+  void Close (void);
+  /**
+   * Write the current block, even if it is not full, and flush the file.
+   */
+  void Flush (void);
+
+  /**
+   * \returns true if the file could not be opened, written or read.
+   */
+  bool Fail (void) const;
+  /**
+   * \returns true if Read reached the end of the file.
+   */
+  bool Eof (void) const;
+
+  /**
+   * \param record the record to append to the file
+   */
+  void Write (const Record &record);
+  /**
+   * \param record [out] the next record of the file
+   * \returns false at the end of the file or on error.
+   */
+  bool Read (Record &record);
+
+  /**
+   * \returns the number of records written to or read from the file.
+   */
+  uint64_t GetNRecords (void) const;
+
+private:
+  /// A column of the file, a field of Record.
+  struct Column
+  {
+    const char *name;
+    uint8_t width;
+    uint32_t offset;   //!< Offset of the field in Record
+  };
+  /// A column of a file being read.
+  struct FileColumn
+  {
+    uint8_t width;
+    int32_t column;    //!< Index in the known columns, -1 if unknown
+  };
+
+  /**
+   * \param n [out] the number of known columns
+   * \returns the columns this class writes, in file order.
+   */
+  static const Column *GetColumns (uint32_t &n);
+
+  void WriteHeader (void);
+  void ReadHeader (void);
+  void WriteBlock (void);
+  bool ReadBlock (void);
+
+  std::fstream m_file;
+  bool m_writing;
+  uint32_t m_blockSize;
+  /// The data of the current block, one buffer per column.
+  std::vector<std::vector<uint8_t> > m_columns;
+  uint32_t m_rows;       //!< Number of records in the current block
+  uint32_t m_next;       //!< Next record to read in the current block
+  std::vector<struct FileColumn> m_fileColumns;
+  uint64_t m_nRecords;
+};
+
+} // namespace ns3
+
+#endif /* COLUMNAR_TRACE_FILE_H */
@@ -22,6 +22,7 @@
 #include "ns3/nstime.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <limits>
 
 NS_LOG_COMPONENT_DEFINE ("DataRate");
 
@@ -232,6 +233,19 @@ double DataRate::CalculateTxTime (uint32_t bytes) const
   return static_cast<double>(bytes)*8/m_bps;
 }
 
+Time DataRate::CalculateBytesTxTime (uint32_t bytes) const
+{
+  NS_LOG_FUNCTION (this << bytes);
+  NS_ASSERT_MSG (m_bps > 0, "DataRate::CalculateBytesTxTime(): null data rate");
+  uint64_t bits = static_cast<uint64_t> (bytes) * 8;
+  uint64_t stepsPerSecond = Time::FromInteger (1, Time::S).GetTimeStep ();
+  if (stepsPerSecond > 0 && bits <= std::numeric_limits<uint64_t>::max () / stepsPerSecond)
+    {
+      return TimeStep (bits * stepsPerSecond / m_bps);
+    }
+  return Seconds (static_cast<double> (bits) / m_bps);
+}
+
 uint64_t DataRate::GetBitRate () const
 {
   NS_LOG_FUNCTION (this);
@@ -152,6 +152,19 @@ public:
    */
   double CalculateTxTime (uint32_t bytes) const;
 
+  /**
+   * \brief Calculate transmission time
+   *
+   * Calculates the transmission time at this data rate, with integer
+   * arithmetic in the current time resolution.  The result is rounded
+   * down to a whole number of time steps, so exact times are exact:
+   * 1500 bytes at 5Mbps take 2400000 ns, where
+   * Seconds (CalculateTxTime (1500)) gives 2399999 ns.
+   * \param bytes The number of bytes (not bits) for which to calculate
+   * \return The transmission time for the number of bytes specified
+   */
+  Time CalculateBytesTxTime (uint32_t bytes) const;
+
   /**
    * Get the underlying bitrate
    * \return The underlying bitrate in bits per second
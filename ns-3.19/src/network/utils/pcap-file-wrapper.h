@@ -78,6 +78,11 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write the batched records to the underlying pcap file and flush it.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -197,6 +202,8 @@ public:
 private:
   PcapFile m_file;
   uint32_t m_snapLen;
+  uint32_t m_bufferSize;
+  bool m_async;
 };
 
 } // namespace ns3
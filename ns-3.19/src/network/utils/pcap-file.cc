@@ -20,6 +20,8 @@
 
 #include <iostream>
 #include <cstring>
+#include <vector>
+#include "ns3/core-config.h"
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -28,6 +30,11 @@
 #include "ns3/buffer.h"
 #include "pcap-file.h"
 #include "ns3/log.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif /* HAVE_PTHREAD_H */
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -46,17 +53,241 @@ const uint32_t NS_SWAPPED_MAGIC = 0xd43cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+/**
+ * The records of a file opened for writing only.  This is the stream
+ * buffer of PcapFile::m_stream: the records are copied into a batch in
+ * memory, and a full batch is given to the file buffer in a single call,
+ * by the simulation thread or by a background thread.  In the latter
+ * case, the simulation thread fills the next batch while the previous
+ * one is written, and waits only when both are full.
+ */
+class PcapFile::Batch : public std::streambuf
+{
+public:
+  Batch (std::streambuf *file, uint32_t size, bool async);
+  virtual ~Batch ();
+
+private:
+  virtual int_type overflow (int_type c);
+  virtual int sync (void);
+
+  /**
+   * Write or hand over the current batch and start a new one.
+   * \returns false if a write to the file failed.
+   */
+  bool Emit (void);
+#ifdef HAVE_PTHREAD_H
+  /**
+   * The loop of the background thread.
+   */
+  void Run (void);
+  /**
+   * Wait until the background thread has written the pending batch.
+   */
+  void WaitWritten (void);
+#endif /* HAVE_PTHREAD_H */
+
+  std::streambuf *m_file;
+  std::vector<char> m_buffer;
+  bool m_failed;
+#ifdef HAVE_PTHREAD_H
+  Ptr<SystemThread> m_thread;   //!< The background thread, if any
+  SystemMutex m_mutex;          //!< Protects the fields below
+  SystemCondition m_posted;
+  SystemCondition m_written;
+  std::vector<char> m_pending;  //!< Owned by m_thread while m_hasPending is true
+  std::streamsize m_pendingSize;
+  bool m_hasPending;
+  bool m_stop;
+#endif /* HAVE_PTHREAD_H */
+};
+
+#ifdef HAVE_PTHREAD_H
+/// How long the threads sleep before they check their condition again, in ns.
+static const uint64_t BATCH_WAIT_NS = 100000000;
+#endif /* HAVE_PTHREAD_H */
+
+PcapFile::Batch::Batch (std::streambuf *file, uint32_t size, bool async)
+  : m_file (file),
+    m_buffer (size),
+    m_failed (false)
+{
+  NS_LOG_FUNCTION (this << file << size << async);
+  NS_ASSERT (size > 0);
+  setp (&m_buffer[0], &m_buffer[0] + m_buffer.size ());
+#ifdef HAVE_PTHREAD_H
+  m_pendingSize = 0;
+  m_hasPending = false;
+  m_stop = false;
+  if (async)
+    {
+      m_pending.resize (size);
+      m_thread = Create<SystemThread> (MakeCallback (&PcapFile::Batch::Run, this));
+      m_thread->Start ();
+    }
+#else
+  if (async)
+    {
+      NS_LOG_WARN ("No threading support: the pcap records are written synchronously");
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+PcapFile::Batch::~Batch ()
+{
+  NS_LOG_FUNCTION (this);
+  sync ();
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      m_mutex.Lock ();
+      m_stop = true;
+      m_mutex.Unlock ();
+      m_posted.SetCondition (true);
+      m_posted.Signal ();
+      m_thread->Join ();
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+PcapFile::Batch::int_type
+PcapFile::Batch::overflow (int_type c)
+{
+  if (!Emit ())
+    {
+      return traits_type::eof ();
+    }
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      *pptr () = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+int
+PcapFile::Batch::sync (void)
+{
+  bool ok = Emit ();
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      WaitWritten ();
+      m_mutex.Lock ();
+      ok = ok && !m_failed;
+      m_mutex.Unlock ();
+    }
+#endif /* HAVE_PTHREAD_H */
+  // the background thread is idle now: the file buffer is ours.
+  if (m_file->pubsync () != 0)
+    {
+      ok = false;
+    }
+  return ok ? 0 : -1;
+}
+
+bool
+PcapFile::Batch::Emit (void)
+{
+  std::streamsize n = pptr () - pbase ();
+  if (n == 0)
+    {
+      return true;
+    }
+#ifdef HAVE_PTHREAD_H
+  if (m_thread != 0)
+    {
+      WaitWritten ();
+      m_mutex.Lock ();
+      m_pending.swap (m_buffer);
+      m_pendingSize = n;
+      m_hasPending = true;
+      bool ok = !m_failed;
+      m_mutex.Unlock ();
+      m_posted.SetCondition (true);
+      m_posted.Signal ();
+      setp (&m_buffer[0], &m_buffer[0] + m_buffer.size ());
+      return ok;
+    }
+#endif /* HAVE_PTHREAD_H */
+  if (m_file->sputn (pbase (), n) != n)
+    {
+      m_failed = true;
+    }
+  setp (&m_buffer[0], &m_buffer[0] + m_buffer.size ());
+  return !m_failed;
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+PcapFile::Batch::Run (void)
+{
+  // No logging here: the logging functions are not thread-safe.
+  for (;;)
+    {
+      // Reset the condition before looking at the state, so that a batch
+      // posted in between is not missed.
+      m_posted.SetCondition (false);
+      m_mutex.Lock ();
+      bool hasPending = m_hasPending;
+      bool stop = m_stop;
+      m_mutex.Unlock ();
+      if (hasPending)
+        {
+          bool ok = m_file->sputn (&m_pending[0], m_pendingSize) == m_pendingSize;
+          m_mutex.Lock ();
+          m_failed = m_failed || !ok;
+          m_hasPending = false;
+          m_mutex.Unlock ();
+          m_written.SetCondition (true);
+          m_written.Signal ();
+        }
+      else if (stop)
+        {
+          return;
+        }
+      else
+        {
+          m_posted.TimedWait (BATCH_WAIT_NS);
+        }
+    }
+}
+
+void
+PcapFile::Batch::WaitWritten (void)
+{
+  for (;;)
+    {
+      m_written.SetCondition (false);
+      m_mutex.Lock ();
+      bool hasPending = m_hasPending;
+      m_mutex.Unlock ();
+      if (!hasPending)
+        {
+          return;
+        }
+      m_written.TimedWait (BATCH_WAIT_NS);
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
 PcapFile::PcapFile ()
   : m_file (),
+    m_stream (m_file.rdbuf ()),
+    m_batch (0),
+    m_bufferSize (BUFFER_SIZE_DEFAULT),
+    m_async (false),
     m_swapMode (false)
 {
   NS_LOG_FUNCTION (this);
+  FatalImpl::RegisterStream (&m_stream);
   FatalImpl::RegisterStream (&m_file);
 }
 
 PcapFile::~PcapFile ()
 {
   NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_stream);
   FatalImpl::UnregisterStream (&m_file);
   Close ();
 }
@@ -66,7 +297,7 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_file.fail ();
+  return m_file.fail () || m_stream.fail ();
 }
 bool 
 PcapFile::Eof (void) const
@@ -79,6 +310,7 @@ PcapFile::Clear (void)
 {
   NS_LOG_FUNCTION (this);
   m_file.clear ();
+  m_stream.clear ();
 }
 
 
@@ -86,9 +318,41 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  m_stream.flush ();
+  m_stream.rdbuf (m_file.rdbuf ());
+  delete m_batch;
+  m_batch = 0;
   m_file.close ();
 }
 
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stream.flush ();
+}
+
+void
+PcapFile::SetBufferSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_bufferSize = size;
+}
+
+uint32_t
+PcapFile::GetBufferSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_bufferSize;
+}
+
+void
+PcapFile::SetAsynchronous (bool async)
+{
+  NS_LOG_FUNCTION (this << async);
+  m_async = async;
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -195,8 +459,9 @@ PcapFile::WriteFileHeader (void)
   NS_LOG_FUNCTION (this);
   //
   // If we're initializing the file, we need to write the pcap file header
-  // at the start of the file.
+  // at the start of the file, after the records already batched.
   //
+  m_stream.flush ();
   m_file.seekp (0, std::ios::beg);
  
   //
@@ -323,6 +588,12 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
       // will set the fail bit if file header is invalid.
       ReadAndVerifyFileHeader ();
     }
+  else if (m_bufferSize != 0 && !m_file.fail ())
+    {
+      NS_ASSERT (m_batch == 0);
+      m_batch = new Batch (m_file.rdbuf (), m_bufferSize, m_async);
+      m_stream.rdbuf (m_batch);
+    }
 }
 
 void
@@ -390,13 +661,15 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
     }
 
   //
-  // Watch out for memory alignment differences between machines, so write
-  // them all individually.
+  // Watch out for memory alignment differences between machines, so copy
+  // them all individually, then write the record header at once.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
+  char buffer[16];
+  std::memcpy (buffer, &header.m_tsSec, 4);
+  std::memcpy (buffer + 4, &header.m_tsUsec, 4);
+  std::memcpy (buffer + 8, &header.m_inclLen, 4);
+  std::memcpy (buffer + 12, &header.m_origLen, 4);
+  m_stream.write (buffer, sizeof (buffer));
   return inclLen;
 }
 
@@ -405,7 +678,7 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
+  m_stream.write ((const char *)data, inclLen);
 }
 
 void 
@@ -413,7 +686,7 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (&m_stream, inclLen);
 }
 
 void 
@@ -428,9 +701,9 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Header &header, Ptr<const Pack
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
+  headerBuffer.CopyData (&m_stream, toCopy);
   inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (&m_stream, inclLen);
 }
 
 void
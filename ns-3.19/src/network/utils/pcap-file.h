@@ -23,6 +23,7 @@
 
 #include <string>
 #include <fstream>
+#include <ostream>
 #include <stdint.h>
 #include "ns3/ptr.h"
 
@@ -38,12 +39,19 @@ class Header;
  * A class representing a pcap file.  This allows easy creation, writing and 
  * reading of files composed of stored packets; which may be viewed using
  * standard tools.
+ *
+ * A file opened for writing only collects the records in an in-memory
+ * batch of GetBufferSize bytes and writes the whole batch to the file
+ * at once when it is full, on Flush and on Close.  When the file is
+ * asynchronous, a full batch is written by a background thread while
+ * the next batch fills up.
  */
 class PcapFile
 {
 public:
   static const int32_t  ZONE_DEFAULT    = 0;           /**< Time zone offset for current location */
   static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+  static const uint32_t BUFFER_SIZE_DEFAULT = 65536;   /**< Default size of the batches of records written to the file */
 
 public:
   PcapFile ();
@@ -85,6 +93,35 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write the records of the current batch to the file and flush it.
+   * When the file is asynchronous, wait until the background thread
+   * has written all the batches.
+   */
+  void Flush (void);
+
+  /**
+   * \param size the size in bytes of the batches of records written to
+   *        the file, zero to write each record to the file stream as it
+   *        comes.
+   *
+   * This method must be called before Open to take effect.
+   */
+  void SetBufferSize (uint32_t size);
+  /**
+   * \return the size in bytes of the batches of records.
+   */
+  uint32_t GetBufferSize (void) const;
+  /**
+   * \param async true to write the full batches from a background
+   *        thread.
+   *
+   * This method must be called before Open to take effect.  It has no
+   * effect when the file is not batched, or when the threading
+   * primitives are not available.
+   */
+  void SetAsynchronous (bool async);
+
   /**
    * Initialize the pcap file associated with this object.  This file must have
    * been previously opened with write permissions.
@@ -284,12 +321,18 @@ private:
   void Swap (PcapFileHeader *from, PcapFileHeader *to);
   void Swap (PcapRecordHeader *from, PcapRecordHeader *to);
 
+  class Batch;
+
   void WriteFileHeader (void);
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
   void ReadAndVerifyFileHeader (void);
 
   std::string    m_filename;
   std::fstream   m_file;
+  std::ostream   m_stream;       //!< Writes the records, through m_batch or straight to m_file
+  Batch         *m_batch;        //!< The batch of records not yet written to m_file
+  uint32_t       m_bufferSize;
+  bool           m_async;
   PcapFileHeader m_fileHeader;
   bool m_swapMode;
 };
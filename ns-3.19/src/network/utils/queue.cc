@@ -19,6 +19,7 @@
 #include "ns3/log.h"
 #include "ns3/trace-source-accessor.h"
 #include "queue.h"
+#include <algorithm>
 
 NS_LOG_COMPONENT_DEFINE ("Queue");
 
@@ -48,7 +49,9 @@ Queue::Queue() :
   m_nPackets (0),
   m_nTotalReceivedPackets (0),
   m_nTotalDroppedBytes (0),
-  m_nTotalDroppedPackets (0)
+  m_nTotalDroppedPackets (0),
+  m_nPeakPackets (0),
+  m_nPeakBytes (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -79,6 +82,9 @@ Queue::Enqueue (Ptr<Packet> p)
 
       m_nPackets++;
       m_nTotalReceivedPackets++;
+
+      m_nPeakPackets = std::max (m_nPeakPackets, m_nPackets);
+      m_nPeakBytes = std::max (m_nPeakBytes, m_nBytes);
     }
   return retval;
 }
@@ -104,6 +110,47 @@ Queue::Dequeue (void)
   return packet;
 }
 
+uint32_t
+Queue::DequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+
+  uint32_t first = packets.size ();
+  uint32_t count = DoDequeueBatch (packets, std::min (n, m_nPackets));
+  NS_ASSERT (packets.size () == first + count);
+
+  for (uint32_t i = first; i < packets.size (); ++i)
+    {
+      NS_ASSERT (m_nBytes >= packets[i]->GetSize ());
+      NS_ASSERT (m_nPackets > 0);
+
+      m_nBytes -= packets[i]->GetSize ();
+      m_nPackets--;
+
+      m_traceDequeue (packets[i]);
+    }
+  NS_LOG_LOGIC ("dequeued " << count << " packets");
+  return count;
+}
+
+uint32_t
+Queue::DoDequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  uint32_t count = 0;
+  while (count < n)
+    {
+      Ptr<Packet> packet = DoDequeue ();
+      if (packet == 0)
+        {
+          break;
+        }
+      packets.push_back (packet);
+      count++;
+    }
+  return count;
+}
+
 void
 Queue::DequeueAll (void)
 {
@@ -178,6 +225,22 @@ Queue::GetTotalDroppedPackets (void) const
   return m_nTotalDroppedPackets;
 }
 
+uint32_t
+Queue::GetPeakPackets (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC ("returns " << m_nPeakPackets);
+  return m_nPeakPackets;
+}
+
+uint32_t
+Queue::GetPeakBytes (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC ("returns " << m_nPeakBytes);
+  return m_nPeakBytes;
+}
+
 void 
 Queue::ResetStatistics (void)
 {
@@ -186,6 +249,8 @@ Queue::ResetStatistics (void)
   m_nTotalReceivedPackets = 0;
   m_nTotalDroppedBytes = 0;
   m_nTotalDroppedPackets = 0;
+  m_nPeakPackets = m_nPackets;
+  m_nPeakBytes = m_nBytes;
 }
 
 void
@@ -26,6 +26,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 #include "ns3/packet.h"
 #include "ns3/object.h"
 #include "ns3/traced-callback.h"
@@ -65,6 +66,13 @@ public:
    * \return 0 if the operation was not successful; the packet otherwise.
    */
   Ptr<Packet> Dequeue (void);
+  /**
+   * Remove up to n packets from the front of the Queue
+   * \param packets the vector to which the packets are appended, in order
+   * \param n the maximum number of packets to remove
+   * \return the number of packets removed
+   */
+  uint32_t DequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t n);
   /**
    * Get a copy of the item at the front of the queue without removing it
    * \return 0 if the operation was not successful; the packet otherwise.
@@ -109,9 +117,21 @@ public:
    * whichever happened more recently
    */
   uint32_t GetTotalDroppedPackets (void) const;
+  /**
+   * \return The largest number of packets stored in this Queue since the
+   * simulation began, or since ResetStatistics was called, according to
+   * whichever happened more recently
+   */
+  uint32_t GetPeakPackets (void) const;
+  /**
+   * \return The largest number of bytes occupied by the packets in this
+   * Queue since the simulation began, or since ResetStatistics was called,
+   * according to whichever happened more recently
+   */
+  uint32_t GetPeakBytes (void) const;
   /**
    * Resets the counts for dropped packets, dropped bytes, received packets, and
-   * received bytes.
+   * received bytes, and the peaks to the current occupancy.
    */
   void ResetStatistics (void);
 
@@ -154,6 +174,14 @@ private:
   virtual bool DoEnqueue (Ptr<Packet> p) = 0;
   virtual Ptr<Packet> DoDequeue (void) = 0;
   virtual Ptr<const Packet> DoPeek (void) const = 0;
+  /**
+   * Remove up to n packets from the front of the queue.  The default
+   * implementation calls DoDequeue for each packet.
+   * \param packets the vector to which the packets are appended, in order
+   * \param n the maximum number of packets to remove
+   * \return the number of packets removed
+   */
+  virtual uint32_t DoDequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t n);
 
 protected:
   /**
@@ -174,6 +202,8 @@ private:
   uint32_t m_nTotalReceivedPackets;
   uint32_t m_nTotalDroppedBytes;
   uint32_t m_nTotalDroppedPackets;
+  uint32_t m_nPeakPackets;
+  uint32_t m_nPeakBytes;
 };
 
 } // namespace ns3
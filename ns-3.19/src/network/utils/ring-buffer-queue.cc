@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ring-buffer-queue.h"
+
+NS_LOG_COMPONENT_DEFINE ("RingBufferQueue");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (RingBufferQueue)
+  ;
+
+TypeId RingBufferQueue::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::RingBufferQueue")
+    .SetParent<Queue> ()
+    .AddConstructor<RingBufferQueue> ()
+    .AddAttribute ("Mode",
+                   "Whether to use bytes (see MaxBytes) or packets (see MaxPackets) as the maximum queue size metric.",
+                   EnumValue (QUEUE_MODE_PACKETS),
+                   MakeEnumAccessor (&RingBufferQueue::SetMode),
+                   MakeEnumChecker (QUEUE_MODE_BYTES, "QUEUE_MODE_BYTES",
+                                    QUEUE_MODE_PACKETS, "QUEUE_MODE_PACKETS"))
+    .AddAttribute ("MaxPackets",
+                   "The maximum number of packets accepted by this RingBufferQueue.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&RingBufferQueue::m_maxPackets),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxBytes",
+                   "The maximum number of bytes accepted by this RingBufferQueue.",
+                   UintegerValue (100 * 65535),
+                   MakeUintegerAccessor (&RingBufferQueue::m_maxBytes),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+
+  return tid;
+}
+
+RingBufferQueue::RingBufferQueue () :
+  Queue (),
+  m_ring (),
+  m_head (0),
+  m_count (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+RingBufferQueue::~RingBufferQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+RingBufferQueue::SetMode (RingBufferQueue::QueueMode mode)
+{
+  NS_LOG_FUNCTION (this << mode);
+  m_mode = mode;
+}
+
+RingBufferQueue::QueueMode
+RingBufferQueue::GetMode (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_mode;
+}
+
+uint32_t
+RingBufferQueue::GetCapacity (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_ring.size ();
+}
+
+void
+RingBufferQueue::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t size = std::max<uint32_t> (16, 2 * m_ring.size ());
+  if (m_mode == QUEUE_MODE_PACKETS)
+    {
+      size = std::min (size, m_maxPackets);
+    }
+  NS_ASSERT (size > m_count);
+  std::vector<Ptr<Packet> > ring (size);
+  for (uint32_t i = 0; i < m_count; ++i)
+    {
+      ring[i] = m_ring[(m_head + i) % m_ring.size ()];
+    }
+  m_ring.swap (ring);
+  m_head = 0;
+  NS_LOG_LOGIC ("Capacity " << m_ring.size ());
+}
+
+bool
+RingBufferQueue::DoEnqueue (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  if (m_mode == QUEUE_MODE_PACKETS && m_count >= m_maxPackets)
+    {
+      NS_LOG_LOGIC ("Queue full (at max packets) -- droppping pkt");
+      Drop (p);
+      return false;
+    }
+
+  if (m_mode == QUEUE_MODE_BYTES && GetNBytes () + p->GetSize () >= m_maxBytes)
+    {
+      NS_LOG_LOGIC ("Queue full (packet would exceed max bytes) -- droppping pkt");
+      Drop (p);
+      return false;
+    }
+
+  if (m_count == m_ring.size ())
+    {
+      Grow ();
+    }
+  uint32_t tail = m_head + m_count;
+  if (tail >= m_ring.size ())
+    {
+      tail -= m_ring.size ();
+    }
+  m_ring[tail] = p;
+  m_count++;
+
+  NS_LOG_LOGIC ("Number packets " << m_count);
+
+  return true;
+}
+
+Ptr<Packet>
+RingBufferQueue::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_count == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<Packet> p = m_ring[m_head];
+  m_ring[m_head] = 0;
+  m_head++;
+  if (m_head == m_ring.size ())
+    {
+      m_head = 0;
+    }
+  m_count--;
+
+  NS_LOG_LOGIC ("Popped " << p);
+  NS_LOG_LOGIC ("Number packets " << m_count);
+
+  return p;
+}
+
+uint32_t
+RingBufferQueue::DoDequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+
+  uint32_t count = std::min (n, m_count);
+  packets.reserve (packets.size () + count);
+  // The packets sit in at most two runs: from m_head to the end of the
+  // array, then from its start.
+  uint32_t first = std::min<uint32_t> (count, m_ring.size () - m_head);
+  for (uint32_t i = m_head; i < m_head + first; ++i)
+    {
+      packets.push_back (m_ring[i]);
+      m_ring[i] = 0;
+    }
+  for (uint32_t i = 0; i < count - first; ++i)
+    {
+      packets.push_back (m_ring[i]);
+      m_ring[i] = 0;
+    }
+  m_head = count - first > 0 ? count - first : m_head + first;
+  if (m_head == m_ring.size ())
+    {
+      m_head = 0;
+    }
+  m_count -= count;
+
+  NS_LOG_LOGIC ("Popped " << count << " packets");
+  NS_LOG_LOGIC ("Number packets " << m_count);
+
+  return count;
+}
+
+Ptr<const Packet>
+RingBufferQueue::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_count == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  return m_ring[m_head];
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_QUEUE_H
+#define RING_BUFFER_QUEUE_H
+
+#include <vector>
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue stored in a ring buffer, which drops
+ * tail-end packets on overflow
+ *
+ * This queue behaves like a DropTailQueue, including in bytes mode
+ * where a packet which would fill the queue up to MaxBytes is dropped,
+ * but keeps its packets in a
+ * single array used as a circular buffer instead of a std::deque:
+ * once the array has grown to the largest backlog seen, enqueueing
+ * and dequeueing packets do not allocate memory, however deep the
+ * queue is.  The array doubles when it is full, up to MaxPackets in
+ * QUEUE_MODE_PACKETS, and never shrinks.  In QUEUE_MODE_BYTES the
+ * array is not bounded by MaxBytes: it holds the largest number of
+ * packets ever queued at once, which is MaxBytes - 1 packets of one
+ * byte at worst.  DequeueBatch copies the packets straight out of the
+ * array.  Use it as the transmit queue of a device with,
+ * for example:
+ *
+ * \code
+ * PointToPointHelper p2p;
+ * p2p.SetQueue ("ns3::RingBufferQueue", "MaxPackets", UintegerValue (10000));
+ * \endcode
+ */
+class RingBufferQueue : public Queue {
+public:
+  static TypeId GetTypeId (void);
+  /**
+   * \brief RingBufferQueue Constructor
+   *
+   * Creates a ring buffer queue with a maximum size of 100 packets by default
+   */
+  RingBufferQueue ();
+
+  virtual ~RingBufferQueue ();
+
+  /**
+   * Set the operating mode of this queue.
+   *
+   * \param mode The operating mode of this queue.
+   */
+  void SetMode (RingBufferQueue::QueueMode mode);
+
+  /**
+   * Get the operating mode of this queue.
+   *
+   * \returns The operating mode of this queue.
+   */
+  RingBufferQueue::QueueMode GetMode (void);
+
+  /**
+   * \returns the number of packets the queue can hold without growing.
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  virtual bool DoEnqueue (Ptr<Packet> p);
+  virtual Ptr<Packet> DoDequeue (void);
+  virtual Ptr<const Packet> DoPeek (void) const;
+  virtual uint32_t DoDequeueBatch (std::vector<Ptr<Packet> > &packets, uint32_t n);
+
+  /**
+   * Double the size of the ring, up to MaxPackets in QUEUE_MODE_PACKETS.
+   */
+  void Grow (void);
+
+  std::vector<Ptr<Packet> > m_ring;
+  uint32_t m_head;   //!< Index of the oldest packet in m_ring
+  uint32_t m_count;  //!< Number of packets in m_ring
+  uint32_t m_maxPackets;
+  uint32_t m_maxBytes;
+  QueueMode m_mode;
+};
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_QUEUE_H */
@@ -21,6 +21,7 @@
 #define SIMPLE_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/nstime.h"
 #include "mac48-address.h"
 #include <vector>
 
@@ -41,8 +42,8 @@ public:
 
   /**
    * A packet is sent by a net device.  A receive event will be 
-   * scheduled for all net device connected to the channel other 
-   * than the net device who sent the packet
+   * scheduled, after the channel delay, for all net device connected
+   * to the channel other than the net device who sent the packet
    *
    * \param p packet to be sent
    * \param protocol protocol number
@@ -67,6 +68,7 @@ public:
 
 private:
   std::vector<Ptr<SimpleNetDevice> > m_devices;
+  Time m_delay; //!< delay of the packets through the channel
 };
 
 } // namespace ns3
@@ -132,16 +132,9 @@ void Ipv6TunnelL4Protocol::SendMessage (Ptr<Packet> packet, Ipv6Address src, Ipv
   Ptr<Ipv6L3Protocol> ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
   SocketIpTtlTag tag;
   NS_ASSERT (ipv6 != 0);
-  if (packet->PeekPacketTag (tag))
-    {
-      tag.SetTtl (ttl);
-      packet->ReplacePacketTag (tag);
-    }
-  else
-    {
-      tag.SetTtl (ttl);
-      packet->AddPacketTag (tag);
-    }
+  // ReplacePacketTag adds the tag if the packet has none.
+  tag.SetTtl (ttl);
+  packet->ReplacePacketTag (tag);
   ipv6->Send (packet, src, dst, PROT_NUMBER, 0);
 }
 
@@ -181,16 +174,8 @@ enum IpL4Protocol::RxStatus Ipv6TunnelL4Protocol::Receive (Ptr<Packet> packet, I
     }
   
   SocketIpTtlTag tag;
-  if (packet->PeekPacketTag (tag))
-    {
-      tag.SetTtl (innerHeader.GetHopLimit() - 1);
-      packet->ReplacePacketTag (tag);
-    }
-  else
-    {
-      tag.SetTtl (innerHeader.GetHopLimit() - 1);
-      packet->AddPacketTag (tag);
-    }
+  tag.SetTtl (innerHeader.GetHopLimit() - 1);
+  packet->ReplacePacketTag (tag);
   
   // Prevent infinite loop
   Ptr<Ipv6Route> route;
@@ -35,6 +35,7 @@
 #include "ns3/ipv6-routing-protocol.h"
 #include "ns3/ipv6-route.h"
 #include "ns3/ipv6-header.h"
+#include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/ethernet-header.h"
 #include "ns3/ethernet-trailer.h"
 
@@ -53,7 +54,8 @@ TunnelNetDevice::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::TunnelNetDevice")
     .SetParent<NetDevice> ()
     .AddConstructor<TunnelNetDevice> ()
-    .AddAttribute ("Mtu", "The MAC-level Maximum Transmission Unit",
+    .AddAttribute ("Mtu", "The MAC-level Maximum Transmission Unit, "
+                   "lowered to the Path MTU towards the remote end less the encapsulation overhead",
                    UintegerValue (1500),
                    MakeUintegerAccessor (&TunnelNetDevice::SetMtu,
                                          &TunnelNetDevice::GetMtu),
@@ -83,7 +85,8 @@ TunnelNetDevice::GetTypeId (void)
 }
 
 TunnelNetDevice::TunnelNetDevice ()
- : m_localAddress("::"),
+ : m_linkMtu (0),
+   m_localAddress("::"),
    m_remoteAddress("::"),
    m_refCount(1)
 {
@@ -147,6 +150,7 @@ void TunnelNetDevice::SetLocalAddress(Ipv6Address laddr)
   NS_LOG_FUNCTION ( this << laddr );
   
   m_localAddress = laddr;
+  m_linkMtu = 0;
 }
   
 Ipv6Address TunnelNetDevice::GetRemoteAddress() const
@@ -161,6 +165,7 @@ void TunnelNetDevice::SetRemoteAddress(Ipv6Address raddr)
   NS_LOG_FUNCTION ( this << raddr );
   
   m_remoteAddress = raddr;
+  m_linkMtu = 0;
 }
    
 void TunnelNetDevice::IncreaseRefCount()
@@ -252,7 +257,73 @@ uint16_t
 TunnelNetDevice::GetMtu (void) const
 {
   NS_LOG_FUNCTION_NOARGS();
-  return m_mtu;
+  uint32_t outerMtu = GetOuterMtu ();
+  if (outerMtu == 0)
+    {
+      return m_mtu;
+    }
+  uint32_t mtu = MIN_TUNNEL_MTU;
+  if (outerMtu > MIN_TUNNEL_MTU + ENCAPSULATION_OVERHEAD)
+    {
+      mtu = outerMtu - ENCAPSULATION_OVERHEAD;
+    }
+  return mtu < m_mtu ? mtu : m_mtu;
+}
+
+uint32_t
+TunnelNetDevice::GetOuterMtu (void) const
+{
+  if (m_node == 0 || m_remoteAddress.IsAny ())
+    {
+      return 0;
+    }
+  Ptr<Ipv6L3Protocol> ipv6 = m_node->GetObject<Ipv6L3Protocol> ();
+  if (ipv6 == 0)
+    {
+      return 0;
+    }
+
+  uint32_t pmtu = ipv6->GetPmtu (m_remoteAddress);
+  if (pmtu != 0)
+    {
+      return pmtu;
+    }
+
+  if (m_linkMtu == 0 && ipv6->GetRoutingProtocol () != 0)
+    {
+      Ipv6Header header;
+      Socket::SocketErrno err;
+      header.SetDestinationAddress (m_remoteAddress);
+      Ptr<Ipv6Route> route = ipv6->GetRoutingProtocol ()->RouteOutput (Create<Packet> (), header, 0, err);
+      if (route != 0 && PeekPointer (route->GetOutputDevice ()) != this)
+        {
+          m_linkMtu = route->GetOutputDevice ()->GetMtu ();
+        }
+    }
+  return m_linkMtu;
+}
+
+bool
+TunnelNetDevice::CheckSize (Ptr<Packet> packet, uint16_t protocolNumber)
+{
+  uint16_t mtu = GetMtu ();
+  if (packet->GetSize () <= mtu)
+    {
+      return true;
+    }
+  NS_LOG_LOGIC ("Packet of " << packet->GetSize () << " bytes over the tunnel MTU " << mtu << ", drop");
+
+  Ipv6Header innerHeader;
+  Ptr<Icmpv6L4Protocol> icmpv6 = m_node->GetObject<Icmpv6L4Protocol> ();
+  if (icmpv6 != 0 && protocolNumber == Ipv6L3Protocol::PROT_NUMBER && packet->PeekHeader (innerHeader))
+    {
+      Ipv6Address innerSource = innerHeader.GetSourceAddress ();
+      if (!innerSource.IsAny () && !innerSource.IsMulticast ())
+        {
+          icmpv6->SendErrorTooBig (packet, innerSource, mtu);
+        }
+    }
+  return false;
 }
 
 bool
@@ -316,6 +387,11 @@ TunnelNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protoco
   Ptr<Ipv6L3Protocol> ipv6 = GetNode()->GetObject<Ipv6L3Protocol>();
   NS_ASSERT (ipv6 != 0 && ipv6->GetRoutingProtocol () != 0);
   NS_ASSERT (!m_remoteAddress.IsAny());
+
+  if (!CheckSize (packet, protocolNumber))
+    {
+      return false;
+    }
   
   Ipv6Address src = m_localAddress;
   Ipv6Address dst = m_remoteAddress;
@@ -341,6 +417,7 @@ TunnelNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protoco
         }
 
       src = route->GetSource ();
+      m_linkMtu = route->GetOutputDevice ()->GetMtu ();
       if (packet->PeekPacketTag (tag))
         {
           tag.SetTtl (ttl);
@@ -380,6 +457,11 @@ TunnelNetDevice::SendFrom (Ptr<Packet> packet, const Address& source, const Addr
   Ptr<Ipv6L3Protocol> ipv6 = GetNode ()->GetObject<Ipv6L3Protocol> ();
   NS_ASSERT (ipv6 != 0 && ipv6->GetRoutingProtocol () != 0);
   NS_ASSERT (!m_remoteAddress.IsAny ());
+
+  if (!CheckSize (packet, protocolNumber))
+    {
+      return false;
+    }
   
   Ipv6Address src = m_localAddress;
   Ipv6Address dst = m_remoteAddress;
@@ -411,6 +493,7 @@ TunnelNetDevice::SendFrom (Ptr<Packet> packet, const Address& source, const Addr
         }
 
       src = route->GetSource ();
+      m_linkMtu = route->GetOutputDevice ()->GetMtu ();
       tag.SetTtl (ttl);
       packet->AddPacketTag (tag);
 		
@@ -40,6 +40,11 @@ namespace ns3 {
  * \class TunnelNetDevice
  * \brief A tunnel device, similar to Linux TUN/TAP interfaces.
  *
+ * The MTU the device reports follows the Path MTU towards the remote end
+ * of the tunnel, less the outer IPv6 header (RFC 2473, sec. 6.7), so that
+ * inner packets are sized to fit the path instead of being fragmented
+ * after the encapsulation. Inner packets too large for it are dropped and
+ * reported to their source with an ICMPv6 Packet Too Big.
  */
 class TunnelNetDevice : public NetDevice
 {
@@ -78,6 +83,19 @@ public:
    * \return whether the MTU value was within legal bounds
    */
   bool SetMtu (const uint16_t mtu);
+
+  /**
+   * \brief Size of the outer IPv6 header added to the inner packets
+   */
+  static const uint16_t ENCAPSULATION_OVERHEAD = 40;
+
+  /**
+   * \brief Smallest MTU the device reports, the IPv6 minimum link MTU
+   *
+   * When the path towards the remote end cannot carry it with the outer
+   * header, the encapsulated packets are fragmented.
+   */
+  static const uint16_t MIN_TUNNEL_MTU = 1280;
   
   Ipv6Address GetLocalAddress() const;
   void SetLocalAddress(Ipv6Address laddr);
@@ -136,6 +154,28 @@ protected:
 
 private:
 
+  /**
+   * \brief Get the MTU of the path towards the remote end of the tunnel
+   *
+   * The Path MTU discovered towards the remote address if any, else the
+   * MTU of the link the encapsulated packets leave from.
+   *
+   * \return the outer MTU, zero if unknown
+   */
+  uint32_t GetOuterMtu (void) const;
+
+  /**
+   * \brief Check that an inner packet fits the tunnel MTU
+   *
+   * A packet too large is reported to its source with an ICMPv6 Packet
+   * Too Big rather than fragmented after the encapsulation.
+   *
+   * \param packet the inner packet
+   * \param protocolNumber the protocol of the inner packet
+   * \return true if the packet can be sent
+   */
+  bool CheckSize (Ptr<Packet> packet, uint16_t protocolNumber);
+
   Address m_myAddress;
   TracedCallback<Ptr<const Packet> > m_macRxTrace;
   TracedCallback<Ptr<const Packet> > m_macTxTrace;
@@ -148,6 +188,7 @@ private:
   std::string m_name;
   uint32_t m_index;
   uint16_t m_mtu;
+  mutable uint16_t m_linkMtu; //!< MTU of the outer link, zero if not looked up yet
   bool m_needsArp;
   bool m_supportsSendFrom;
   bool m_isPointToPoint;
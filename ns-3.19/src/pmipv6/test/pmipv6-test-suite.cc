@@ -4,6 +4,17 @@
 
 // An essential include is test.h
 #include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-tunnel-l4-protocol.h"
+#include "ns3/tunnel-net-device.h"
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
@@ -45,6 +56,74 @@ Pmipv6TestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * The MTU of a tunnel follows the Path MTU towards its remote end, less
+ * the outer header, and inner packets too large for it are not sent.
+ */
+class TunnelMtuTestCase : public TestCase
+{
+public:
+  TunnelMtuTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TunnelMtuTestCase::TunnelMtuTestCase ()
+  : TestCase ("Tunnel MTU follows the outer Path MTU")
+{
+}
+
+void
+TunnelMtuTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      device->SetMtu (1500);
+      nodes.Get (i)->AddDevice (device);
+      devices.Add (device);
+    }
+  Ipv6AddressHelper address;
+  address.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  Ipv6InterfaceContainer interfaces = address.Assign (devices);
+
+  Ptr<Ipv6TunnelL4Protocol> ip6tunnel = CreateObject<Ipv6TunnelL4Protocol> ();
+  nodes.Get (0)->AggregateObject (ip6tunnel);
+  Ipv6Address remote = interfaces.GetAddress (1, 1);
+  ip6tunnel->AddTunnel (remote);
+  Ptr<TunnelNetDevice> tunnel = ip6tunnel->GetTunnelDevice (remote);
+  NS_TEST_ASSERT_MSG_EQ (tunnel->GetMtu (), 1460, "Tunnel MTU not derived from the link MTU");
+
+  Ptr<Ipv6L3Protocol> ipv6 = nodes.Get (0)->GetObject<Ipv6L3Protocol> ();
+  ipv6->SetPmtu (remote, 1400);
+  NS_TEST_ASSERT_MSG_EQ (tunnel->GetMtu (), 1360, "Tunnel MTU not derived from the Path MTU");
+  ipv6->SetPmtu (remote, 1300);
+  NS_TEST_ASSERT_MSG_EQ (tunnel->GetMtu (), 1280, "Tunnel MTU below the IPv6 minimum");
+
+  Ipv6Header header;
+  header.SetSourceAddress (Ipv6Address ("2001:2::1"));
+  header.SetDestinationAddress (Ipv6Address ("2001:3::1"));
+  header.SetNextHeader (59);
+  Ptr<Packet> packet = Create<Packet> (1300 - header.GetSerializedSize ());
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (tunnel->Send (packet, tunnel->GetBroadcast (), Ipv6L3Protocol::PROT_NUMBER), false,
+                         "Packet over the tunnel MTU sent");
+  packet = Create<Packet> (1280 - header.GetSerializedSize ());
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (tunnel->Send (packet, tunnel->GetBroadcast (), Ipv6L3Protocol::PROT_NUMBER), true,
+                         "Packet within the tunnel MTU not sent");
+
+  Simulator::Destroy ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -60,6 +139,7 @@ Pmipv6TestSuite::Pmipv6TestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new Pmipv6TestCase1, TestCase::QUICK);
+  AddTestCase (new TunnelMtuTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite